@@ -324,6 +324,7 @@ HEADERS += src/audiomixerboard.h \
     src/serverdlg.h \
     src/multicolorled.h \
     src/multicolorledbar.h \
+    src/mixkernels.h \
     src/protocol.h \
     src/server.h \
     src/serverlist.h \
@@ -337,6 +338,7 @@ HEADERS += src/audiomixerboard.h \
     src/recorder/jamrecorder.h \
     src/recorder/creaperproject.h \
     src/recorder/cwavestream.h \
+    src/recorder/coggopusstream.h \
     src/historygraph.h \
     src/signalhandler.h
 
@@ -447,6 +449,7 @@ SOURCES += src/audiomixerboard.cpp \
     src/main.cpp \
     src/multicolorled.cpp \
     src/multicolorledbar.cpp \
+    src/mixkernels.cpp \
     src/protocol.cpp \
     src/server.cpp \
     src/serverlist.cpp \
@@ -460,6 +463,7 @@ SOURCES += src/audiomixerboard.cpp \
     src/recorder/jamrecorder.cpp \
     src/recorder/creaperproject.cpp \
     src/recorder/cwavestream.cpp \
+    src/recorder/coggopusstream.cpp \
     src/historygraph.cpp
 
 SOURCES_OPUS = libs/opus/celt/bands.c \
@@ -560,6 +560,9 @@ CAudioMixerBoard::CAudioMixerBoard ( QWidget* parent, Qt::WindowFlags ) :
     setHorizontalScrollBarPolicy ( Qt::ScrollBarAsNeeded );
     setFrameShape ( QFrame::NoFrame );
 
+    // the faders in the visible area are reported after the view has settled
+    TimerViewportChannels.setSingleShot ( true );
+
 
     // Connections -------------------------------------------------------------
 #if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
@@ -671,6 +674,12 @@ CAudioMixerBoard::CAudioMixerBoard ( QWidget* parent, Qt::WindowFlags ) :
     QObject::connect ( vecpChanFader[49], SIGNAL ( soloStateChanged ( int ) ), this, SLOT ( OnChSoloStateChanged() ) );
 
 #endif
+
+    QObject::connect ( horizontalScrollBar(), SIGNAL ( valueChanged ( int ) ),
+        this, SLOT ( OnViewportChanged() ) );
+
+    QObject::connect ( &TimerViewportChannels, SIGNAL ( timeout() ),
+        this, SLOT ( OnTimerViewportChannels() ) );
 }
 
 #if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
@@ -854,6 +863,10 @@ void CAudioMixerBoard::ApplyNewConClientList ( CVector<CChannelInfo>& vecChanInf
     // update flag for "all faders are invisible"
     bNoFaderVisible = ( iNumConnectedClients == 0 );
 
+    // the faders in the visible area may have changed (the geometry of the
+    // faders is updated by the layout later)
+    OnViewportChanged();
+
     // emit status of connected clients
     emit NumClientsChanged ( iNumConnectedClients );
 }
@@ -975,6 +988,57 @@ bool CAudioMixerBoard::GetStoredFaderSettings ( const CChannelInfo& ChanInfo,
     return false;
 }
 
+void CAudioMixerBoard::resizeEvent ( QResizeEvent* pEvent )
+{
+    QScrollArea::resizeEvent ( pEvent );
+
+    OnViewportChanged();
+}
+
+void CAudioMixerBoard::OnTimerViewportChannels()
+{
+    // the visible area of the scroll area in the coordinates of the group box
+    // which holds the faders
+    const QRect ViewRect ( -pGroupBox->x(), -pGroupBox->y(),
+                           viewport()->width(), viewport()->height() );
+
+    CVector<int> veciChanIDs;
+
+    for ( int iChId = 0; iChId < MAX_NUM_CHANNELS; iChId++ )
+    {
+        if ( vecpChanFader[iChId]->IsVisible() && vecpChanFader[iChId]->IsInRect ( ViewRect ) )
+        {
+            veciChanIDs.Add ( iChId );
+        }
+    }
+
+    // only report actual changes
+    if ( veciChanIDs != veciViewportChanIDs )
+    {
+        veciViewportChanIDs = veciChanIDs;
+
+        emit ViewportChannelsChanged ( veciViewportChanIDs );
+    }
+}
+
+void CAudioMixerBoard::SetChannelLevelsByChanID ( const CVector<uint16_t>& vecLevelsByChanID )
+{
+    for ( int iChId = 0; iChId < MAX_NUM_CHANNELS; iChId++ )
+    {
+        if ( vecpChanFader[iChId]->IsVisible() )
+        {
+            vecpChanFader[iChId]->SetChannelLevel ( vecLevelsByChanID[iChId] );
+
+            // show level only if we successfully received levels from the
+            // server (if server does not support levels, do not show levels)
+            if ( bDisplayChannelLevels && !vecpChanFader[iChId]->GetDisplayChannelLevel() )
+            {
+                vecpChanFader[iChId]->SetDisplayChannelLevel ( true );
+            }
+        }
+    }
+}
+
 void CAudioMixerBoard::SetChannelLevels ( const CVector<uint16_t>& vecChannelLevel )
 {
     const int iNumChannelLevels = vecChannelLevel.Size();
@@ -34,11 +34,19 @@
 #include <QSlider>
 #include <QSizePolicy>
 #include <QHostAddress>
+#include <QTimer>
+#include <QScrollBar>
 #include "global.h"
 #include "util.h"
 #include "multicolorledbar.h"
 
 
+/* Definitions ****************************************************************/
+// delay for reporting the faders in the visible area of the mixer board (we do
+// not want to send a subscription message on each scroll step)
+#define VIEWPORT_CHAN_UPDATE_DELAY_MS 250 // ms
+
+
 /* Classes ********************************************************************/
 class CChannelFader : public QObject
 {
@@ -53,6 +61,7 @@ public:
     void Show() { pFrame->show(); }
     void Hide() { pFrame->hide(); }
     bool IsVisible() { return !pFrame->isHidden(); }
+    bool IsInRect ( const QRect& Rect ) { return pFrame->geometry().intersects ( Rect ); }
     bool IsSolo() { return pcbSolo->isChecked(); }
     bool IsMute() { return pcbMute->isChecked(); }
     void SetGUIDesign ( const EGUIDesign eNewDesign );
@@ -143,6 +152,7 @@ public:
                          const int iValue );
 
     void SetChannelLevels ( const CVector<uint16_t>& vecChannelLevel );
+    void SetChannelLevelsByChanID ( const CVector<uint16_t>& vecLevelsByChanID );
 
     // settings
     CVector<QString> vecStoredFaderTags;
@@ -160,12 +170,16 @@ protected:
     void StoreFaderSettings ( CChannelFader* pChanFader );
     void UpdateSoloStates();
 
+    virtual void resizeEvent ( QResizeEvent* pEvent );
+
     CVector<CChannelFader*> vecpChanFader;
     QGroupBox*              pGroupBox;
     QHBoxLayout*            pMainLayout;
     bool                    bDisplayChannelLevels;
     bool                    bNoFaderVisible;
     QString                 strServerName;
+    CVector<int>            veciViewportChanIDs;
+    QTimer                  TimerViewportChannels;
 
 #if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
     virtual void UpdateGainValue ( const int    iChannelIdx,
@@ -239,7 +253,12 @@ public slots:
 
 #endif
 
+protected slots:
+    void OnViewportChanged() { TimerViewportChannels.start ( VIEWPORT_CHAN_UPDATE_DELAY_MS ); }
+    void OnTimerViewportChannels();
+
 signals:
     void ChangeChanGain ( int iId, double dGain );
     void NumClientsChanged ( int iNewNumClients );
+    void ViewportChannelsChanged ( CVector<int> veciChanIDs );
 };
@@ -33,6 +33,13 @@ void CNetBuf::Init ( const int  iNewBlockSize,
                      const int  iNewNumBlocks,
                      const bool bPreserve )
 {
+    // if the data is preserved, the base class moves the oldest block to the
+    // beginning of the memory, the received flags must follow the blocks
+    const bool             bMoveFlags         = bPreserve && !bIsSimulation && bIsInitialized;
+    const int              iOldFirstBlock     = bMoveFlags ? iGetPos / iBlockSize : 0;
+    const int              iOldNumBlocks      = bMoveFlags ? iMemSize / iBlockSize : 0;
+    const CVector<uint8_t> vecbyOldBlockRecvd ( vecbyBlockReceived );
+
     // store block size value
     iBlockSize = iNewBlockSize;
 
@@ -40,6 +47,21 @@ void CNetBuf::Init ( const int  iNewBlockSize,
     CBufferBase<uint8_t>::Init ( iNewBlockSize * iNewNumBlocks,
                                  bPreserve );
 
+    if ( !bIsSimulation )
+    {
+        vecbyBlockReceived.Init ( iNewNumBlocks, true );
+
+        for ( int i = 0; i < std::min ( iNewNumBlocks, iOldNumBlocks ); i++ )
+        {
+            vecbyBlockReceived[i] = vecbyOldBlockRecvd[( iOldFirstBlock + i ) % iOldNumBlocks];
+        }
+    }
+
+    // the positions of the packets in the buffer may have changed, the next
+    // packet starts a new sequence (missing packets are not filled in anymore)
+    bSeqNumValid   = false;
+    iNumSeqPackets = 0;
+
     // clear buffer if not preserved
     if ( !bPreserve )
     {
@@ -58,17 +80,84 @@ bool CNetBuf::Put ( const CVector<uint8_t>& vecbyData,
         return false;
     }
 
-    // copy new data in internal buffer (implemented in base class)
-    CBufferBase<uint8_t>::Put ( vecbyData, iInSize );
+    // a packet without sequence number interrupts the sequence
+    bSeqNumValid   = false;
+    iNumSeqPackets = 0;
+
+    // copy new data in internal buffer
+    PutBlocks ( vecbyData, iInSize, true );
 
     return bPutOK;
 }
 
+bool CNetBuf::Put ( const CVector<uint8_t>& vecbyData,
+                    const int               iInSize,
+                    const int               iSeqNum )
+{
+    // check size (the reorder slots and the space of missing packets are
+    // addressed in blocks, a packet of another size must not be written)
+    if ( ( iInSize == 0 ) || ( iInSize != iBlockSize ) )
+    {
+        return false;
+    }
+
+    // the first packet defines the expected sequence
+    if ( !bSeqNumValid )
+    {
+        bSeqNumValid = true;
+        iNextSeqNum  = iSeqNum;
+    }
+
+    // distance to the expected packet (the 16 bit sequence number wraps around)
+    // and the number of packets which fit in the buffer
+    const int iSeqDiff       = static_cast<int16_t> ( static_cast<uint16_t> ( iSeqNum - iNextSeqNum ) );
+    const int iNumBufPackets = iMemSize / iInSize;
+
+    if ( ( iSeqDiff < 0 ) && ( -iSeqDiff <= iNumBufPackets ) )
+    {
+        // a late (reordered) or duplicated packet
+        return PutLatePacket ( vecbyData, iInSize, -iSeqDiff );
+    }
+
+    if ( ( iSeqDiff > 0 ) &&
+         ( iSeqDiff < iNumBufPackets ) &&
+         ( GetAvailSpace() >= ( iSeqDiff + 1 ) * iInSize ) )
+    {
+        // packets are missing, reserve their space (the data of the current
+        // packet is used as a filler, the blocks are not marked as received)
+        for ( int i = 0; i < iSeqDiff; i++ )
+        {
+            PutBlocks ( vecbyData, iInSize, false );
+        }
+
+        iNumSeqPackets = std::min ( iNumSeqPackets + iSeqDiff, iNumBufPackets );
+    }
+    else if ( iSeqDiff != 0 )
+    {
+        // the sequence number jumped (e.g. the sender was restarted) or the
+        // gap does not fit in the buffer: start a new sequence
+        iNumSeqPackets = 0;
+    }
+
+    iNextSeqNum = ( iSeqNum + 1 ) & 0xFFFF;
+
+    // check if there is not enough space available
+    if ( GetAvailSpace() < iInSize )
+    {
+        iNumSeqPackets = 0;
+        return false;
+    }
+
+    PutBlocks ( vecbyData, iInSize, true );
+
+    iNumSeqPackets = std::min ( iNumSeqPackets + 1, iNumBufPackets );
+
+    return true;
+}
+
 bool CNetBuf::Get ( CVector<uint8_t>& vecbyData,
                     const int         iOutSize )
 {
-    bool bGetOK = true; // init return value
-
     // check size
     if ( ( iOutSize == 0 ) || ( iOutSize != iBlockSize ) )
     {
@@ -81,6 +170,9 @@ bool CNetBuf::Get ( CVector<uint8_t>& vecbyData,
         return false;
     }
 
+    // the reserved space of a missing packet is read like a lost packet
+    const bool bGetOK = bIsSimulation || ( vecbyBlockReceived[iGetPos / iBlockSize] != 0 );
+
     // copy data from internal buffer in output buffer (implemented in base
     // class)
     CBufferBase<uint8_t>::Get ( vecbyData, iOutSize );
@@ -88,10 +180,160 @@ bool CNetBuf::Get ( CVector<uint8_t>& vecbyData,
     return bGetOK;
 }
 
+void CNetBuf::PutBlocks ( const CVector<uint8_t>& vecbyData,
+                          const int               iInSize,
+                          const bool              bReceived )
+{
+    // the put position is always at a block boundary
+    if ( !bIsSimulation )
+    {
+        const int iFirstBlock  = iPutPos / iBlockSize;
+        const int iNumBlocks   = iMemSize / iBlockSize;
+        const int iNumInBlocks = ( iInSize + iBlockSize - 1 ) / iBlockSize;
+
+        for ( int i = 0; i < iNumInBlocks; i++ )
+        {
+            vecbyBlockReceived[( iFirstBlock + i ) % iNumBlocks] = bReceived;
+        }
+    }
+
+    // copy new data in internal buffer (implemented in base class)
+    CBufferBase<uint8_t>::Put ( vecbyData, iInSize );
+}
+
+bool CNetBuf::PutLatePacket ( const CVector<uint8_t>& vecbyData,
+                              const int               iInSize,
+                              const int               iNumPacketsBack )
+{
+    // the packet is too late if its space was put before the current sequence
+    // was started or if its space was already read (even partly)
+    if ( iNumPacketsBack > iNumSeqPackets )
+    {
+        return false;
+    }
+
+    int iPos = iPutPos - iNumPacketsBack * iInSize;
+
+    if ( iPos < 0 )
+    {
+        iPos += iMemSize; // wrap around
+    }
+
+    int iDistFromGetPos = iPos - iGetPos;
+
+    if ( iDistFromGetPos < 0 )
+    {
+        iDistFromGetPos += iMemSize; // wrap around
+    }
+
+    if ( iDistFromGetPos + iInSize > GetAvailData() )
+    {
+        return false;
+    }
+
+    // a duplicate is dropped silently
+    if ( vecbyBlockReceived[iPos / iBlockSize] != 0 )
+    {
+        return true;
+    }
+
+    const int iNumBlocks   = iMemSize / iBlockSize;
+    const int iNumInBlocks = ( iInSize + iBlockSize - 1 ) / iBlockSize;
+
+    for ( int i = 0; i < iInSize; i++ )
+    {
+        vecMemory[( iPos + i ) % iMemSize] = vecbyData[i];
+    }
+
+    for ( int i = 0; i < iNumInBlocks; i++ )
+    {
+        vecbyBlockReceived[( iPos / iBlockSize + i ) % iNumBlocks] = true;
+    }
+
+    return true;
+}
+
+
+/* Lock-free network frame queue implementation *******************************/
+CNetFrameQueue::CNetFrameQueue() :
+    vecbyMemory ( NUM_NET_FRAME_QUEUE_SLOTS * MAX_SIZE_BYTES_NET_FRAME_QUEUE_SLOT ),
+    iPutPos     ( 0 ),
+    iGetPos     ( 0 )
+{
+    for ( int i = 0; i < NUM_NET_FRAME_QUEUE_SLOTS; i++ )
+    {
+        veciFrameSizes[i] = 0;
+    }
+}
+
+bool CNetFrameQueue::Put ( const CVector<uint8_t>& vecbyData,
+                           const int               iInSize )
+{
+    // note that only the producer modifies the put position
+    const int iCurPutPos  = iPutPos.loadAcquire();
+    const int iNextPutPos = ( iCurPutPos + 1 ) % NUM_NET_FRAME_QUEUE_SLOTS;
+
+    // check for queue overrun and too large packets
+    if ( ( iNextPutPos == iGetPos.loadAcquire() ) ||
+         ( iInSize > MAX_SIZE_BYTES_NET_FRAME_QUEUE_SLOT ) )
+    {
+        return false;
+    }
+
+    // copy the packet in its slot before the slot is published to the consumer
+    std::copy ( vecbyData.begin(),
+                vecbyData.begin() + iInSize,
+                vecbyMemory.begin() + iCurPutPos * MAX_SIZE_BYTES_NET_FRAME_QUEUE_SLOT );
+
+    veciFrameSizes[iCurPutPos] = iInSize;
+
+    iPutPos.storeRelease ( iNextPutPos );
+
+    return true;
+}
+
+bool CNetFrameQueue::Get ( CVector<uint8_t>& vecbyData,
+                           int&              iOutSize )
+{
+    // note that only the consumer modifies the get position
+    const int iCurGetPos = iGetPos.loadAcquire();
+
+    // check if the queue is empty
+    if ( iCurGetPos == iPutPos.loadAcquire() )
+    {
+        return false;
+    }
+
+    // the output vector must be large enough to hold a full slot
+    iOutSize = veciFrameSizes[iCurGetPos];
+
+    std::copy ( vecbyMemory.begin() + iCurGetPos * MAX_SIZE_BYTES_NET_FRAME_QUEUE_SLOT,
+                vecbyMemory.begin() + iCurGetPos * MAX_SIZE_BYTES_NET_FRAME_QUEUE_SLOT + iOutSize,
+                vecbyData.begin() );
+
+    iGetPos.storeRelease ( ( iCurGetPos + 1 ) % NUM_NET_FRAME_QUEUE_SLOTS );
+
+    return true;
+}
+
+void CNetFrameQueue::Reset()
+{
+    // drop all queued packets (must only be called by the consumer)
+    iGetPos.storeRelease ( iPutPos.loadAcquire() );
+}
+
 
 /* Network buffer with statistic calculations implementation ******************/
 CNetBufWithStats::CNetBufWithStats() :
     CNetBuf                   ( false ), // base class init: no simulation mode
+    iEventLogPutPos           ( 0 ),
+    iEventLogGetPos           ( 0 ),
+    bEventLogOverflow         ( false ),
+    bEventLogResetPending     ( 0 ),
+    iResetBlockSize           ( 0 ),
+    iStatBlockSize            ( 0 ),
+    iCurAutoBufferSizeSetting ( 6 ),
+    iAutoBufferSizeSetting    ( 6 ),
     iMaxStatisticCount        ( MAX_STATISTIC_COUNT ),
     bUseDoubleSystemFrameSize ( false ),
     dAutoFilt_WightUpNormal   ( IIR_WEIGTH_UP_NORMAL ),
@@ -122,12 +364,23 @@ CNetBufWithStats::CNetBufWithStats() :
     {
         SimulationBuffer[i].SetIsSimulation ( true );
     }
+
+    // from now on the statistic worker evaluates our event log
+    CNetBufStatsWorker::Instance().Register ( this );
+}
+
+CNetBufWithStats::~CNetBufWithStats()
+{
+    // after this call the worker does not access this object anymore
+    CNetBufStatsWorker::Instance().Unregister ( this );
 }
 
 void CNetBufWithStats::GetErrorRates ( CVector<double>& vecErrRates,
                                        double&          dLimit,
                                        double&          dMaxUpLimit )
 {
+    QMutexLocker locker ( &MutexStats );
+
     // get all the averages of the error statistic
     vecErrRates.Init ( NUM_STAT_SIMULATION_BUFFERS );
 
@@ -148,50 +401,65 @@ void CNetBufWithStats::Init ( const int  iNewBlockSize,
     // call base class Init
     CNetBuf::Init ( iNewBlockSize, iNewNumBlocks, bPreserve );
 
-    // inits for statistics calculation
+    // inits for statistics calculation: the statistic is reset by the worker
+    // thread when it reaches the reset event in the log (the caller may be a
+    // real-time thread which must not wait for the low priority worker)
     if ( !bPreserve )
     {
-        // set the auto filter weights and max statistic count
-        if ( bUseDoubleSystemFrameSize )
-        {
-            dAutoFilt_WightUpNormal   = IIR_WEIGTH_UP_NORMAL_DOUBLE_FRAME_SIZE;
-            dAutoFilt_WightDownNormal = IIR_WEIGTH_DOWN_NORMAL_DOUBLE_FRAME_SIZE;
-            dAutoFilt_WightUpFast     = IIR_WEIGTH_UP_FAST_DOUBLE_FRAME_SIZE;
-            dAutoFilt_WightDownFast   = IIR_WEIGTH_DOWN_FAST_DOUBLE_FRAME_SIZE;
-            iMaxStatisticCount        = MAX_STATISTIC_COUNT_DOUBLE_FRAME_SIZE;
-            dErrorRateBound           = ERROR_RATE_BOUND_DOUBLE_FRAME_SIZE;
-            dUpMaxErrorBound          = UP_MAX_ERROR_BOUND_DOUBLE_FRAME_SIZE;
-        }
-        else
+        iResetBlockSize.storeRelease ( iNewBlockSize );
+
+        if ( !AddEvent ( NET_BUF_EVENT_RESET ) )
         {
-            dAutoFilt_WightUpNormal   = IIR_WEIGTH_UP_NORMAL;
-            dAutoFilt_WightDownNormal = IIR_WEIGTH_DOWN_NORMAL;
-            dAutoFilt_WightUpFast     = IIR_WEIGTH_UP_FAST;
-            dAutoFilt_WightDownFast   = IIR_WEIGTH_DOWN_FAST;
-            iMaxStatisticCount        = MAX_STATISTIC_COUNT;
-            dErrorRateBound           = ERROR_RATE_BOUND;
-            dUpMaxErrorBound          = UP_MAX_ERROR_BOUND;
+            bEventLogResetPending.storeRelease ( 1 );
         }
+    }
+}
 
-        for ( int i = 0; i < NUM_STAT_SIMULATION_BUFFERS; i++ )
-        {
-            // init simulation buffers with the correct size
-            SimulationBuffer[i].Init ( iNewBlockSize, viBufSizesForSim[i] );
+void CNetBufWithStats::ResetStatistic()
+{
+    // the block size of the last Init() is used
+    iStatBlockSize = iResetBlockSize.loadAcquire();
 
-            // init statistics
-            ErrorRateStatistic[i].Init ( iMaxStatisticCount, true );
-        }
+    // set the auto filter weights and max statistic count
+    if ( bUseDoubleSystemFrameSize )
+    {
+        dAutoFilt_WightUpNormal   = IIR_WEIGTH_UP_NORMAL_DOUBLE_FRAME_SIZE;
+        dAutoFilt_WightDownNormal = IIR_WEIGTH_DOWN_NORMAL_DOUBLE_FRAME_SIZE;
+        dAutoFilt_WightUpFast     = IIR_WEIGTH_UP_FAST_DOUBLE_FRAME_SIZE;
+        dAutoFilt_WightDownFast   = IIR_WEIGTH_DOWN_FAST_DOUBLE_FRAME_SIZE;
+        iMaxStatisticCount        = MAX_STATISTIC_COUNT_DOUBLE_FRAME_SIZE;
+        dErrorRateBound           = ERROR_RATE_BOUND_DOUBLE_FRAME_SIZE;
+        dUpMaxErrorBound          = UP_MAX_ERROR_BOUND_DOUBLE_FRAME_SIZE;
+    }
+    else
+    {
+        dAutoFilt_WightUpNormal   = IIR_WEIGTH_UP_NORMAL;
+        dAutoFilt_WightDownNormal = IIR_WEIGTH_DOWN_NORMAL;
+        dAutoFilt_WightUpFast     = IIR_WEIGTH_UP_FAST;
+        dAutoFilt_WightDownFast   = IIR_WEIGTH_DOWN_FAST;
+        iMaxStatisticCount        = MAX_STATISTIC_COUNT;
+        dErrorRateBound           = ERROR_RATE_BOUND;
+        dUpMaxErrorBound          = UP_MAX_ERROR_BOUND;
+    }
 
-        // reset the initialization counter which controls the initialization
-        // phase length
-        ResetInitCounter();
+    for ( int i = 0; i < NUM_STAT_SIMULATION_BUFFERS; i++ )
+    {
+        // init simulation buffers with the correct size
+        SimulationBuffer[i].Init ( iStatBlockSize, viBufSizesForSim[i] );
 
-        // init auto buffer setting with a meaningful value, also init the
-        // IIR parameter with this value
-        iCurAutoBufferSizeSetting = 6;
-        dCurIIRFilterResult       = iCurAutoBufferSizeSetting;
-        iCurDecidedResult         = iCurAutoBufferSizeSetting;
+        // init statistics
+        ErrorRateStatistic[i].Init ( iMaxStatisticCount, true );
     }
+
+    // reset the initialization counter which controls the initialization
+    // phase length
+    ResetInitCounter();
+
+    // init auto buffer setting with a meaningful value, also init the
+    // IIR parameter with this value
+    iCurAutoBufferSizeSetting = 6;
+    dCurIIRFilterResult       = iCurAutoBufferSizeSetting;
+    iCurDecidedResult         = iCurAutoBufferSizeSetting;
 }
 
 void CNetBufWithStats::ResetInitCounter()
@@ -209,12 +477,22 @@ bool CNetBufWithStats::Put ( const CVector<uint8_t>& vecbyData,
     // call base class Put
     const bool bPutOK = CNetBuf::Put ( vecbyData, iInSize );
 
-    // update statistics calculations
-    for ( int i = 0; i < NUM_STAT_SIMULATION_BUFFERS; i++ )
-    {
-        ErrorRateStatistic[i].Update (
-            !SimulationBuffer[i].Put ( vecbyData, iInSize ) );
-    }
+    // the statistics calculations are done by the worker thread
+    AddEvent ( std::min ( iInSize, NET_BUF_EVENT_SIZE_MASK ) );
+
+    return bPutOK;
+}
+
+bool CNetBufWithStats::Put ( const CVector<uint8_t>& vecbyData,
+                             const int               iInSize,
+                             const int               iSeqNum )
+{
+    // call base class Put
+    const bool bPutOK = CNetBuf::Put ( vecbyData, iInSize, iSeqNum );
+
+    // the statistics only consider the arrival of the packets (the space
+    // which is reserved for missing packets is not counted)
+    AddEvent ( std::min ( iInSize, NET_BUF_EVENT_SIZE_MASK ) );
 
     return bPutOK;
 }
@@ -225,17 +503,106 @@ bool CNetBufWithStats::Get ( CVector<uint8_t>& vecbyData,
     // call base class Get
     const bool bGetOK = CNetBuf::Get ( vecbyData, iOutSize );
 
-    // update statistics calculations
-    for ( int i = 0; i < NUM_STAT_SIMULATION_BUFFERS; i++ )
+    // the statistics calculations are done by the worker thread
+    AddEvent ( NET_BUF_EVENT_GET | std::min ( iOutSize, NET_BUF_EVENT_SIZE_MASK ) );
+
+    return bGetOK;
+}
+
+bool CNetBufWithStats::AddEvent ( const int iEvent )
+{
+    // note that only the producer modifies the put position
+    const int iCurPutPos  = iEventLogPutPos.loadAcquire();
+    const int iNextPutPos = ( iCurPutPos + 1 ) % NUM_NET_BUF_EVENT_LOG_SLOTS;
+
+    // if the worker is starved, the event is dropped and the worker restarts
+    // the simulation buffers since their states are not valid anymore
+    if ( iNextPutPos == iEventLogGetPos.loadAcquire() )
     {
-        ErrorRateStatistic[i].Update (
-            !SimulationBuffer[i].Get ( vecbyData, iOutSize ) );
+        bEventLogOverflow.storeRelease ( true );
+        return false;
     }
 
-    // update auto setting
-    UpdateAutoSetting();
+    viEventLog[iCurPutPos] = static_cast<uint16_t> ( iEvent );
 
-    return bGetOK;
+    iEventLogPutPos.storeRelease ( iNextPutPos );
+
+    return true;
+}
+
+void CNetBufWithStats::ProcessEventLog()
+{
+    QMutexLocker locker ( &MutexStats );
+
+    const int iCurPutPos = iEventLogPutPos.loadAcquire();
+    int       iCurGetPos = iEventLogGetPos.loadAcquire();
+
+    if ( bEventLogResetPending.fetchAndStoreOrdered ( 0 ) != 0 )
+    {
+        // a reset did not fit in the full log: the logged events are dropped
+        // since they belong (at least partly) to the old settings
+        bEventLogOverflow.storeRelease ( false );
+        ResetStatistic();
+
+        iCurGetPos = iCurPutPos;
+        iEventLogGetPos.storeRelease ( iCurGetPos );
+        iAutoBufferSizeSetting.storeRelease ( iCurAutoBufferSizeSetting );
+    }
+
+    if ( iCurGetPos == iCurPutPos )
+    {
+        return; // nothing to do
+    }
+
+    if ( bEventLogOverflow.loadAcquire() && ( iStatBlockSize > 0 ) )
+    {
+        // the error statistic is kept, only the buffer states are reset
+        bEventLogOverflow.storeRelease ( false );
+
+        for ( int i = 0; i < NUM_STAT_SIMULATION_BUFFERS; i++ )
+        {
+            SimulationBuffer[i].Init ( iStatBlockSize, viBufSizesForSim[i] );
+        }
+    }
+
+    // replay all logged put/get calls on the simulation buffers, the dummy
+    // vector is not accessed by the buffers in simulation mode
+    while ( iCurGetPos != iCurPutPos )
+    {
+        const int iEvent = viEventLog[iCurGetPos];
+        const int iSize  = iEvent & NET_BUF_EVENT_SIZE_MASK;
+
+        if ( iEvent & NET_BUF_EVENT_RESET )
+        {
+            ResetStatistic();
+        }
+        else if ( iEvent & NET_BUF_EVENT_GET )
+        {
+            for ( int i = 0; i < NUM_STAT_SIMULATION_BUFFERS; i++ )
+            {
+                ErrorRateStatistic[i].Update (
+                    !SimulationBuffer[i].Get ( vecbySimDummy, iSize ) );
+            }
+
+            // update auto setting
+            UpdateAutoSetting();
+        }
+        else
+        {
+            for ( int i = 0; i < NUM_STAT_SIMULATION_BUFFERS; i++ )
+            {
+                ErrorRateStatistic[i].Update (
+                    !SimulationBuffer[i].Put ( vecbySimDummy, iSize ) );
+            }
+        }
+
+        iCurGetPos = ( iCurGetPos + 1 ) % NUM_NET_BUF_EVENT_LOG_SLOTS;
+    }
+
+    iEventLogGetPos.storeRelease ( iCurGetPos );
+
+    // publish the new auto setting for the real-time threads
+    iAutoBufferSizeSetting.storeRelease ( iCurAutoBufferSizeSetting );
 }
 
 void CNetBufWithStats::UpdateAutoSetting()
@@ -384,3 +751,63 @@ else
         }
     }
 }
+
+
+/* Jitter buffer statistic worker implementation ******************************/
+CNetBufStatsWorker& CNetBufStatsWorker::Instance()
+{
+    // the worker is created on first use and runs until the application exits
+    static CNetBufStatsWorker NetBufStatsWorker;
+
+    return NetBufStatsWorker;
+}
+
+CNetBufStatsWorker::CNetBufStatsWorker() :
+    bRun ( 1 )
+{
+    // the statistics are not time critical, they must never compete with the
+    // audio and network threads
+    QThread::start ( QThread::LowestPriority );
+}
+
+CNetBufStatsWorker::~CNetBufStatsWorker()
+{
+    // set flag so that thread can leave the main loop
+    bRun.storeRelease ( 0 );
+
+    wait();
+}
+
+void CNetBufStatsWorker::Register ( CNetBufWithStats* pNetBuf )
+{
+    QMutexLocker locker ( &Mutex );
+
+    vecpNetBufs.push_back ( pNetBuf );
+}
+
+void CNetBufStatsWorker::Unregister ( CNetBufWithStats* pNetBuf )
+{
+    // since the worker holds the mutex while evaluating the buffers, the
+    // buffer is not in use anymore when we get the mutex
+    QMutexLocker locker ( &Mutex );
+
+    vecpNetBufs.erase ( std::remove ( vecpNetBufs.begin(), vecpNetBufs.end(), pNetBuf ),
+                        vecpNetBufs.end() );
+}
+
+void CNetBufStatsWorker::run()
+{
+    while ( bRun.loadAcquire() != 0 )
+    {
+        Mutex.lock();
+        {
+            for ( size_t i = 0; i < vecpNetBufs.size(); i++ )
+            {
+                vecpNetBufs[i]->ProcessEventLog();
+            }
+        }
+        Mutex.unlock();
+
+        msleep ( NET_BUF_STATS_WORKER_INTERVAL_MS );
+    }
+}
@@ -24,6 +24,11 @@
 
 #pragma once
 
+#include <QAtomicInt>
+#include <QMutex>
+#include <QThread>
+#include <algorithm>
+#include <vector>
 #include "util.h"
 #include "global.h"
 
@@ -69,6 +74,30 @@
 #define IIR_WEIGTH_UP_FAST                          0.9997499687422
 #define IIR_WEIGTH_DOWN_FAST                        0.999499875
 
+// number of slots of the lock-free network frame queue (one slot is always
+// kept free to distinguish the full from the empty state)
+#define NUM_NET_FRAME_QUEUE_SLOTS                   32
+
+// maximum size of one coded audio packet which fits in a network frame queue
+// slot (the largest OPUS packet we use is 4 * 142 bytes plus the audio packet
+// extension)
+#define MAX_SIZE_BYTES_NET_FRAME_QUEUE_SLOT         1024
+
+// number of slots of the jitter buffer statistic event log, each put and get
+// creates one event, i.e. with 1.33 ms blocks we have approx. 1500 events per
+// second so that the statistic worker may be delayed by more than two seconds
+#define NUM_NET_BUF_EVENT_LOG_SLOTS                 4096
+
+// event log entry: the lower bits hold the size of the put/get call, a reset
+// event restarts the statistic with the block size of the last Init()
+#define NET_BUF_EVENT_GET                           0x8000
+#define NET_BUF_EVENT_RESET                         0x4000
+#define NET_BUF_EVENT_SIZE_MASK                     0x3FFF
+
+// interval of the low priority thread which evaluates the jitter buffer
+// statistics of all network buffers
+#define NET_BUF_STATS_WORKER_INTERVAL_MS            20
+
 
 /* Classes ********************************************************************/
 // Buffer base class -----------------------------------------------------------
@@ -400,11 +429,17 @@ protected:
 
 
 // Network buffer (jitter buffer) ----------------------------------------------
+// Packets with a sequence number are placed by their sequence number: if
+// packets are missing, their space is reserved so that a reordered packet can
+// still be filled in as long as it was not read. Duplicates and packets which
+// arrive after their space was read are dropped. The reserved space of a packet
+// which never arrives is read like a lost packet.
 class CNetBuf : public CBufferBase<uint8_t>
 {
 public:
     CNetBuf ( const bool bNewIsSim = false ) :
-       CBufferBase<uint8_t> ( bNewIsSim ) {}
+       CBufferBase<uint8_t> ( bNewIsSim ), bSeqNumValid ( false ),
+       iNextSeqNum ( 0 ), iNumSeqPackets ( 0 ) {}
 
     void Init ( const int  iNewBlockSize,
                 const int  iNewNumBlocks,
@@ -413,18 +448,41 @@ public:
     int GetSize() { return iMemSize / iBlockSize; }
 
     virtual bool Put ( const CVector<uint8_t>& vecbyData, const int iInSize );
+    virtual bool Put ( const CVector<uint8_t>& vecbyData, const int iInSize, const int iSeqNum );
     virtual bool Get ( CVector<uint8_t>& vecbyData, const int iOutSize );
 
 protected:
-    int iBlockSize;
+    void PutBlocks ( const CVector<uint8_t>& vecbyData,
+                     const int               iInSize,
+                     const bool              bReceived );
+
+    bool PutLatePacket ( const CVector<uint8_t>& vecbyData,
+                         const int               iInSize,
+                         const int               iNumPacketsBack );
+
+    int              iBlockSize;
+
+    // per block: false if the block is reserved for a missing packet
+    CVector<uint8_t> vecbyBlockReceived;
+
+    // expected sequence number of the next packet and the number of packets
+    // in the buffer which were put with consecutive sequence numbers
+    bool             bSeqNumValid;
+    int              iNextSeqNum;
+    int              iNumSeqPackets;
 };
 
 
 // Network buffer (jitter buffer) with statistic calculations ------------------
+// The real-time threads only append the put/get calls to a lock-free event log
+// (single producer: all Put(), Get() and Init() calls must be serialized by the
+// caller, single consumer: the statistic worker thread). The simulation buffers
+// and the auto setting are evaluated in batches by CNetBufStatsWorker.
 class CNetBufWithStats : public CNetBuf
 {
 public:
     CNetBufWithStats();
+    virtual ~CNetBufWithStats();
 
     void Init ( const int  iNewBlockSize,
                 const int  iNewNumBlocks,
@@ -433,17 +491,38 @@ public:
     void SetUseDoubleSystemFrameSize ( const bool bNDSFSize ) { bUseDoubleSystemFrameSize = bNDSFSize; }
 
     virtual bool Put ( const CVector<uint8_t>& vecbyData, const int iInSize );
+    virtual bool Put ( const CVector<uint8_t>& vecbyData, const int iInSize, const int iSeqNum );
     virtual bool Get ( CVector<uint8_t>& vecbyData, const int iOutSize );
 
-    int GetAutoSetting() { return iCurAutoBufferSizeSetting; }
+    int GetAutoSetting() { return iAutoBufferSizeSetting.loadAcquire(); }
     void GetErrorRates ( CVector<double>& vecErrRates,
                          double&          dLimit,
                          double&          dMaxUpLimit );
 
+    // called by the statistic worker thread only
+    void ProcessEventLog();
+
 protected:
+    bool AddEvent ( const int iEvent );
+    void ResetStatistic();
     void UpdateAutoSetting();
     void ResetInitCounter();
 
+    // event log of the put/get calls and of the resets, if a reset does not
+    // fit in the full log, the worker drops all logged events instead
+    uint16_t         viEventLog[NUM_NET_BUF_EVENT_LOG_SLOTS];
+    QAtomicInt       iEventLogPutPos;
+    QAtomicInt       iEventLogGetPos;
+    QAtomicInt       bEventLogOverflow;
+    QAtomicInt       bEventLogResetPending;
+    QAtomicInt       iResetBlockSize;
+
+    // the statistic is owned by the worker thread, GetErrorRates() must lock
+    // this mutex (Init() never waits for the worker, it only logs a reset)
+    QMutex           MutexStats;
+    CVector<uint8_t> vecbySimDummy;
+    int              iStatBlockSize;
+
     // statistic (do not use the vector class since the classes do not have
     // appropriate copy constructor/operator)
     CErrorRate ErrorRateStatistic[NUM_STAT_SIMULATION_BUFFERS];
@@ -454,6 +533,7 @@ protected:
     int        iCurDecidedResult;
     int        iInitCounter;
     int        iCurAutoBufferSizeSetting;
+    QAtomicInt iAutoBufferSizeSetting;
     int        iMaxStatisticCount;
 
     bool       bUseDoubleSystemFrameSize;
@@ -466,6 +546,50 @@ protected:
 };
 
 
+// Jitter buffer statistic worker ----------------------------------------------
+// One low priority thread per process which periodically evaluates the event
+// logs of all network buffers with statistic calculations.
+class CNetBufStatsWorker : public QThread
+{
+public:
+    static CNetBufStatsWorker& Instance();
+
+    void Register ( CNetBufWithStats* pNetBuf );
+    void Unregister ( CNetBufWithStats* pNetBuf );
+
+protected:
+    CNetBufStatsWorker();
+    virtual ~CNetBufStatsWorker();
+
+    virtual void run();
+
+    QMutex                          Mutex;
+    std::vector<CNetBufWithStats*>  vecpNetBufs;
+    QAtomicInt                      bRun; // written by the destructor, read by the thread
+};
+
+
+// Lock-free network frame queue ----------------------------------------------
+// Single producer/single consumer queue which hands over received coded audio
+// packets from the socket thread (producer, Put()) to the thread which reads
+// the jitter buffer (consumer, Get(), Reset()) without locking a mutex.
+class CNetFrameQueue
+{
+public:
+    CNetFrameQueue();
+
+    bool Put ( const CVector<uint8_t>& vecbyData, const int iInSize );
+    bool Get ( CVector<uint8_t>& vecbyData, int& iOutSize );
+    void Reset();
+
+protected:
+    CVector<uint8_t> vecbyMemory;
+    int              veciFrameSizes[NUM_NET_FRAME_QUEUE_SLOTS];
+    QAtomicInt       iPutPos;
+    QAtomicInt       iGetPos;
+};
+
+
 // Conversion buffer (very simple buffer) --------------------------------------
 // For this very simple buffer no wrap around mechanism is implemented. We
 // assume here, that the applied buffers are an integer fraction of the total
@@ -28,12 +28,23 @@
 // CChannel implementation *****************************************************
 CChannel::CChannel ( const bool bNIsServer ) :
     vecdGains              ( MAX_NUM_CHANNELS, 1.0 ),
+    iGainsVersion          ( 0 ),
+    vecbyRecFrame          ( MAX_SIZE_BYTES_NET_FRAME_QUEUE_SLOT ),
     bDoAutoSockBufSize     ( true ),
+    bAudioPacketExt        ( 0 ),
+    iSendSeqNum            ( 0 ),
     iFadeInCnt             ( 0 ),
     iFadeInCntMax          ( FADE_IN_NUM_FRAMES_DBLE_FRAMESIZE ),
     bIsEnabled             ( false ),
     bIsServer              ( bNIsServer ),
-    iAudioFrameSizeSamples ( DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES )
+    iAudioFrameSizeSamples ( DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES ),
+    bConClientListDeltas   ( 0 ),
+    bChannelLevelDeltas    ( 0 ),
+    bChannelLevelComplete  ( true ),
+    vecbChannelLevelSubscr ( MAX_NUM_CHANNELS, true ),
+    vecLastSentLevels      ( MAX_NUM_CHANNELS, 0 ),
+    iChannelLevelSeqNum    ( 0 ),
+    iChannelLevelUpdateCnt ( 0 )
 {
     // reset network transport properties
     ResetNetworkTransportProperties();
@@ -44,11 +55,14 @@ CChannel::CChannel ( const bool bNIsServer ) :
     iConTimeOutStartVal = CON_TIME_OUT_SEC_MAX * SYSTEM_SAMPLE_RATE_HZ;
 
     // init time-out for the buffer with zero -> no connection
-    iConTimeOut = 0;
+    iConTimeOut.storeRelease ( 0 );
 
     // init the socket buffer
     SetSockBufNumFrames ( DEF_NET_BUF_SIZE_NUM_BL );
 
+    // time base of the sender time in the audio packet extension
+    SendTimer.start();
+
     // initialize channel info
     ResetInfo();
 
@@ -58,6 +72,7 @@ CChannel::CChannel ( const bool bNIsServer ) :
 // TODO if we later do not fire vectors in the emits, we can remove this again
 qRegisterMetaType<CVector<uint8_t> > ( "CVector<uint8_t>" );
 qRegisterMetaType<CHostAddress> ( "CHostAddress" );
+qRegisterMetaType<CMesBodyBuf> ( "CMesBodyBuf" );
 
     QObject::connect ( &Protocol,
         SIGNAL ( MessReadyForSending ( CVector<uint8_t> ) ),
@@ -83,6 +98,10 @@ qRegisterMetaType<CHostAddress> ( "CHostAddress" );
         SIGNAL ( ConClientListMesReceived ( CVector<CChannelInfo> ) ),
         SIGNAL ( ConClientListMesReceived ( CVector<CChannelInfo> ) ) );
 
+    QObject::connect ( &Protocol,
+        SIGNAL ( ConClientListDeltaMesReceived ( int, int, bool, CVector<CChannelInfo>, CVector<int> ) ),
+        SIGNAL ( ConClientListDeltaMesReceived ( int, int, bool, CVector<CChannelInfo>, CVector<int> ) ) );
+
     QObject::connect( &Protocol, SIGNAL ( ChangeChanGain ( int, double ) ),
         this, SLOT ( OnChangeChanGain ( int, double ) ) );
 
@@ -108,6 +127,25 @@ qRegisterMetaType<CHostAddress> ( "CHostAddress" );
     QObject::connect ( &Protocol,
         SIGNAL ( ReqChannelLevelList ( bool ) ),
         this, SLOT ( OnReqChannelLevelList ( bool ) ) );
+
+    QObject::connect ( &Protocol,
+        SIGNAL ( ReqConClientListDeltas ( bool ) ),
+        this, SLOT ( OnReqConClientListDeltas ( bool ) ) );
+
+    QObject::connect ( &Protocol,
+        SIGNAL ( ReqChannelLevelSubscr ( bool, CVector<int> ) ),
+        this, SLOT ( OnReqChannelLevelSubscr ( bool, CVector<int> ) ) );
+
+    QObject::connect ( &Protocol,
+        SIGNAL ( AudioPacketExtReceived ( bool, bool ) ),
+        this, SLOT ( OnAudioPacketExtReceived ( bool, bool ) ) );
+
+    // the protocol is reset in the thread of the channel object which does the
+    // protocol handling (the disconnection is detected by the audio
+    // processing), the event is queued before any message of a new client
+    QObject::connect ( this, SIGNAL ( ReqProtocolReset() ),
+        this, SLOT ( OnReqProtocolReset() ),
+        Qt::QueuedConnection );
 }
 
 bool CChannel::ProtocolIsEnabled()
@@ -136,8 +174,11 @@ void CChannel::SetEnable ( const bool bNEnStat )
     // if channel is not enabled, reset time out count and protocol
     if ( !bNEnStat )
     {
-        iConTimeOut = 0;
+        iConTimeOut.storeRelease ( 0 );
         Protocol.Reset();
+
+        // the support of the audio packet extension is negotiated again
+        bAudioPacketExt.storeRelease ( 0 );
     }
 }
 
@@ -181,6 +222,7 @@ void CChannel::SetAudioStreamProperties ( const EAudComprType eNewAudComprType,
         {
             // init conversion buffer
             ConvBuf.Init ( iNetwFrameSize * iNetwFrameSizeFact );
+            vecbyExtPacket.Init ( iNetwFrameSize * iNetwFrameSizeFact + AUDIO_PACKET_EXT_SIZE_BYTES );
         }
         MutexConvBuf.unlock();
 
@@ -251,9 +293,19 @@ void CChannel::SetGain ( const int    iChanID,
     if ( ( iChanID >= 0 ) && ( iChanID < MAX_NUM_CHANNELS ) )
     {
         vecdGains[iChanID] = dNewGain;
+
+        // publish the change for the server mixer
+        iGainsVersion.fetchAndAddOrdered ( 1 );
     }
 }
 
+void CChannel::GetGains ( CVector<double>& vecdCurGains )
+{
+    QMutexLocker locker ( &Mutex );
+
+    std::copy ( vecdGains.begin(), vecdGains.end(), vecdCurGains.begin() );
+}
+
 double CChannel::GetGain ( const int iChanID )
 {
     QMutexLocker locker ( &Mutex );
@@ -407,6 +459,7 @@ void CChannel::OnNetTranspPropsReceived ( CNetworkTransportProps NetworkTranspor
             {
                 // init conversion buffer
                 ConvBuf.Init ( iNetwFrameSize * iNetwFrameSizeFact );
+                vecbyExtPacket.Init ( iNetwFrameSize * iNetwFrameSizeFact + AUDIO_PACKET_EXT_SIZE_BYTES );
             }
             MutexConvBuf.unlock();
         }
@@ -420,6 +473,74 @@ void CChannel::OnReqNetTranspProps()
     Protocol.CreateNetwTranspPropsMes ( GetNetworkTransportPropsFromCurrentSettings() );
 }
 
+void CChannel::OnReqChannelLevelSubscr ( bool         bAllChannels,
+                                         CVector<int> veciChanIDs )
+{
+    QMutexLocker locker ( &Mutex );
+
+    vecbChannelLevelSubscr.Reset ( bAllChannels );
+
+    for ( int i = 0; i < veciChanIDs.Size(); i++ )
+    {
+        vecbChannelLevelSubscr[veciChanIDs[i]] = true;
+    }
+
+    // the levels of newly subscribed channels are not known by the client
+    bChannelLevelDeltas.storeRelease ( 1 );
+    bChannelLevelComplete = true;
+}
+
+bool CChannel::GetChannelLevelDelta ( const CVector<int>&      veciCurChanIDs,
+                                      const CVector<uint16_t>& vecLevels,
+                                      const int                iNumClients,
+                                      int&                     iSeqNum,
+                                      bool&                    bComplete,
+                                      CVector<int>&            veciDeltaChanIDs,
+                                      CVector<uint16_t>&       vecDeltaLevels )
+{
+    QMutexLocker locker ( &Mutex );
+
+    // since the messages may get lost, all subscribed levels are sent from
+    // time to time
+    iChannelLevelUpdateCnt++;
+
+    bComplete = bChannelLevelComplete || ( iChannelLevelUpdateCnt >= CHANNEL_LEVEL_COMPLETE_INTERVAL );
+
+    if ( bComplete )
+    {
+        bChannelLevelComplete  = false;
+        iChannelLevelUpdateCnt = 0;
+    }
+
+    veciDeltaChanIDs.Init ( 0 );
+    vecDeltaLevels.Init ( 0 );
+
+    for ( int j = 0; j < iNumClients; j++ )
+    {
+        const int iChID = veciCurChanIDs[j];
+
+        if ( vecbChannelLevelSubscr[iChID] &&
+             ( bComplete || ( vecLevels[j] != vecLastSentLevels[iChID] ) ) )
+        {
+            veciDeltaChanIDs.Add ( iChID );
+            vecDeltaLevels.Add ( vecLevels[j] );
+
+            vecLastSentLevels[iChID] = vecLevels[j];
+        }
+    }
+
+    // nothing to send if no level has changed
+    if ( !bComplete && ( veciDeltaChanIDs.Size() == 0 ) )
+    {
+        return false;
+    }
+
+    iSeqNum             = iChannelLevelSeqNum;
+    iChannelLevelSeqNum = ( iChannelLevelSeqNum + 1 ) & 0xFF;
+
+    return true;
+}
+
 CNetworkTransportProps CChannel::GetNetworkTransportPropsFromCurrentSettings()
 {
     // use current stored settings of the channel to fill the network transport
@@ -433,6 +554,19 @@ CNetworkTransportProps CChannel::GetNetworkTransportPropsFromCurrentSettings()
                                     0 );
 }
 
+void CChannel::Connect()
+{
+    // init audio fade-in counter (it is also changed in GetData())
+    MutexSocketBuf.lock();
+    {
+        iFadeInCnt = 0;
+    }
+    MutexSocketBuf.unlock();
+
+    // from now on the channel is processed by the audio processing
+    iConTimeOut.storeRelease ( iConTimeOutStartVal );
+}
+
 void CChannel::Disconnect()
 {
     // we only have to disconnect the channel if it is actually connected
@@ -441,7 +575,7 @@ void CChannel::Disconnect()
         // set time out counter to a small value > 0 so that the next time a
         // received audio block is queried, the disconnection is performed
         // (assuming that no audio packet is received in the meantime)
-        iConTimeOut = 1; // a small number > 0
+        iConTimeOut.storeRelease ( 1 ); // a small number > 0
     }
 }
 
@@ -476,13 +610,15 @@ EPutDataStat CChannel::PutAudioData ( const CVector<uint8_t>& vecbyData,
     if ( ( bIsServer || ( GetAddress() == RecHostAddr ) ) &&
          IsEnabled() )
     {
-        MutexSocketBuf.lock();
+        // only process audio if packet has correct size
+        if ( IsAudioPacketSize ( iNumBytes ) )
         {
-            // only process audio if packet has correct size
-            if ( iNumBytes == ( iNetwFrameSize * iNetwFrameSizeFact ) )
+            if ( bIsServer )
             {
-                // store new packet in jitter buffer
-                if ( SockBuf.Put ( vecbyData, iNumBytes ) )
+                // the server must not block the socket thread on the jitter
+                // buffer which is read by the mixer, therefore the packet is
+                // only queued here and moved to the jitter buffer in GetData()
+                if ( RecFrameQueue.Put ( vecbyData, iNumBytes ) )
                 {
                     eRet = PS_AUDIO_OK;
                 }
@@ -490,42 +626,69 @@ EPutDataStat CChannel::PutAudioData ( const CVector<uint8_t>& vecbyData,
                 {
                     eRet = PS_AUDIO_ERR;
                 }
-
-                // manage audio fade-in counter
-                if ( iFadeInCnt < iFadeInCntMax )
-                {
-                    iFadeInCnt++;
-                }
             }
             else
             {
-                // the protocol parsing failed and this was no audio block,
-                // we treat this as protocol error (unkown packet)
-                eRet = PS_PROT_ERR;
+                MutexSocketBuf.lock();
+                {
+                    // store new packet in jitter buffer
+                    if ( PutSockBuf ( vecbyData, iNumBytes ) )
+                    {
+                        eRet = PS_AUDIO_OK;
+                    }
+                    else
+                    {
+                        eRet = PS_AUDIO_ERR;
+                    }
+
+                    // manage audio fade-in counter
+                    if ( iFadeInCnt < iFadeInCntMax )
+                    {
+                        iFadeInCnt++;
+                    }
+                }
+                MutexSocketBuf.unlock();
             }
+        }
+        else
+        {
+            // the protocol parsing failed and this was no audio block,
+            // we treat this as protocol error (unkown packet)
+            eRet = PS_PROT_ERR;
+        }
 
-            // All network packets except of valid protocol messages
-            // regardless if they are valid or invalid audio packets lead to
-            // a state change to a connected channel.
-            // This is because protocol messages can only be sent on a
-            // connected channel and the client has to inform the server
-            // about the audio packet properties via the protocol.
+        // All network packets except of valid protocol messages
+        // regardless if they are valid or invalid audio packets lead to
+        // a state change to a connected channel.
+        // This is because protocol messages can only be sent on a
+        // connected channel and the client has to inform the server
+        // about the audio packet properties via the protocol.
 
-            // check if channel was not connected, this is a new connection
-            if ( !IsConnected() )
-            {
-                // overwrite status
-                eRet = PS_NEW_CONNECTION;
+        // reset time-out counter if the channel is connected (note that
+        // GetData() may decrement the counter concurrently, therefore the
+        // counter is only set if it was not changed in the meantime)
+        int iCurConTimeOut = iConTimeOut.loadAcquire();
 
-                // init audio fade-in counter
-                iFadeInCnt = 0;
-            }
+        while ( ( iCurConTimeOut > 0 ) &&
+                !iConTimeOut.testAndSetOrdered ( iCurConTimeOut, iConTimeOutStartVal ) )
+        {
+            iCurConTimeOut = iConTimeOut.loadAcquire();
+        }
+
+        // check if channel was not connected before, i.e., this is a new
+        // connection
+        if ( iCurConTimeOut <= 0 )
+        {
+            // overwrite status
+            eRet = PS_NEW_CONNECTION;
 
-            // reset time-out counter (note that this must be done after the
-            // "IsConnected()" query above)
-            ResetTimeOutCounter();
+            // the server connects the channel after it has initialized it for
+            // the new client (see CServer::PutAudioData())
+            if ( !bIsServer )
+            {
+                Connect();
+            }
         }
-        MutexSocketBuf.unlock();
     }
     else
     {
@@ -542,29 +705,70 @@ EGetDataStat CChannel::GetData ( CVector<uint8_t>& vecbyData,
 
     MutexSocketBuf.lock();
     {
+        // on the server, first move all packets which were received since the
+        // last call from the lock-free queue into the jitter buffer
+        if ( bIsServer )
+        {
+            int iRecFrameSize;
+
+            while ( RecFrameQueue.Get ( vecbyRecFrame, iRecFrameSize ) )
+            {
+                // packets which were queued before the network transport
+                // properties have changed are dropped
+                if ( IsAudioPacketSize ( iRecFrameSize ) )
+                {
+                    PutSockBuf ( vecbyRecFrame, iRecFrameSize );
+
+                    // manage audio fade-in counter
+                    if ( iFadeInCnt < iFadeInCntMax )
+                    {
+                        iFadeInCnt++;
+                    }
+                }
+            }
+        }
+
         // the socket access must be inside a mutex
         const bool bSockBufState = SockBuf.Get ( vecbyData, iNumBytes );
 
         // decrease time-out counter
-        if ( iConTimeOut > 0 )
+        const int iCurConTimeOut = iConTimeOut.loadAcquire();
+
+        if ( iCurConTimeOut > 0 )
         {
             // subtract the number of samples of the current block since the
             // time out counter is based on samples not on blocks (definition:
             // always one atomic block is get by using the GetData() function
-            // where the atomic block size is "iAudioFrameSizeSamples")
-            iConTimeOut -= iAudioFrameSizeSamples;
-
-            if ( iConTimeOut <= 0 )
+            // where the atomic block size is "iAudioFrameSizeSamples"), note
+            // that the socket thread may reset the counter at any time, we
+            // only disconnect if this did not happen in the meantime (the
+            // value is then set to zero to make sure we do not have negative
+            // values)
+            if ( ( iCurConTimeOut <= iAudioFrameSizeSamples ) &&
+                 iConTimeOut.testAndSetOrdered ( iCurConTimeOut, 0 ) )
             {
                 // channel is just disconnected
-                eGetStatus  = GS_CHAN_NOW_DISCONNECTED;
-                iConTimeOut = 0; // make sure we do not have negative values
+                eGetStatus = GS_CHAN_NOW_DISCONNECTED;
 
-                // reset network transport properties
+                // reset network transport properties and drop the packets
+                // which are still queued
                 ResetNetworkTransportProperties();
+                RecFrameQueue.Reset();
+
+                // a new client on this channel must negotiate the deltas and
+                // the audio packet extension again
+                bConClientListDeltas.storeRelease ( 0 );
+                bChannelLevelDeltas.storeRelease  ( 0 );
+                bAudioPacketExt.storeRelease      ( 0 );
+
             }
             else
             {
+                if ( iCurConTimeOut > iAudioFrameSizeSamples )
+                {
+                    iConTimeOut.fetchAndAddOrdered ( -iAudioFrameSizeSamples );
+                }
+
                 if ( bSockBufState )
                 {
                     // everything is ok
@@ -588,6 +792,14 @@ EGetDataStat CChannel::GetData ( CVector<uint8_t>& vecbyData,
     // in case we are just disconnected, we have to fire a message
     if ( eGetStatus == GS_CHAN_NOW_DISCONNECTED )
     {
+        // the protocol of a new client on this channel starts from scratch,
+        // e.g. it may not support several messages in flight (the client
+        // resets its protocol when it is disabled)
+        if ( bIsServer )
+        {
+            emit ReqProtocolReset();
+        }
+
         // emit message
         emit Disconnected();
     }
@@ -597,7 +809,8 @@ EGetDataStat CChannel::GetData ( CVector<uint8_t>& vecbyData,
 
 void CChannel::PrepAndSendPacket ( CHighPrioSocket*        pSocket,
                                    const CVector<uint8_t>& vecbyNPacket,
-                                   const int               iNPacketLen )
+                                   const int               iNPacketLen,
+                                   const bool              bQueuePacket )
 {
     QMutexLocker locker ( &MutexConvBuf );
 
@@ -605,8 +818,60 @@ void CChannel::PrepAndSendPacket ( CHighPrioSocket*        pSocket,
     // block size
     if ( ConvBuf.Put ( vecbyNPacket, iNPacketLen ) )
     {
-        pSocket->SendPacket ( ConvBuf.GetAll(), GetAddress() );
+        const CVector<uint8_t>* pvecbyPacket;
+
+        // the flag is read once so that the packet has a consistent layout
+        if ( bAudioPacketExt.loadAcquire() != 0 )
+        {
+            // append the sequence number and the sender time (little endian)
+            const int      iAudioSize  = iNetwFrameSize * iNetwFrameSizeFact;
+            const uint32_t iSendTimeUs = static_cast<uint32_t> ( SendTimer.nsecsElapsed() / 1000 );
+
+            ConvBuf.GetAll ( vecbyExtPacket, iAudioSize );
+
+            vecbyExtPacket[iAudioSize]     = static_cast<uint8_t> ( iSendSeqNum & 0xFF );
+            vecbyExtPacket[iAudioSize + 1] = static_cast<uint8_t> ( ( iSendSeqNum >> 8 ) & 0xFF );
+
+            for ( int i = 0; i < 4; i++ )
+            {
+                vecbyExtPacket[iAudioSize + 2 + i] = static_cast<uint8_t> ( ( iSendTimeUs >> ( 8 * i ) ) & 0xFF );
+            }
+
+            iSendSeqNum  = ( iSendSeqNum + 1 ) & 0xFFFF;
+            pvecbyPacket = &vecbyExtPacket;
+        }
+        else
+        {
+            pvecbyPacket = &ConvBuf.GetAll();
+        }
+
+        // queued packets are sent on the next flush of the socket packet queue
+        if ( bQueuePacket )
+        {
+            pSocket->QueuePacket ( *pvecbyPacket, GetAddress() );
+        }
+        else
+        {
+            pSocket->SendPacket ( *pvecbyPacket, GetAddress() );
+        }
+    }
+}
+
+bool CChannel::PutSockBuf ( const CVector<uint8_t>& vecbyData,
+                            const int               iNumBytes )
+{
+    const int iAudioSize = iNetwFrameSize * iNetwFrameSizeFact;
+
+    if ( iNumBytes == iAudioSize + AUDIO_PACKET_EXT_SIZE_BYTES )
+    {
+        // the jitter buffer places the packet by its sequence number (the
+        // sender time is not evaluated)
+        const int iSeqNum = vecbyData[iAudioSize] | ( vecbyData[iAudioSize + 1] << 8 );
+
+        return SockBuf.Put ( vecbyData, iAudioSize, iSeqNum );
     }
+
+    return SockBuf.Put ( vecbyData, iAudioSize );
 }
 
 int CChannel::GetUploadRateKbps()
@@ -619,7 +884,10 @@ int CChannel::GetUploadRateKbps()
     // 8 (UDP) + 20 (IP without optional fields) = 28 bytes
     // 2 (PPP) + 6 (PPPoE) + 18 (MAC)            = 26 bytes
     // 5 (RFC1483B) + 8 (AAL) + 10 (ATM)         = 23 bytes
-    return ( iNetwFrameSize * iNetwFrameSizeFact + 28 + 26 + 23 /* header */ ) *
+    // (the audio packet extension is added if it is used)
+    const int iAudioPacketExtSize = ( bAudioPacketExt.loadAcquire() != 0 ) ? AUDIO_PACKET_EXT_SIZE_BYTES : 0;
+
+    return ( iNetwFrameSize * iNetwFrameSizeFact + iAudioPacketExtSize + 28 + 26 + 23 /* header */ ) *
         8 /* bits per byte */ *
         SYSTEM_SAMPLE_RATE_HZ / iAudioSizeOut / 1000;
 }
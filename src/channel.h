@@ -26,6 +26,7 @@
 
 #include <QThread>
 #include <QDateTime>
+#include <QElapsedTimer>
 #include <QFile>
 #include <QTextStream>
 #include "global.h"
@@ -45,6 +46,10 @@
 #define FADE_IN_NUM_FRAMES                   2250
 #define FADE_IN_NUM_FRAMES_DBLE_FRAMESIZE    1125
 
+// size of the extension with the sequence number and the sender time which is
+// appended to the audio packets (see PROTMESSID_AUDIO_PACKET_EXT)
+#define AUDIO_PACKET_EXT_SIZE_BYTES          6
+
 
 enum EPutDataStat
 {
@@ -83,10 +88,12 @@ public:
 
     void PrepAndSendPacket ( CHighPrioSocket*        pSocket,
                              const CVector<uint8_t>& vecbyNPacket,
-                             const int               iNPacketLen );
+                             const int               iNPacketLen,
+                             const bool              bQueuePacket = false );
 
-    void ResetTimeOutCounter() { iConTimeOut = iConTimeOutStartVal; }
-    bool IsConnected() const { return iConTimeOut > 0; }
+    void ResetTimeOutCounter() { iConTimeOut.storeRelease ( iConTimeOutStartVal ); }
+    bool IsConnected() const { return iConTimeOut.loadAcquire() > 0; }
+    void Connect();
     void Disconnect();
 
     void SetEnable ( const bool bNEnStat );
@@ -108,6 +115,11 @@ public:
 
     void SetGain ( const int iChanID, const double dNewGain );
     double GetGain ( const int iChanID );
+
+    // the version is incremented on each gain change so that the server mixer
+    // only has to copy the gains (with locked mutex) if they have changed
+    int GetGainsVersion() const { return iGainsVersion.loadAcquire(); }
+    void GetGains ( CVector<double>& vecdCurGains );
     double GetFadeInGain() { return static_cast<double> ( iFadeInCnt ) / iFadeInCntMax; }
 
     void SetRemoteChanGain ( const int iId, const double dGain )
@@ -156,12 +168,36 @@ public:
     void CreateLicReqMes ( const ELicenceType eLicenceType ) { Protocol.CreateLicenceRequiredMes ( eLicenceType ); }
     void CreateReqChannelLevelListMes ( bool bOptIn )        { Protocol.CreateReqChannelLevelListMes ( bOptIn ); }
 
+    void CreateReqConClientListDeltasMes ( bool bOptIn )     { Protocol.CreateReqConClientListDeltasMes ( bOptIn ); }
+    void CreateAudioPacketExtMes()                           { Protocol.CreateAudioPacketExtMes ( true, true ); }
+
+    void CreateReqChannelLevelSubscrMes ( const bool          bAllChannels,
+                                          const CVector<int>& veciChanIDs )
+        { Protocol.CreateReqChannelLevelSubscrMes ( bAllChannels, veciChanIDs ); }
+
     void CreateConClientListMes ( const CVector<CChannelInfo>& vecChanInfo )
         { Protocol.CreateConClientListMes ( vecChanInfo ); }
 
+    void CreateConClientListDeltaMes ( const int                    iVersion,
+                                       const int                    iBaseVersion,
+                                       const bool                   bReset,
+                                       const CVector<CChannelInfo>& vecChanInfo,
+                                       const CVector<int>&          veciRemovedChanIDs )
+        { Protocol.CreateConClientListDeltaMes ( iVersion, iBaseVersion, bReset, vecChanInfo, veciRemovedChanIDs ); }
+
     CNetworkTransportProps GetNetworkTransportPropsFromCurrentSettings();
 
     bool ChannelLevelsRequired() const                { return bChannelLevelsRequired; }
+    bool ConClientListDeltasSupported() const         { return bConClientListDeltas.loadAcquire() != 0; }
+    bool ChannelLevelDeltasSupported() const          { return bChannelLevelDeltas.loadAcquire() != 0; }
+
+    bool GetChannelLevelDelta ( const CVector<int>&      veciCurChanIDs,
+                                const CVector<uint16_t>& vecLevels,
+                                const int                iNumClients,
+                                int&                     iSeqNum,
+                                bool&                    bComplete,
+                                CVector<int>&            veciDeltaChanIDs,
+                                CVector<uint16_t>&       vecDeltaLevels );
 
     double GetPrevLevel() const              { return dPrevLevel; }
     void   SetPrevLevel ( const double nPL ) { dPrevLevel = nPL; }
@@ -169,6 +205,16 @@ public:
 protected:
     bool ProtocolIsEnabled();
 
+    bool IsAudioPacketSize ( const int iNumBytes ) const
+    {
+        // audio packets with and without the extension are accepted
+        return ( iNumBytes == iNetwFrameSize * iNetwFrameSizeFact ) ||
+               ( iNumBytes == iNetwFrameSize * iNetwFrameSizeFact + AUDIO_PACKET_EXT_SIZE_BYTES );
+    }
+
+    bool PutSockBuf ( const CVector<uint8_t>& vecbyData,
+                      const int               iNumBytes );
+
     void ResetNetworkTransportProperties()
     {
         // set it to a state were no decoding is ever possible (since we want
@@ -190,19 +236,32 @@ protected:
 
     // mixer and effect settings
     CVector<double>   vecdGains;
+    QAtomicInt        iGainsVersion;
 
-    // network jitter-buffer
+    // network jitter-buffer (on the server the received packets are handed over
+    // by the socket thread to the jitter-buffer through the lock-free queue)
     CNetBufWithStats  SockBuf;
+    CNetFrameQueue    RecFrameQueue;
+    CVector<uint8_t>  vecbyRecFrame;
     int               iCurSockBufNumFrames;
     bool              bDoAutoSockBufSize;
 
     // network output conversion buffer
     CConvBuf<uint8_t> ConvBuf;
 
+    // the other side accepts audio packets with the extension, the packet
+    // is copied in the extension buffer to append the sequence number and the
+    // sender time (the negotiated flags are atomic since they are read by the
+    // mix/encode threads)
+    QAtomicInt        bAudioPacketExt;
+    int               iSendSeqNum;
+    QElapsedTimer     SendTimer;
+    CVector<uint8_t>  vecbyExtPacket;
+
     // network protocol
     CProtocol         Protocol;
 
-    int               iConTimeOut;
+    QAtomicInt        iConTimeOut;
     int               iConTimeOutStartVal;
     int               iFadeInCnt;
     int               iFadeInCntMax;
@@ -224,6 +283,18 @@ protected:
     bool              bChannelLevelsRequired;
     double            dPrevLevel;
 
+    // the client understands the connected clients list delta messages
+    QAtomicInt        bConClientListDeltas;
+
+    // channel level deltas subscription of the client (indexed by channel ID)
+    // and the levels which were sent last for the delta coding
+    QAtomicInt        bChannelLevelDeltas;
+    bool              bChannelLevelComplete;
+    CVector<int>      vecbChannelLevelSubscr;
+    CVector<uint16_t> vecLastSentLevels;
+    int               iChannelLevelSeqNum;
+    int               iChannelLevelUpdateCnt;
+
 public slots:
     void OnSendProtMessage ( CVector<uint8_t> vecMessage );
     void OnJittBufSizeChange ( int iNewJitBufSize );
@@ -240,25 +311,48 @@ public slots:
         Protocol.ParseMessageBody ( vecbyMesBodyData, iRecCounter, iRecID );
     }
 
-    void OnProtcolMessageReceived ( int              iRecCounter,
-                                    int              iRecID,
-                                    CVector<uint8_t> vecbyMesBodyData,
-                                    CHostAddress     RecHostAddr )
+    void OnProtcolMessageReceived ( int          iRecCounter,
+                                    int          iRecID,
+                                    CMesBodyBuf  MesBodyBuf,
+                                    CHostAddress RecHostAddr )
     {
-        PutProtcolData ( iRecCounter, iRecID, vecbyMesBodyData, RecHostAddr );
+        PutProtcolData ( iRecCounter, iRecID, MesBodyBuf.GetData(), RecHostAddr );
     }
 
-    void OnProtcolCLMessageReceived ( int              iRecID,
-                                      CVector<uint8_t> vecbyMesBodyData,
-                                      CHostAddress     RecHostAddr )
+    void OnProtcolCLMessageReceived ( int          iRecID,
+                                      CMesBodyBuf  MesBodyBuf,
+                                      CHostAddress RecHostAddr )
     {
-        emit DetectedCLMessage ( vecbyMesBodyData, iRecID, RecHostAddr );
+        emit DetectedCLMessage ( MesBodyBuf, iRecID, RecHostAddr );
     }
 
     void OnNewConnection() { emit NewConnection(); }
+    void OnReqProtocolReset() { Protocol.Reset(); }
 
     void OnReqChannelLevelList ( bool bOptIn ) { bChannelLevelsRequired = bOptIn; }
 
+    void OnReqConClientListDeltas ( bool bOptIn )
+    {
+        bConClientListDeltas.storeRelease ( bOptIn ? 1 : 0 );
+
+        // the client needs the complete list in the new format now
+        emit ReqConnClientsList();
+    }
+
+    void OnReqChannelLevelSubscr ( bool         bAllChannels,
+                                   CVector<int> veciChanIDs );
+
+    void OnAudioPacketExtReceived ( bool bSupported, bool bReqAnswer )
+    {
+        bAudioPacketExt.storeRelease ( bSupported ? 1 : 0 );
+
+        // we always accept audio packets with the extension
+        if ( bReqAnswer )
+        {
+            Protocol.CreateAudioPacketExtMes ( true, false );
+        }
+    }
+
 signals:
     void MessReadyForSending ( CVector<uint8_t> vecMessage );
     void NewConnection();
@@ -267,16 +361,22 @@ signals:
     void ServerAutoSockBufSizeChange ( int iNNumFra );
     void ReqConnClientsList();
     void ConClientListMesReceived ( CVector<CChannelInfo> vecChanInfo );
+    void ConClientListDeltaMesReceived ( int                   iVersion,
+                                         int                   iBaseVersion,
+                                         bool                  bReset,
+                                         CVector<CChannelInfo> vecChanInfo,
+                                         CVector<int>          veciRemovedChanIDs );
     void ChanInfoHasChanged();
     void ReqChanInfo();
     void ChatTextReceived ( QString strChatText );
     void ReqNetTranspProps();
     void LicenceRequired ( ELicenceType eLicenceType );
     void Disconnected();
+    void ReqProtocolReset();
 
-    void DetectedCLMessage ( CVector<uint8_t> vecbyMesBodyData,
-                             int              iRecID,
-                             CHostAddress     RecHostAddr );
+    void DetectedCLMessage ( CMesBodyBuf  MesBodyBuf,
+                             int          iRecID,
+                             CHostAddress RecHostAddr );
 
     void ParseMessageBody ( CVector<uint8_t> vecbyMesBodyData,
                             int              iRecCounter,
@@ -78,7 +78,13 @@ CClient::CClient ( const quint16  iPortNumber,
     bJitterBufferOK                  ( true ),
     strCentralServerAddress          ( "" ),
     eCentralServerAddressType        ( AT_DEFAULT ),
-    iServerSockBufNumFrames          ( DEF_NET_BUF_SIZE_NUM_BL )
+    iServerSockBufNumFrames          ( DEF_NET_BUF_SIZE_NUM_BL ),
+    vecConClientTable                ( MAX_NUM_CHANNELS ),
+    vecConClientTableUsed            ( MAX_NUM_CHANNELS, false ),
+    iConClientListVersion            ( INVALID_CHAN_LIST_VERSION ),
+    vecChannelLevelsByChanID         ( MAX_NUM_CHANNELS, 0 ),
+    iChannelLevelSeqNum              ( INVALID_LEVEL_SEQ_NUM ),
+    bChannelLevelSubscrAll           ( true )
 {
     int iOpusError;
 
@@ -128,8 +134,8 @@ CClient::CClient ( const quint16  iPortNumber,
         this, SLOT ( OnSendProtMessage ( CVector<uint8_t> ) ) );
 
     QObject::connect ( &Channel,
-        SIGNAL ( DetectedCLMessage ( CVector<uint8_t>, int, CHostAddress ) ),
-        this, SLOT ( OnDetectedCLMessage ( CVector<uint8_t>, int, CHostAddress ) ) );
+        SIGNAL ( DetectedCLMessage ( CMesBodyBuf, int, CHostAddress ) ),
+        this, SLOT ( OnDetectedCLMessage ( CMesBodyBuf, int, CHostAddress ) ) );
 
     QObject::connect ( &Channel, SIGNAL ( ReqJittBufSize() ),
         this, SLOT ( OnReqJittBufSize() ) );
@@ -144,6 +150,10 @@ CClient::CClient ( const quint16  iPortNumber,
         SIGNAL ( ConClientListMesReceived ( CVector<CChannelInfo> ) ),
         SIGNAL ( ConClientListMesReceived ( CVector<CChannelInfo> ) ) );
 
+    QObject::connect ( &Channel,
+        SIGNAL ( ConClientListDeltaMesReceived ( int, int, bool, CVector<CChannelInfo>, CVector<int> ) ),
+        this, SLOT ( OnConClientListDeltaMesReceived ( int, int, bool, CVector<CChannelInfo>, CVector<int> ) ) );
+
     QObject::connect ( &Channel,
         SIGNAL ( Disconnected() ),
         SIGNAL ( Disconnected() ) );
@@ -193,6 +203,10 @@ CClient::CClient ( const quint16  iPortNumber,
         SIGNAL ( CLChannelLevelListReceived ( CHostAddress, CVector<uint16_t> ) ),
         this, SLOT ( OnCLChannelLevelListReceived ( CHostAddress, CVector<uint16_t> ) ) );
 
+    QObject::connect ( &ConnLessProtocol,
+        SIGNAL ( CLChannelLevelDeltaReceived ( CHostAddress, int, bool, CVector<int>, CVector<uint16_t> ) ),
+        this, SLOT ( OnCLChannelLevelDeltaReceived ( CHostAddress, int, bool, CVector<int>, CVector<uint16_t> ) ) );
+
     // other
     QObject::connect ( &Sound, SIGNAL ( ReinitRequest ( int ) ),
         this, SLOT ( OnSndCrdReinitRequest ( int ) ) );
@@ -244,12 +258,12 @@ void CClient::OnInvalidPacketReceived ( CHostAddress RecHostAddr )
     }
 }
 
-void CClient::OnDetectedCLMessage ( CVector<uint8_t> vecbyMesBodyData,
-                                    int              iRecID,
-                                    CHostAddress     RecHostAddr )
+void CClient::OnDetectedCLMessage ( CMesBodyBuf  MesBodyBuf,
+                                    int          iRecID,
+                                    CHostAddress RecHostAddr )
 {
     // connection less messages are always processed
-    ConnLessProtocol.ParseConnectionLessMessageBody ( vecbyMesBodyData,
+    ConnLessProtocol.ParseConnectionLessMessageBody ( MesBodyBuf.GetData(),
                                                       iRecID,
                                                       RecHostAddr );
 }
@@ -284,6 +298,81 @@ void CClient::OnNewConnection()
 
     // send opt-in / out for Channel Level updates
     Channel.CreateReqChannelLevelListMes ( bDisplayChannelLevels );
+
+    // we understand the channel level deltas (old servers ignore the
+    // subscription and keep on sending the complete level list)
+    iChannelLevelSeqNum = INVALID_LEVEL_SEQ_NUM;
+    vecChannelLevelsByChanID.Reset ( 0 );
+    Channel.CreateReqChannelLevelSubscrMes ( bChannelLevelSubscrAll, veciChannelLevelSubscr );
+
+    // we understand the connected clients list deltas, the server answers
+    // with the complete list (old servers ignore the message and keep on
+    // sending the complete list on each change)
+    iConClientListVersion = INVALID_CHAN_LIST_VERSION;
+    Channel.CreateReqConClientListDeltasMes ( true );
+
+    // we accept audio packets with sequence numbers, the server answers with
+    // its support and only then we append the extension to our audio packets
+    // (old servers ignore the message)
+    Channel.CreateAudioPacketExtMes();
+}
+
+void CClient::OnConClientListDeltaMesReceived ( int                   iVersion,
+                                                int                   iBaseVersion,
+                                                bool                  bReset,
+                                                CVector<CChannelInfo> vecChanInfo,
+                                                CVector<int>          veciRemovedChanIDs )
+{
+    if ( !bReset && ( iBaseVersion != iConClientListVersion ) )
+    {
+        // we missed a change, request the complete list once (the deltas
+        // which arrive until then are ignored)
+        if ( iConClientListVersion != INVALID_CHAN_LIST_VERSION )
+        {
+            iConClientListVersion = INVALID_CHAN_LIST_VERSION;
+            Channel.CreateReqConnClientsList();
+        }
+        return;
+    }
+
+    if ( bReset )
+    {
+        vecConClientTableUsed.Reset ( false );
+    }
+
+    for ( int i = 0; i < veciRemovedChanIDs.Size(); i++ )
+    {
+        if ( ( veciRemovedChanIDs[i] >= 0 ) && ( veciRemovedChanIDs[i] < MAX_NUM_CHANNELS ) )
+        {
+            vecConClientTableUsed[veciRemovedChanIDs[i]] = false;
+        }
+    }
+
+    for ( int i = 0; i < vecChanInfo.Size(); i++ )
+    {
+        const int iChanID = vecChanInfo[i].iChanID;
+
+        if ( ( iChanID >= 0 ) && ( iChanID < MAX_NUM_CHANNELS ) )
+        {
+            vecConClientTable[iChanID]     = vecChanInfo[i];
+            vecConClientTableUsed[iChanID] = true;
+        }
+    }
+
+    iConClientListVersion = iVersion;
+
+    // the GUI gets the complete list as with the old list message
+    CVector<CChannelInfo> vecConClientList ( 0 );
+
+    for ( int i = 0; i < MAX_NUM_CHANNELS; i++ )
+    {
+        if ( vecConClientTableUsed[i] )
+        {
+            vecConClientList.Add ( vecConClientTable[i] );
+        }
+    }
+
+    emit ConClientListMesReceived ( vecConClientList );
 }
 
 void CClient::CreateServerJitterBufferMessage()
@@ -410,6 +499,15 @@ void CClient::SetDisplayChannelLevels ( const bool bNDCL )
     Channel.CreateReqChannelLevelListMes ( bDisplayChannelLevels );
 }
 
+void CClient::SetChannelLevelSubscription ( const CVector<int>& veciChanIDs )
+{
+    bChannelLevelSubscrAll = false;
+    veciChannelLevelSubscr = veciChanIDs;
+
+    // tell any connected server about the change
+    Channel.CreateReqChannelLevelSubscrMes ( bChannelLevelSubscrAll, veciChannelLevelSubscr );
+}
+
 void CClient::SetSndCrdPrefFrameSizeFactor ( const int iNewFactor )
 {
     // first check new input parameter
@@ -647,6 +745,37 @@ void CClient::OnCLChannelLevelListReceived ( CHostAddress      InetAddr,
     emit CLChannelLevelListReceived ( InetAddr, vecLevelList );
 }
 
+void CClient::OnCLChannelLevelDeltaReceived ( CHostAddress      InetAddr,
+                                              int               iSeqNum,
+                                              bool              bComplete,
+                                              CVector<int>      veciChanIDs,
+                                              CVector<uint16_t> vecLevelList )
+{
+    // the levels are only accepted from our server and the messages may be
+    // reordered by the network, i.e., we ignore messages which are older than
+    // the last one
+    if ( !( InetAddr == Channel.GetAddress() ) ||
+         ( ( iChannelLevelSeqNum != INVALID_LEVEL_SEQ_NUM ) &&
+           ( static_cast<int8_t> ( iSeqNum - iChannelLevelSeqNum ) <= 0 ) ) )
+    {
+        return;
+    }
+
+    iChannelLevelSeqNum = iSeqNum;
+
+    if ( bComplete )
+    {
+        vecChannelLevelsByChanID.Reset ( 0 );
+    }
+
+    for ( int i = 0; i < veciChanIDs.Size(); i++ )
+    {
+        vecChannelLevelsByChanID[veciChanIDs[i]] = vecLevelList[i];
+    }
+
+    emit ChannelLevelsByChanIDReceived ( vecChannelLevelsByChanID );
+}
+
 void CClient::Start()
 {
     // init object
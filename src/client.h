@@ -128,6 +128,10 @@ public:
     bool GetDisplayChannelLevels() const { return bDisplayChannelLevels; }
     void SetDisplayChannelLevels ( const bool bNDCL );
 
+    // only the levels of the given channels are required (e.g. the channels
+    // which are visible in the mixer board)
+    void SetChannelLevelSubscription ( const CVector<int>& veciChanIDs );
+
     EAudioQuality GetAudioQuality() const { return eAudioQuality; }
     void SetAudioQuality ( const EAudioQuality eNAudioQuality );
 
@@ -383,6 +387,19 @@ protected:
     // server settings
     int                     iServerSockBufNumFrames;
 
+    // connected clients list which is kept up to date by the list deltas
+    // (indexed by the channel ID)
+    CVector<CChannelInfo>   vecConClientTable;
+    CVector<int>            vecConClientTableUsed;
+    int                     iConClientListVersion;
+
+    // channel levels which are kept up to date by the level deltas (indexed by
+    // the channel ID) and the subscribed channels
+    CVector<uint16_t>       vecChannelLevelsByChanID;
+    int                     iChannelLevelSeqNum;
+    bool                    bChannelLevelSubscrAll;
+    CVector<int>            veciChannelLevelSubscr;
+
     // for ping measurement
     CPreciseTime            PreciseTime;
 
@@ -390,9 +407,9 @@ public slots:
     void OnSendProtMessage ( CVector<uint8_t> vecMessage );
     void OnInvalidPacketReceived ( CHostAddress RecHostAddr );
 
-    void OnDetectedCLMessage ( CVector<uint8_t> vecbyMesBodyData,
-                               int              iRecID,
-                               CHostAddress     RecHostAddr );
+    void OnDetectedCLMessage ( CMesBodyBuf  MesBodyBuf,
+                               int          iRecID,
+                               CHostAddress RecHostAddr );
 
     void OnReqJittBufSize() { CreateServerJitterBufferMessage(); }
     void OnJittBufSizeChanged ( int iNewJitBufSize );
@@ -414,6 +431,18 @@ public slots:
     void OnCLChannelLevelListReceived ( CHostAddress      InetAddr,
                                         CVector<uint16_t> vecLevelList );
 
+    void OnCLChannelLevelDeltaReceived ( CHostAddress      InetAddr,
+                                         int               iSeqNum,
+                                         bool              bComplete,
+                                         CVector<int>      veciChanIDs,
+                                         CVector<uint16_t> vecLevelList );
+
+    void OnConClientListDeltaMesReceived ( int                   iVersion,
+                                           int                   iBaseVersion,
+                                           bool                  bReset,
+                                           CVector<CChannelInfo> vecChanInfo,
+                                           CVector<int>          veciRemovedChanIDs );
+
 signals:
     void ConClientListMesReceived ( CVector<CChannelInfo> vecChanInfo );
     void ChatTextReceived ( QString strChatText );
@@ -439,6 +468,8 @@ signals:
     void CLChannelLevelListReceived ( CHostAddress      InetAddr,
                                       CVector<uint16_t> vecLevelList );
 
+    void ChannelLevelsByChanIDReceived ( CVector<uint16_t> vecLevelsByChanID );
+
     void Disconnected();
     void ControllerInFaderLevel ( int iChannelIdx, int iValue );
     void CentralServerAddressTypeChanged();
@@ -497,6 +497,10 @@ CClientDlg::CClientDlg ( CClient*        pNCliP,
         SIGNAL ( CLChannelLevelListReceived ( CHostAddress, CVector<uint16_t> ) ),
         this, SLOT ( OnCLChannelLevelListReceived ( CHostAddress, CVector<uint16_t> ) ) );
 
+    QObject::connect ( pClient,
+        SIGNAL ( ChannelLevelsByChanIDReceived ( CVector<uint16_t> ) ),
+        this, SLOT ( OnChannelLevelsByChanIDReceived ( CVector<uint16_t> ) ) );
+
 #ifdef ENABLE_CLIENT_VERSION_AND_OS_DEBUGGING
     QObject::connect ( pClient,
         SIGNAL ( CLVersionAndOSReceived ( CHostAddress, COSUtil::EOpSystemType, QString ) ),
@@ -524,6 +528,9 @@ CClientDlg::CClientDlg ( CClient*        pNCliP,
     QObject::connect ( MainMixerBoard, SIGNAL ( NumClientsChanged ( int ) ),
         this, SLOT ( OnNumClientsChanged ( int ) ) );
 
+    QObject::connect ( MainMixerBoard, SIGNAL ( ViewportChannelsChanged ( CVector<int> ) ),
+        this, SLOT ( OnViewportChannelsChanged ( CVector<int> ) ) );
+
     QObject::connect ( &ChatDlg, SIGNAL ( NewLocalInputText ( QString ) ),
         this, SLOT ( OnNewLocalInputText ( QString ) ) );
 
@@ -193,6 +193,12 @@ public slots:
                                         CVector<uint16_t> vecLevelList )
         { MainMixerBoard->SetChannelLevels ( vecLevelList ); }
 
+    void OnChannelLevelsByChanIDReceived ( CVector<uint16_t> vecLevelsByChanID )
+        { MainMixerBoard->SetChannelLevelsByChanID ( vecLevelsByChanID ); }
+
+    void OnViewportChannelsChanged ( CVector<int> veciChanIDs )
+        { pClient->SetChannelLevelSubscription ( veciChanIDs ); }
+
     void OnConnectDlgAccepted();
     void OnDisconnected() { Disconnect(); }
     void OnCentralServerAddressTypeChanged();
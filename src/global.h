@@ -198,6 +198,16 @@ LED bar:      lbr
 // defines the interval between Channel Level updates from the server
 #define CHANNEL_LEVEL_UPDATE_INTERVAL    200  // number of frames at 64 samples frame size
 
+// a channel which nobody listens to is only decoded for the level meters in the
+// last frames before a level update, its level is measured after its decoder
+// has settled (both numbers of frames at 64 samples frame size)
+#define CHANNEL_LEVEL_PROBE_FRAMES       32
+#define CHANNEL_LEVEL_SETTLING_FRAMES    8
+
+// on every n-th channel level update, the delta message contains the levels of
+// all subscribed channels (the messages are not acknowledged)
+#define CHANNEL_LEVEL_COMPLETE_INTERVAL  8
+
 // time-out until a registered server is deleted from the server list if no
 // new registering was made in minutes
 #define SERVLIST_TIME_OUT_MINUTES        60 // minutes
@@ -340,3 +350,11 @@ bool    GetNumericArgument ( QTextStream& tsConsole,
                              double       rRangeStart,
                              double       rRangeStop,
                              double&      rValue);
+
+bool    GetCPUListArgument ( QTextStream& tsConsole,
+                             int          argc,
+                             char**       argv,
+                             int&         i,
+                             QString      strShortOpt,
+                             QString      strLongOpt,
+                             QString&     strArg );
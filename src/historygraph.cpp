@@ -96,6 +96,8 @@ void AHistoryGraph::Start ( const QString& sNewFileName )
 
 void AHistoryGraph::Add ( const QDateTime& newDateTime, const EHistoryItemType curType )
 {
+    QMutexLocker locker ( &Mutex );
+
     if ( bDoHistory )
     {
         // create and add new element in FIFO
@@ -357,6 +359,8 @@ CJpegHistoryGraph::CJpegHistoryGraph ( const int iMaxDaysHistory ) :
 // Override Update to blank out the plot area each time
 void CJpegHistoryGraph::Update()
 {
+    QMutexLocker locker ( &Mutex );
+
     if ( bDoHistory )
     {
         // create JPEG image
@@ -433,6 +437,8 @@ CSvgHistoryGraph::CSvgHistoryGraph ( const int iMaxDaysHistory ) :
 // Override Update to create the fresh SVG stream each time
 void CSvgHistoryGraph::Update()
 {
+    QMutexLocker locker ( &Mutex );
+
     if ( bDoHistory )
     {
         // create SVG document
@@ -30,6 +30,7 @@
 #include <QFile>
 #include <QString>
 #include <QTimer>
+#include <QMutex>
 #include "global.h"
 #include "util.h"
 
@@ -130,6 +131,10 @@ protected:
     unsigned int iYSpace;
     QDate        curDate;
     QTimer       TimerDailyUpdate;
+
+    // the daily update runs in the main thread whereas the entries are added
+    // by the server worker thread for the file accesses
+    QMutex       Mutex;
 };
 
 
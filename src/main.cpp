@@ -61,15 +61,25 @@ int main ( int argc, char** argv )
     bool         bDisconnectAllClientsOnQuit = false;
     bool         bUseDoubleSystemFrameSize   = true; // default is 128 samples frame size
     bool         bShowAnalyzerConsole        = false;
+    bool         bUseReferenceMix            = false;
+    bool         bUseBusMix                  = false;
+    bool         bRunMixKernelBenchmark      = false;
+    bool         bRunCRCBenchmark            = false;
+    bool         bRunWaveCheckpointTest      = false;
+    bool         bRecordCompressed           = false;
     bool         bCentServPingServerInList   = false;
     bool         bNoAutoJackConnect          = false;
     bool         bUseTranslation             = true;
     bool         bCustomPortNumberGiven      = false;
+    bool         bLockMemory                 = false;
     int          iNumServerChannels          = DEFAULT_USED_NUM_CHANNELS;
+    int          iNumMixThreads              = 1;
+    int          iRTPriority                 = 0; // do not change the scheduling
     int          iMaxDaysHistory             = DEFAULT_DAYS_HISTORY;
     int          iCtrlMIDIChannel            = INVALID_MIDI_CH;
     quint16      iPortNumber                 = LLCON_DEFAULT_PORT_NUMBER;
     ELicenceType eLicenceType                = LT_NO_LICENCE;
+    CMixKernels::EKernelType eMixKernelType  = CMixKernels::GetBestKernelType();
     QString      strConnOnStartupAddress     = "";
     QString      strIniFileName              = "";
     QString      strHTMLStatusFileName       = "";
@@ -81,6 +91,10 @@ int main ( int argc, char** argv )
     QString      strServerInfo               = "";
     QString      strWelcomeMessage           = "";
     QString      strClientName               = APP_NAME;
+    QString      strLoadTestServerAddress    = "";
+    QString      strTimerCPUs                = "";
+    QString      strSocketCPUs               = "";
+    QString      strRecorderCPUs             = "";
 
     // QT docu: argv()[0] is the program name, argv()[1] is the first
     // argument and argv()[argc()-1] is the last argument.
@@ -156,6 +170,115 @@ int main ( int argc, char** argv )
         }
 
 
+        // Number of mix threads -----------------------------------------------
+        if ( GetNumericArgument ( tsConsole,
+                                  argc,
+                                  argv,
+                                  i,
+                                  "--mixthreads", // no short form
+                                  "--mixthreads",
+                                  1,
+                                  MAX_NUM_MIX_THREADS,
+                                  rDbleArgument ) )
+        {
+            iNumMixThreads = static_cast<int> ( rDbleArgument );
+
+            tsConsole << "- number of mix threads: "
+                << iNumMixThreads << endl;
+
+            continue;
+        }
+
+
+        // Bus mix -------------------------------------------------------------
+        if ( GetFlagArgument ( argv,
+                               i,
+                               "--busmix", // no short form
+                               "--busmix" ) )
+        {
+            bUseBusMix = true;
+            tsConsole << "- use bus mix" << endl;
+            continue;
+        }
+
+
+        // SCHED_FIFO priority of the frame processing threads -----------------
+        if ( GetNumericArgument ( tsConsole,
+                                  argc,
+                                  argv,
+                                  i,
+                                  "--rtprio", // no short form
+                                  "--rtprio",
+                                  1,
+                                  MAX_RT_FIFO_PRIORITY,
+                                  rDbleArgument ) )
+        {
+            iRTPriority = static_cast<int> ( rDbleArgument );
+
+            tsConsole << "- SCHED_FIFO priority of the timer and mix threads: "
+                << iRTPriority << endl;
+
+            continue;
+        }
+
+
+        // CPU affinity of the frame processing threads ------------------------
+        if ( GetCPUListArgument ( tsConsole,
+                                  argc,
+                                  argv,
+                                  i,
+                                  "--timercpus", // no short form
+                                  "--timercpus",
+                                  strArgument ) )
+        {
+            strTimerCPUs = strArgument;
+            tsConsole << "- CPUs of the timer and mix threads: " << strTimerCPUs << endl;
+            continue;
+        }
+
+
+        // CPU affinity of the socket receive thread ---------------------------
+        if ( GetCPUListArgument ( tsConsole,
+                                  argc,
+                                  argv,
+                                  i,
+                                  "--socketcpus", // no short form
+                                  "--socketcpus",
+                                  strArgument ) )
+        {
+            strSocketCPUs = strArgument;
+            tsConsole << "- CPUs of the socket thread: " << strSocketCPUs << endl;
+            continue;
+        }
+
+
+        // CPU affinity of the jam recorder thread -----------------------------
+        if ( GetCPUListArgument ( tsConsole,
+                                  argc,
+                                  argv,
+                                  i,
+                                  "--recordercpus", // no short form
+                                  "--recordercpus",
+                                  strArgument ) )
+        {
+            strRecorderCPUs = strArgument;
+            tsConsole << "- CPUs of the recorder thread: " << strRecorderCPUs << endl;
+            continue;
+        }
+
+
+        // Lock memory ---------------------------------------------------------
+        if ( GetFlagArgument ( argv,
+                               i,
+                               "--mlockall", // no short form
+                               "--mlockall" ) )
+        {
+            bLockMemory = true;
+            tsConsole << "- lock memory" << endl;
+            continue;
+        }
+
+
         // Maximum days in history display -------------------------------------
         if ( GetNumericArgument ( tsConsole,
                                   argc,
@@ -265,6 +388,90 @@ int main ( int argc, char** argv )
         }
 
 
+        // Use reference mix ---------------------------------------------------
+        // Undocumented debugging command line argument: Use the scalar
+        // reference implementation of the server mix instead of the vectorized
+        // mix kernels (the output is bit-exact to the original server mix).
+        if ( GetFlagArgument ( argv,
+                               i,
+                               "--mixreference", // no short form
+                               "--mixreference" ) )
+        {
+            bUseReferenceMix = true;
+            tsConsole << "- use reference mix" << endl;
+            continue;
+        }
+
+
+        // Mix kernel type -----------------------------------------------------
+        if ( GetStringArgument ( tsConsole,
+                                 argc,
+                                 argv,
+                                 i,
+                                 "--mixkernel", // no short form
+                                 "--mixkernel",
+                                 strArgument ) )
+        {
+            if ( !CMixKernels::GetKernelTypeFromName ( strArgument.toLatin1().constData(), eMixKernelType ) )
+            {
+                tsConsole << argv[0] << ": ";
+                tsConsole << "'--mixkernel' needs one of the arguments generic, sse2 or avx2" << endl;
+                exit ( 1 );
+            }
+
+            if ( !CMixKernels::IsKernelTypeSupported ( eMixKernelType ) )
+            {
+                tsConsole << argv[0] << ": ";
+                tsConsole << "the mix kernel '" << strArgument << "' is not supported by this CPU" << endl;
+                exit ( 1 );
+            }
+
+            tsConsole << "- mix kernel: " << strArgument << endl;
+            continue;
+        }
+
+
+        // Mix kernel benchmark ------------------------------------------------
+        // Undocumented debugging command line argument: Verify that all mix
+        // kernel types supported by the CPU give identical results, compare
+        // them with the scalar reference mix, measure their speed and quit.
+        if ( GetFlagArgument ( argv,
+                               i,
+                               "--benchmarkmix", // no short form
+                               "--benchmarkmix" ) )
+        {
+            bRunMixKernelBenchmark = true;
+            continue;
+        }
+
+
+        // CRC benchmark -------------------------------------------------------
+        // Undocumented debugging command line argument: Verify the protocol
+        // CRC against the bit by bit reference implementation, measure the
+        // speed of both and quit.
+        if ( GetFlagArgument ( argv,
+                               i,
+                               "--benchmarkcrc", // no short form
+                               "--benchmarkcrc" ) )
+        {
+            bRunCRCBenchmark = true;
+            continue;
+        }
+
+
+        // WAV checkpoint test -------------------------------------------------
+        // Undocumented debugging command line argument: Write a WAV file with
+        // checkpoints of the recorder, verify it after each of them and quit.
+        if ( GetFlagArgument ( argv,
+                               i,
+                               "--testwavcheckpoint", // no short form
+                               "--testwavcheckpoint" ) )
+        {
+            bRunWaveCheckpointTest = true;
+            continue;
+        }
+
+
         // Controller MIDI channel ---------------------------------------------
         if ( GetNumericArgument ( tsConsole,
                                   argc,
@@ -343,6 +550,21 @@ int main ( int argc, char** argv )
         }
 
 
+        // Load test -----------------------------------------------------------
+        if ( GetStringArgument ( tsConsole,
+                                 argc,
+                                 argv,
+                                 i,
+                                 "--loadtest", // no short form
+                                 "--loadtest",
+                                 strArgument ) )
+        {
+            strLoadTestServerAddress = strArgument;
+            tsConsole << "- load test of server: " << strLoadTestServerAddress << endl;
+            continue;
+        }
+
+
         // Client Name ---------------------------------------------------------
         if ( GetStringArgument ( tsConsole,
                                  argc,
@@ -388,6 +610,18 @@ int main ( int argc, char** argv )
         }
 
 
+        // Compressed recording ------------------------------------------------
+        if ( GetFlagArgument ( argv,
+                               i,
+                               "--recordopus", // no short form
+                               "--recordopus" ) )
+        {
+            bRecordCompressed = true;
+            tsConsole << "- record Ogg Opus files" << endl;
+            continue;
+        }
+
+
         // Central server ------------------------------------------------------
         if ( GetStringArgument ( tsConsole,
                                  argc,
@@ -571,7 +805,47 @@ int main ( int argc, char** argv )
 
     try
     {
-        if ( bIsClient )
+        if ( bRunCRCBenchmark )
+        {
+            // CRC benchmark (no event loop needed)
+            if ( CCRCBenchmark::Run ( tsConsole ) )
+            {
+                throw CGenErr ( "CRC benchmark failed." );
+            }
+        }
+        else if ( bRunMixKernelBenchmark )
+        {
+            // mix kernel benchmark (no event loop needed)
+            if ( CMixKernelBenchmark::Run ( tsConsole ) )
+            {
+                throw CGenErr ( "Mix kernel benchmark failed." );
+            }
+        }
+        else if ( bRunWaveCheckpointTest )
+        {
+            // WAV checkpoint test (no event loop needed)
+            if ( CWaveCheckpointTest::Run ( tsConsole ) )
+            {
+                throw CGenErr ( "WAV checkpoint test failed." );
+            }
+        }
+        else if ( !strLoadTestServerAddress.isEmpty() )
+        {
+            // Load test:
+            // synthetic clients are connected to an already running server
+            CHostAddress LoadTestServerAddr;
+
+            if ( !NetworkUtil::ParseNetworkAddress ( strLoadTestServerAddress,
+                                                     LoadTestServerAddr ) )
+            {
+                throw CGenErr ( "Invalid load test server address." );
+            }
+
+            CLoadTestbench LoadTestbench ( LoadTestServerAddr, iNumServerChannels );
+
+            pApp->exec();
+        }
+        else if ( bIsClient )
         {
             // Client:
             // actual client object
@@ -611,6 +885,12 @@ int main ( int argc, char** argv )
         else
         {
             // Server:
+            // lock the memory before the server allocates its buffers
+            if ( bLockMemory )
+            {
+                CRealTimeUtil::LockMemory();
+            }
+
             // actual server object
             CServer Server ( iNumServerChannels,
                              iMaxDaysHistory,
@@ -626,7 +906,16 @@ int main ( int argc, char** argv )
                              bCentServPingServerInList,
                              bDisconnectAllClientsOnQuit,
                              bUseDoubleSystemFrameSize,
-                             eLicenceType );
+                             eLicenceType,
+                             iNumMixThreads,
+                             bUseReferenceMix,
+                             bUseBusMix,
+                             eMixKernelType,
+                             bRecordCompressed,
+                             iRTPriority,
+                             strTimerCPUs,
+                             strSocketCPUs,
+                             strRecorderCPUs );
             if ( bUseGUI )
             {
                 // load settings from init-file
@@ -725,6 +1014,25 @@ QString UsageArguments ( char **argv )
         "  -w, --welcomemessage  welcome message on connect\n"
         "  -y, --history         enable connection history and set file name\n"
         "  -z, --startminimized  start minimizied\n"
+        "  --mixthreads          number of threads for mixing and encoding\n"
+        "  --busmix              mix a shared sum of all clients and only add the\n"
+        "                        individual fader differences per client (faster\n"
+        "                        for large sessions)\n"
+        "  --mixkernel           mix kernel type: generic, sse2 or avx2 (default:\n"
+        "                        best type supported by the CPU)\n"
+        "  --recordopus          record compressed Ogg Opus files instead of WAV\n"
+        "                        files\n"
+        "  --rtprio              SCHED_FIFO priority (1-99) of the timer, frame\n"
+        "                        processing (main) and mix threads (Linux only)\n"
+        "  --timercpus           CPU list of the timer, frame processing (main)\n"
+        "                        and mix threads, e.g. 2,3 or 2-5 (Linux only)\n"
+        "  --socketcpus          CPU list of the socket receive thread (Linux only)\n"
+        "  --recordercpus        CPU list of the recorder thread (Linux only)\n"
+        "  --mlockall            lock the memory of the server (Linux only)\n"
+        "\nLoad test:\n"
+        "  --loadtest            connect synthetic clients to the given server\n"
+        "                        address and report the maximum number of\n"
+        "                        clients (-u sets the upper limit)\n"
         "\nClient only:\n"
         "  -c, --connect         connect to given server address on startup\n"
         "  -j, --nojackconnect   disable auto Jack connections\n"
@@ -777,6 +1085,33 @@ bool GetStringArgument ( QTextStream& tsConsole,
     }
 }
 
+bool GetCPUListArgument ( QTextStream& tsConsole,
+                          int          argc,
+                          char**       argv,
+                          int&         i,
+                          QString      strShortOpt,
+                          QString      strLongOpt,
+                          QString&     strArg )
+{
+    CVector<int> veciCPUs;
+
+    if ( GetStringArgument ( tsConsole, argc, argv, i, strShortOpt, strLongOpt, strArg ) )
+    {
+        if ( !CRealTimeUtil::ParseCPUList ( strArg, veciCPUs ) )
+        {
+            tsConsole << argv[0] << ": ";
+            tsConsole << "'" << strLongOpt << "' needs a CPU list argument (e.g. 2,3 or 2-5)" << endl;
+            exit ( 1 );
+        }
+
+        return true;
+    }
+    else
+    {
+        return false;
+    }
+}
+
 bool GetNumericArgument ( QTextStream& tsConsole,
                           int          argc,
                           char**       argv,
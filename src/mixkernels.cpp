@@ -0,0 +1,609 @@
+/******************************************************************************\
+ * Copyright (c) 2020
+ *
+ * Author(s):
+ *  Volker Fischer
+ *
+ ******************************************************************************
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+\******************************************************************************/
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include "mixkernels.h"
+#ifdef USE_SSE2_MIX_KERNEL
+# include <emmintrin.h>
+#endif
+#ifdef USE_AVX2_MIX_KERNEL
+# include <immintrin.h>
+# define AVX2_TARGET __attribute__ ( ( target ( "avx2" ) ) )
+#endif
+
+
+/* Implementation *************************************************************/
+// Generic kernels -------------------------------------------------------------
+// Note that all kernels must do exactly the same float operations per sample
+// (multiply, then add) so that all kernel types give identical results.
+static void AddMonoGeneric ( float*         pfAcc,
+                             const int16_t* psSrc,
+                             const float    fGain,
+                             const int      iNumSamples )
+{
+    for ( int i = 0; i < iNumSamples; i++ )
+    {
+        pfAcc[i] += static_cast<float> ( psSrc[i] ) * fGain;
+    }
+}
+
+static void AddStereoToMonoGeneric ( float*         pfAcc,
+                                     const int16_t* psSrc,
+                                     const float    fGain,
+                                     const int      iNumSamples )
+{
+    const float fHalfGain = fGain * 0.5f;
+
+    for ( int i = 0, k = 0; i < iNumSamples; i++, k += 2 )
+    {
+        pfAcc[i] += static_cast<float> ( psSrc[k] + psSrc[k + 1] ) * fHalfGain;
+    }
+}
+
+static void AddMonoToStereoGeneric ( float*         pfAcc,
+                                     const int16_t* psSrc,
+                                     const float    fGain,
+                                     const int      iNumSamples )
+{
+    for ( int i = 0, k = 0; i < iNumSamples; i++, k += 2 )
+    {
+        const float fValue = static_cast<float> ( psSrc[i] ) * fGain;
+
+        pfAcc[k]     += fValue;
+        pfAcc[k + 1] += fValue;
+    }
+}
+
+static void ToShortGeneric ( int16_t*     psOut,
+                             const float* pfAcc,
+                             const int    iNumSamples )
+{
+    for ( int i = 0; i < iNumSamples; i++ )
+    {
+        float fValue = pfAcc[i];
+
+        if ( fValue < -32768.0f )
+        {
+            fValue = -32768.0f;
+        }
+
+        if ( fValue > 32767.0f )
+        {
+            fValue = 32767.0f;
+        }
+
+        psOut[i] = static_cast<int16_t> ( fValue );
+    }
+}
+
+// the absolute value of -32768 is limited to 32767 like the saturating
+// negation of the vector kernels does
+static inline int AbsSat16 ( const int16_t sValue )
+{
+    return sValue < 0 ? std::min ( -static_cast<int> ( sValue ), 32767 ) : sValue;
+}
+
+static int PeakMonoGeneric ( const int16_t* psSrc,
+                             const int      iNumSamples )
+{
+    int iPeak = 0;
+
+    for ( int i = 0; i < iNumSamples; i++ )
+    {
+        iPeak = std::max ( iPeak, AbsSat16 ( psSrc[i] ) );
+    }
+
+    return iPeak;
+}
+
+static int PeakStereoToMonoGeneric ( const int16_t* psSrc,
+                                     const int      iNumSamples )
+{
+    int iPeak = 0;
+
+    for ( int i = 0, k = 0; i < iNumSamples; i++, k += 2 )
+    {
+        iPeak = std::max ( iPeak, std::abs ( psSrc[k] + psSrc[k + 1] ) );
+    }
+
+    return iPeak;
+}
+
+static void PeakStereoGeneric ( const int16_t* psSrc,
+                                const int      iNumSamples,
+                                int&           iPeakLeft,
+                                int&           iPeakRight )
+{
+    iPeakLeft  = 0;
+    iPeakRight = 0;
+
+    for ( int i = 0, k = 0; i < iNumSamples; i++, k += 2 )
+    {
+        iPeakLeft  = std::max ( iPeakLeft,  AbsSat16 ( psSrc[k] ) );
+        iPeakRight = std::max ( iPeakRight, AbsSat16 ( psSrc[k + 1] ) );
+    }
+}
+
+
+// SSE2 kernels ----------------------------------------------------------------
+#ifdef USE_SSE2_MIX_KERNEL
+static void AddMonoSSE2 ( float*         pfAcc,
+                          const int16_t* psSrc,
+                          const float    fGain,
+                          const int      iNumSamples )
+{
+    const __m128 vGain = _mm_set1_ps ( fGain );
+    int          i     = 0;
+
+    for ( ; i + 8 <= iNumSamples; i += 8 )
+    {
+        // sign extend the 16 bit samples to 32 bit and convert to float
+        const __m128i vSrc = _mm_loadu_si128 ( reinterpret_cast<const __m128i*> ( &psSrc[i] ) );
+        const __m128  vLo  = _mm_cvtepi32_ps ( _mm_srai_epi32 ( _mm_unpacklo_epi16 ( vSrc, vSrc ), 16 ) );
+        const __m128  vHi  = _mm_cvtepi32_ps ( _mm_srai_epi32 ( _mm_unpackhi_epi16 ( vSrc, vSrc ), 16 ) );
+
+        _mm_storeu_ps ( &pfAcc[i],     _mm_add_ps ( _mm_loadu_ps ( &pfAcc[i] ),     _mm_mul_ps ( vLo, vGain ) ) );
+        _mm_storeu_ps ( &pfAcc[i + 4], _mm_add_ps ( _mm_loadu_ps ( &pfAcc[i + 4] ), _mm_mul_ps ( vHi, vGain ) ) );
+    }
+
+    AddMonoGeneric ( &pfAcc[i], &psSrc[i], fGain, iNumSamples - i );
+}
+
+static void AddStereoToMonoSSE2 ( float*         pfAcc,
+                                  const int16_t* psSrc,
+                                  const float    fGain,
+                                  const int      iNumSamples )
+{
+    const __m128  vHalfGain = _mm_set1_ps ( fGain * 0.5f );
+    const __m128i vOnes     = _mm_set1_epi16 ( 1 );
+    int           i         = 0;
+
+    for ( ; i + 8 <= iNumSamples; i += 8 )
+    {
+        // the multiply-add with ones gives the 32 bit sums of left and right
+        const __m128i vSrc0 = _mm_loadu_si128 ( reinterpret_cast<const __m128i*> ( &psSrc[2 * i] ) );
+        const __m128i vSrc1 = _mm_loadu_si128 ( reinterpret_cast<const __m128i*> ( &psSrc[2 * i + 8] ) );
+        const __m128  vLo   = _mm_cvtepi32_ps ( _mm_madd_epi16 ( vSrc0, vOnes ) );
+        const __m128  vHi   = _mm_cvtepi32_ps ( _mm_madd_epi16 ( vSrc1, vOnes ) );
+
+        _mm_storeu_ps ( &pfAcc[i],     _mm_add_ps ( _mm_loadu_ps ( &pfAcc[i] ),     _mm_mul_ps ( vLo, vHalfGain ) ) );
+        _mm_storeu_ps ( &pfAcc[i + 4], _mm_add_ps ( _mm_loadu_ps ( &pfAcc[i + 4] ), _mm_mul_ps ( vHi, vHalfGain ) ) );
+    }
+
+    AddStereoToMonoGeneric ( &pfAcc[i], &psSrc[2 * i], fGain, iNumSamples - i );
+}
+
+static void AddMonoToStereoSSE2 ( float*         pfAcc,
+                                  const int16_t* psSrc,
+                                  const float    fGain,
+                                  const int      iNumSamples )
+{
+    const __m128 vGain = _mm_set1_ps ( fGain );
+    int          i     = 0;
+
+    for ( ; i + 4 <= iNumSamples; i += 4 )
+    {
+        const __m128i vSrc   = _mm_loadl_epi64 ( reinterpret_cast<const __m128i*> ( &psSrc[i] ) );
+        const __m128  vValue = _mm_mul_ps ( _mm_cvtepi32_ps ( _mm_srai_epi32 ( _mm_unpacklo_epi16 ( vSrc, vSrc ), 16 ) ), vGain );
+
+        // duplicate each value for the left and right channel
+        _mm_storeu_ps ( &pfAcc[2 * i],     _mm_add_ps ( _mm_loadu_ps ( &pfAcc[2 * i] ),     _mm_unpacklo_ps ( vValue, vValue ) ) );
+        _mm_storeu_ps ( &pfAcc[2 * i + 4], _mm_add_ps ( _mm_loadu_ps ( &pfAcc[2 * i + 4] ), _mm_unpackhi_ps ( vValue, vValue ) ) );
+    }
+
+    AddMonoToStereoGeneric ( &pfAcc[2 * i], &psSrc[i], fGain, iNumSamples - i );
+}
+
+static void ToShortSSE2 ( int16_t*     psOut,
+                          const float* pfAcc,
+                          const int    iNumSamples )
+{
+    const __m128 vMin = _mm_set1_ps ( -32768.0f );
+    const __m128 vMax = _mm_set1_ps ( 32767.0f );
+    int          i    = 0;
+
+    for ( ; i + 8 <= iNumSamples; i += 8 )
+    {
+        // clip before the conversion since out of range values would give the
+        // "integer indefinite" value
+        const __m128i vLo = _mm_cvttps_epi32 ( _mm_min_ps ( _mm_max_ps ( _mm_loadu_ps ( &pfAcc[i] ),     vMin ), vMax ) );
+        const __m128i vHi = _mm_cvttps_epi32 ( _mm_min_ps ( _mm_max_ps ( _mm_loadu_ps ( &pfAcc[i + 4] ), vMin ), vMax ) );
+
+        _mm_storeu_si128 ( reinterpret_cast<__m128i*> ( &psOut[i] ), _mm_packs_epi32 ( vLo, vHi ) );
+    }
+
+    ToShortGeneric ( &psOut[i], &pfAcc[i], iNumSamples - i );
+}
+
+// the maximum of the 16 bit values is moved to the lowest element, the shifts
+// keep the even/odd order of the elements (left/right of stereo signals)
+static inline __m128i HorizontalPeakEpi16SSE2 ( __m128i vPeak,
+                                                const bool bStereo )
+{
+    vPeak = _mm_max_epi16 ( vPeak, _mm_srli_si128 ( vPeak, 8 ) );
+    vPeak = _mm_max_epi16 ( vPeak, _mm_srli_si128 ( vPeak, 4 ) );
+
+    if ( !bStereo )
+    {
+        vPeak = _mm_max_epi16 ( vPeak, _mm_srli_si128 ( vPeak, 2 ) );
+    }
+
+    return vPeak;
+}
+
+// SSE2 has no 32 bit abs and max instructions
+static inline __m128i AbsEpi32SSE2 ( const __m128i vValue )
+{
+    const __m128i vSign = _mm_srai_epi32 ( vValue, 31 );
+
+    return _mm_sub_epi32 ( _mm_xor_si128 ( vValue, vSign ), vSign );
+}
+
+static inline __m128i MaxEpi32SSE2 ( const __m128i vA,
+                                     const __m128i vB )
+{
+    const __m128i vMask = _mm_cmpgt_epi32 ( vA, vB );
+
+    return _mm_or_si128 ( _mm_and_si128 ( vMask, vA ), _mm_andnot_si128 ( vMask, vB ) );
+}
+
+static int PeakMonoSSE2 ( const int16_t* psSrc,
+                          const int      iNumSamples )
+{
+    const __m128i vZero = _mm_setzero_si128();
+    __m128i       vPeak = vZero;
+    int           i     = 0;
+
+    for ( ; i + 8 <= iNumSamples; i += 8 )
+    {
+        // the saturating negation maps -32768 to 32767
+        const __m128i vSrc = _mm_loadu_si128 ( reinterpret_cast<const __m128i*> ( &psSrc[i] ) );
+
+        vPeak = _mm_max_epi16 ( vPeak, _mm_max_epi16 ( vSrc, _mm_subs_epi16 ( vZero, vSrc ) ) );
+    }
+
+    const int iPeak = static_cast<int16_t> ( _mm_cvtsi128_si32 ( HorizontalPeakEpi16SSE2 ( vPeak, false ) ) );
+
+    return std::max ( iPeak, PeakMonoGeneric ( &psSrc[i], iNumSamples - i ) );
+}
+
+static int PeakStereoToMonoSSE2 ( const int16_t* psSrc,
+                                  const int      iNumSamples )
+{
+    const __m128i vOnes = _mm_set1_epi16 ( 1 );
+    __m128i       vPeak = _mm_setzero_si128();
+    int           i     = 0;
+
+    for ( ; i + 4 <= iNumSamples; i += 4 )
+    {
+        // the multiply-add with ones gives the 32 bit sums of left and right
+        const __m128i vSrc = _mm_loadu_si128 ( reinterpret_cast<const __m128i*> ( &psSrc[2 * i] ) );
+
+        vPeak = MaxEpi32SSE2 ( vPeak, AbsEpi32SSE2 ( _mm_madd_epi16 ( vSrc, vOnes ) ) );
+    }
+
+    vPeak = MaxEpi32SSE2 ( vPeak, _mm_srli_si128 ( vPeak, 8 ) );
+    vPeak = MaxEpi32SSE2 ( vPeak, _mm_srli_si128 ( vPeak, 4 ) );
+
+    return std::max ( _mm_cvtsi128_si32 ( vPeak ), PeakStereoToMonoGeneric ( &psSrc[2 * i], iNumSamples - i ) );
+}
+
+static void PeakStereoSSE2 ( const int16_t* psSrc,
+                             const int      iNumSamples,
+                             int&           iPeakLeft,
+                             int&           iPeakRight )
+{
+    const __m128i vZero = _mm_setzero_si128();
+    __m128i       vPeak = vZero;
+    int           i     = 0;
+
+    for ( ; i + 4 <= iNumSamples; i += 4 )
+    {
+        const __m128i vSrc = _mm_loadu_si128 ( reinterpret_cast<const __m128i*> ( &psSrc[2 * i] ) );
+
+        vPeak = _mm_max_epi16 ( vPeak, _mm_max_epi16 ( vSrc, _mm_subs_epi16 ( vZero, vSrc ) ) );
+    }
+
+    // the lowest two elements hold the left and right peak
+    const int iPeaks = _mm_cvtsi128_si32 ( HorizontalPeakEpi16SSE2 ( vPeak, true ) );
+
+    PeakStereoGeneric ( &psSrc[2 * i], iNumSamples - i, iPeakLeft, iPeakRight );
+
+    iPeakLeft  = std::max ( iPeakLeft,  static_cast<int> ( static_cast<int16_t> ( iPeaks & 0xFFFF ) ) );
+    iPeakRight = std::max ( iPeakRight, static_cast<int> ( static_cast<int16_t> ( ( iPeaks >> 16 ) & 0xFFFF ) ) );
+}
+#endif
+
+
+// AVX2 kernels ----------------------------------------------------------------
+#ifdef USE_AVX2_MIX_KERNEL
+AVX2_TARGET static void AddMonoAVX2 ( float*         pfAcc,
+                                      const int16_t* psSrc,
+                                      const float    fGain,
+                                      const int      iNumSamples )
+{
+    const __m256 vGain = _mm256_set1_ps ( fGain );
+    int          i     = 0;
+
+    for ( ; i + 8 <= iNumSamples; i += 8 )
+    {
+        const __m256 vSrc = _mm256_cvtepi32_ps ( _mm256_cvtepi16_epi32 (
+            _mm_loadu_si128 ( reinterpret_cast<const __m128i*> ( &psSrc[i] ) ) ) );
+
+        _mm256_storeu_ps ( &pfAcc[i], _mm256_add_ps ( _mm256_loadu_ps ( &pfAcc[i] ), _mm256_mul_ps ( vSrc, vGain ) ) );
+    }
+
+    AddMonoGeneric ( &pfAcc[i], &psSrc[i], fGain, iNumSamples - i );
+}
+
+AVX2_TARGET static void AddStereoToMonoAVX2 ( float*         pfAcc,
+                                              const int16_t* psSrc,
+                                              const float    fGain,
+                                              const int      iNumSamples )
+{
+    const __m256  vHalfGain = _mm256_set1_ps ( fGain * 0.5f );
+    const __m256i vOnes     = _mm256_set1_epi16 ( 1 );
+    int           i         = 0;
+
+    for ( ; i + 8 <= iNumSamples; i += 8 )
+    {
+        // the multiply-add works on adjacent pairs, i.e., the order is kept
+        const __m256i vSrc = _mm256_loadu_si256 ( reinterpret_cast<const __m256i*> ( &psSrc[2 * i] ) );
+        const __m256  vSum = _mm256_cvtepi32_ps ( _mm256_madd_epi16 ( vSrc, vOnes ) );
+
+        _mm256_storeu_ps ( &pfAcc[i], _mm256_add_ps ( _mm256_loadu_ps ( &pfAcc[i] ), _mm256_mul_ps ( vSum, vHalfGain ) ) );
+    }
+
+    AddStereoToMonoGeneric ( &pfAcc[i], &psSrc[2 * i], fGain, iNumSamples - i );
+}
+
+AVX2_TARGET static void AddMonoToStereoAVX2 ( float*         pfAcc,
+                                              const int16_t* psSrc,
+                                              const float    fGain,
+                                              const int      iNumSamples )
+{
+    const __m256 vGain = _mm256_set1_ps ( fGain );
+    int          i     = 0;
+
+    for ( ; i + 8 <= iNumSamples; i += 8 )
+    {
+        const __m256 vValue = _mm256_mul_ps ( _mm256_cvtepi32_ps ( _mm256_cvtepi16_epi32 (
+            _mm_loadu_si128 ( reinterpret_cast<const __m128i*> ( &psSrc[i] ) ) ) ), vGain );
+
+        // the unpack works per 128 bit lane, the permute restores the order
+        const __m256 vLo = _mm256_unpacklo_ps ( vValue, vValue );
+        const __m256 vHi = _mm256_unpackhi_ps ( vValue, vValue );
+
+        _mm256_storeu_ps ( &pfAcc[2 * i],     _mm256_add_ps ( _mm256_loadu_ps ( &pfAcc[2 * i] ),     _mm256_permute2f128_ps ( vLo, vHi, 0x20 ) ) );
+        _mm256_storeu_ps ( &pfAcc[2 * i + 8], _mm256_add_ps ( _mm256_loadu_ps ( &pfAcc[2 * i + 8] ), _mm256_permute2f128_ps ( vLo, vHi, 0x31 ) ) );
+    }
+
+    AddMonoToStereoGeneric ( &pfAcc[2 * i], &psSrc[i], fGain, iNumSamples - i );
+}
+
+AVX2_TARGET static void ToShortAVX2 ( int16_t*     psOut,
+                                      const float* pfAcc,
+                                      const int    iNumSamples )
+{
+    const __m256 vMin = _mm256_set1_ps ( -32768.0f );
+    const __m256 vMax = _mm256_set1_ps ( 32767.0f );
+    int          i    = 0;
+
+    for ( ; i + 16 <= iNumSamples; i += 16 )
+    {
+        const __m256i vLo = _mm256_cvttps_epi32 ( _mm256_min_ps ( _mm256_max_ps ( _mm256_loadu_ps ( &pfAcc[i] ),     vMin ), vMax ) );
+        const __m256i vHi = _mm256_cvttps_epi32 ( _mm256_min_ps ( _mm256_max_ps ( _mm256_loadu_ps ( &pfAcc[i + 8] ), vMin ), vMax ) );
+
+        // the pack works per 128 bit lane, the permute restores the order
+        _mm256_storeu_si256 ( reinterpret_cast<__m256i*> ( &psOut[i] ),
+                              _mm256_permute4x64_epi64 ( _mm256_packs_epi32 ( vLo, vHi ), 0xD8 ) );
+    }
+
+    ToShortGeneric ( &psOut[i], &pfAcc[i], iNumSamples - i );
+}
+
+AVX2_TARGET static int PeakMonoAVX2 ( const int16_t* psSrc,
+                                      const int      iNumSamples )
+{
+    const __m256i vZero = _mm256_setzero_si256();
+    __m256i       vPeak = vZero;
+    int           i     = 0;
+
+    for ( ; i + 16 <= iNumSamples; i += 16 )
+    {
+        // the saturating negation maps -32768 to 32767
+        const __m256i vSrc = _mm256_loadu_si256 ( reinterpret_cast<const __m256i*> ( &psSrc[i] ) );
+
+        vPeak = _mm256_max_epi16 ( vPeak, _mm256_max_epi16 ( vSrc, _mm256_subs_epi16 ( vZero, vSrc ) ) );
+    }
+
+    // combine the two 128 bit lanes, the rest is done with SSE2
+    const __m128i vHalf = _mm_max_epi16 ( _mm256_castsi256_si128 ( vPeak ), _mm256_extracti128_si256 ( vPeak, 1 ) );
+    const int     iPeak = static_cast<int16_t> ( _mm_cvtsi128_si32 ( HorizontalPeakEpi16SSE2 ( vHalf, false ) ) );
+
+    return std::max ( iPeak, PeakMonoGeneric ( &psSrc[i], iNumSamples - i ) );
+}
+
+AVX2_TARGET static int PeakStereoToMonoAVX2 ( const int16_t* psSrc,
+                                              const int      iNumSamples )
+{
+    const __m256i vOnes = _mm256_set1_epi16 ( 1 );
+    __m256i       vPeak = _mm256_setzero_si256();
+    int           i     = 0;
+
+    for ( ; i + 8 <= iNumSamples; i += 8 )
+    {
+        const __m256i vSrc = _mm256_loadu_si256 ( reinterpret_cast<const __m256i*> ( &psSrc[2 * i] ) );
+
+        vPeak = _mm256_max_epi32 ( vPeak, _mm256_abs_epi32 ( _mm256_madd_epi16 ( vSrc, vOnes ) ) );
+    }
+
+    __m128i vHalf = MaxEpi32SSE2 ( _mm256_castsi256_si128 ( vPeak ), _mm256_extracti128_si256 ( vPeak, 1 ) );
+    vHalf         = MaxEpi32SSE2 ( vHalf, _mm_srli_si128 ( vHalf, 8 ) );
+    vHalf         = MaxEpi32SSE2 ( vHalf, _mm_srli_si128 ( vHalf, 4 ) );
+
+    return std::max ( _mm_cvtsi128_si32 ( vHalf ), PeakStereoToMonoGeneric ( &psSrc[2 * i], iNumSamples - i ) );
+}
+
+AVX2_TARGET static void PeakStereoAVX2 ( const int16_t* psSrc,
+                                         const int      iNumSamples,
+                                         int&           iPeakLeft,
+                                         int&           iPeakRight )
+{
+    const __m256i vZero = _mm256_setzero_si256();
+    __m256i       vPeak = vZero;
+    int           i     = 0;
+
+    for ( ; i + 8 <= iNumSamples; i += 8 )
+    {
+        const __m256i vSrc = _mm256_loadu_si256 ( reinterpret_cast<const __m256i*> ( &psSrc[2 * i] ) );
+
+        vPeak = _mm256_max_epi16 ( vPeak, _mm256_max_epi16 ( vSrc, _mm256_subs_epi16 ( vZero, vSrc ) ) );
+    }
+
+    const __m128i vHalf  = _mm_max_epi16 ( _mm256_castsi256_si128 ( vPeak ), _mm256_extracti128_si256 ( vPeak, 1 ) );
+    const int     iPeaks = _mm_cvtsi128_si32 ( HorizontalPeakEpi16SSE2 ( vHalf, true ) );
+
+    PeakStereoGeneric ( &psSrc[2 * i], iNumSamples - i, iPeakLeft, iPeakRight );
+
+    iPeakLeft  = std::max ( iPeakLeft,  static_cast<int> ( static_cast<int16_t> ( iPeaks & 0xFFFF ) ) );
+    iPeakRight = std::max ( iPeakRight, static_cast<int> ( static_cast<int16_t> ( ( iPeaks >> 16 ) & 0xFFFF ) ) );
+}
+#endif
+
+
+// Kernel selection ------------------------------------------------------------
+CMixKernels::CMixKernels()
+{
+    SetKernelType ( GetBestKernelType() );
+}
+
+CMixKernels::EKernelType CMixKernels::GetBestKernelType()
+{
+    if ( IsKernelTypeSupported ( KT_AVX2 ) )
+    {
+        return KT_AVX2;
+    }
+    else if ( IsKernelTypeSupported ( KT_SSE2 ) )
+    {
+        return KT_SSE2;
+    }
+
+    return KT_GENERIC;
+}
+
+const char* CMixKernels::GetKernelTypeName ( const EKernelType eType )
+{
+    switch ( eType )
+    {
+    case KT_SSE2:
+        return "sse2";
+
+    case KT_AVX2:
+        return "avx2";
+
+    default:
+        return "generic";
+    }
+}
+
+bool CMixKernels::GetKernelTypeFromName ( const char*  strName,
+                                          EKernelType& eType )
+{
+    for ( int i = KT_GENERIC; i <= KT_AVX2; i++ )
+    {
+        if ( strcmp ( strName, GetKernelTypeName ( static_cast<EKernelType> ( i ) ) ) == 0 )
+        {
+            eType = static_cast<EKernelType> ( i );
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool CMixKernels::IsKernelTypeSupported ( const EKernelType eType )
+{
+    switch ( eType )
+    {
+    case KT_SSE2:
+#ifdef USE_SSE2_MIX_KERNEL
+        return true;
+#else
+        return false;
+#endif
+
+    case KT_AVX2:
+#ifdef USE_AVX2_MIX_KERNEL
+        __builtin_cpu_init();
+        return __builtin_cpu_supports ( "avx2" );
+#else
+        return false;
+#endif
+
+    default:
+        return true;
+    }
+}
+
+void CMixKernels::SetKernelType ( const EKernelType eNType )
+{
+    // fall back to the generic kernels if the requested type is not supported
+    eKernelType       = IsKernelTypeSupported ( eNType ) ? eNType : KT_GENERIC;
+    pAddMono          = AddMonoGeneric;
+    pAddStereoToMono  = AddStereoToMonoGeneric;
+    pAddMonoToStereo  = AddMonoToStereoGeneric;
+    pToShort          = ToShortGeneric;
+    pPeakMono         = PeakMonoGeneric;
+    pPeakStereoToMono = PeakStereoToMonoGeneric;
+    pPeakStereo       = PeakStereoGeneric;
+
+#ifdef USE_SSE2_MIX_KERNEL
+    if ( eKernelType == KT_SSE2 )
+    {
+        pAddMono          = AddMonoSSE2;
+        pAddStereoToMono  = AddStereoToMonoSSE2;
+        pAddMonoToStereo  = AddMonoToStereoSSE2;
+        pToShort          = ToShortSSE2;
+        pPeakMono         = PeakMonoSSE2;
+        pPeakStereoToMono = PeakStereoToMonoSSE2;
+        pPeakStereo       = PeakStereoSSE2;
+    }
+#endif
+
+#ifdef USE_AVX2_MIX_KERNEL
+    if ( eKernelType == KT_AVX2 )
+    {
+        pAddMono          = AddMonoAVX2;
+        pAddStereoToMono  = AddStereoToMonoAVX2;
+        pAddMonoToStereo  = AddMonoToStereoAVX2;
+        pToShort          = ToShortAVX2;
+        pPeakMono         = PeakMonoAVX2;
+        pPeakStereoToMono = PeakStereoToMonoAVX2;
+        pPeakStereo       = PeakStereoAVX2;
+    }
+#endif
+}
@@ -0,0 +1,129 @@
+/******************************************************************************\
+ * Copyright (c) 2020
+ *
+ * Author(s):
+ *  Volker Fischer
+ *
+ ******************************************************************************
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+\******************************************************************************/
+
+#pragma once
+
+#include <stdint.h>
+
+
+/* Definitions ****************************************************************/
+// SSE2 is available on all x86 64 bit CPUs, AVX2 is selected at runtime (we
+// need the GCC/Clang target attribute and CPU detection for that)
+#if defined ( __SSE2__ ) || defined ( _M_X64 ) || ( defined ( _M_IX86_FP ) && ( _M_IX86_FP >= 2 ) )
+# define USE_SSE2_MIX_KERNEL
+#endif
+
+#if defined ( USE_SSE2_MIX_KERNEL ) && ( defined ( __GNUC__ ) || defined ( __clang__ ) )
+# define USE_AVX2_MIX_KERNEL
+#endif
+
+
+/* Classes ********************************************************************/
+// Vectorized kernels for mixing 16 bit audio samples with float accumulators.
+// The mix is accumulated in a float buffer and converted to 16 bit with
+// saturation at the very end. The peak kernels are used for the level meters
+// of the server and the client.
+class CMixKernels
+{
+public:
+    enum EKernelType
+    {
+        KT_GENERIC, // plain C++ (may be auto-vectorized by the compiler)
+        KT_SSE2,
+        KT_AVX2
+    };
+
+    CMixKernels(); // selects the best kernel type supported by the CPU
+
+    static bool        IsKernelTypeSupported ( const EKernelType eType );
+    static EKernelType GetBestKernelType();
+
+    // the names are used for the command line argument and the benchmark
+    static const char* GetKernelTypeName ( const EKernelType eType );
+    static bool        GetKernelTypeFromName ( const char*  strName,
+                                               EKernelType& eType );
+
+    void        SetKernelType ( const EKernelType eNType );
+    EKernelType GetKernelType() const { return eKernelType; }
+
+    // pfAcc[i] += fGain * psSrc[i]
+    void AddMono ( float*         pfAcc,
+                   const int16_t* psSrc,
+                   const float    fGain,
+                   const int      iNumSamples ) const
+        { pAddMono ( pfAcc, psSrc, fGain, iNumSamples ); }
+
+    // pfAcc[i] += fGain * ( psSrc[2 * i] + psSrc[2 * i + 1] ) / 2
+    void AddStereoToMono ( float*         pfAcc,
+                           const int16_t* psSrc,
+                           const float    fGain,
+                           const int      iNumSamples ) const
+        { pAddStereoToMono ( pfAcc, psSrc, fGain, iNumSamples ); }
+
+    // pfAcc[2 * i] += fGain * psSrc[i], pfAcc[2 * i + 1] += fGain * psSrc[i]
+    void AddMonoToStereo ( float*         pfAcc,
+                           const int16_t* psSrc,
+                           const float    fGain,
+                           const int      iNumSamples ) const
+        { pAddMonoToStereo ( pfAcc, psSrc, fGain, iNumSamples ); }
+
+    // psOut[i] = saturate ( pfAcc[i] ) (truncation towards zero)
+    void ToShort ( int16_t*     psOut,
+                   const float* pfAcc,
+                   const int    iNumSamples ) const
+        { pToShort ( psOut, pfAcc, iNumSamples ); }
+
+    // max ( abs ( psSrc[i] ) ), the result is limited to 32767
+    int PeakMono ( const int16_t* psSrc,
+                   const int      iNumSamples ) const
+        { return pPeakMono ( psSrc, iNumSamples ); }
+
+    // max ( abs ( psSrc[2 * i] + psSrc[2 * i + 1] ) ), i.e., twice the peak of
+    // the mono down mix (range 0..65536)
+    int PeakStereoToMono ( const int16_t* psSrc,
+                           const int      iNumSamples ) const
+        { return pPeakStereoToMono ( psSrc, iNumSamples ); }
+
+    // peaks of the left and right channel, the results are limited to 32767
+    void PeakStereo ( const int16_t* psSrc,
+                      const int      iNumSamples,
+                      int&           iPeakLeft,
+                      int&           iPeakRight ) const
+        { pPeakStereo ( psSrc, iNumSamples, iPeakLeft, iPeakRight ); }
+
+protected:
+    typedef void ( *TAddFunc ) ( float*, const int16_t*, const float, const int );
+    typedef void ( *TToShortFunc ) ( int16_t*, const float*, const int );
+    typedef int  ( *TPeakFunc ) ( const int16_t*, const int );
+    typedef void ( *TPeakStereoFunc ) ( const int16_t*, const int, int&, int& );
+
+    EKernelType     eKernelType;
+    TAddFunc        pAddMono;
+    TAddFunc        pAddStereoToMono;
+    TAddFunc        pAddMonoToStereo;
+    TToShortFunc    pToShort;
+    TPeakFunc       pPeakMono;
+    TPeakFunc       pPeakStereoToMono;
+    TPeakStereoFunc pPeakStereo;
+};
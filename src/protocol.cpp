@@ -45,6 +45,35 @@ MESSAGES (with connection)
     note: the cnt value is the same as of the message to be acknowledged
 
 
+- PROTMESSID_ACKN_LIST: Acknowledgement of several messages
+
+    for each message to be acknowledged append following data:
+
+    +---------------------------------+---------------------------+
+    | 2 bytes ID of message to be ack | 1 byte cnt of the message |
+    +---------------------------------+---------------------------+
+
+    note: the cnt value of the frame is not used and set to 0; this message is
+          only sent to peers which sent PROTMESSID_RECV_WINDOW_SIZE
+
+
+- PROTMESSID_RECV_WINDOW_SIZE: Receive window size
+
+    +--------------------+--------------+
+    | 1 byte window size | 1 byte flags |
+    +--------------------+--------------+
+
+    - "window size": number of messages the other side may send without
+                     waiting for the acknowledgements (at least 1), the
+                     messages may then be received in any order
+    - "flags":       bit 0: the other side shall answer with its window size
+
+    note: this is the first message which is sent after a reset of the
+          protocol, it starts a new session, i.e., the receiver forgets which
+          messages were received before; old versions ignore the message and
+          therefore only get one message at a time
+
+
 - PROTMESSID_JITT_BUF_SIZE: Jitter buffer size
 
     +--------------------------+
@@ -162,6 +191,81 @@ MESSAGES (with connection)
     option is boolean, true to opt in, false to opt out
 
 
+- PROTMESSID_REQ_CLIENTS_LIST_DELTAS: Opt in or out of the connected clients
+                                      list deltas
+
+    +---------------+
+    | 1 byte option |
+    +---------------+
+
+    option is boolean, true to opt in, false to opt out; after opting in, the
+    server sends PROTMESSID_CONN_CLIENTS_LIST_DELTA instead of
+    PROTMESSID_CONN_CLIENTS_LIST
+
+
+- PROTMESSID_CONN_CLIENTS_LIST_DELTA: Changes of the connected clients list
+
+    +-----------------+----------------------+--------------+ ...
+    | 4 bytes version | 4 bytes base version | 1 byte reset | ...
+    +-----------------+----------------------+--------------+ ...
+        ... ----------------+-----------------------------+ ...
+        ...  1 byte number n | n bytes removed channel IDs | ...
+        ... ----------------+-----------------------------+ ...
+
+    then, for each added or changed client, append the data of one client as
+    in PROTMESSID_CONN_CLIENTS_LIST
+
+    - "version":      version of the list after applying the changes
+    - "base version": version of the list the changes are based on
+    - "reset":        boolean, if true the list is cleared before the changes
+                      are applied (and "base version" is ignored)
+
+    if the list of the receiver does not have the base version, it shall
+    request the complete list with PROTMESSID_REQ_CONN_CLIENTS_LIST which is
+    answered with a reset delta
+
+
+- PROTMESSID_REQ_CHANNEL_LEVEL_SUBSCR: Subscribe to the channel level deltas
+
+    +-------------+---------------+---------------------+
+    | 1 byte mode | 1 byte number | n bytes channel IDs |
+    +-------------+---------------+---------------------+
+
+    - "mode": 0: all channels (n is 0), 1: only the given channels
+
+    after subscribing, the server sends PROTMESSID_CLM_CHANNEL_LEVEL_DELTA
+    instead of PROTMESSID_CLM_CHANNEL_LEVEL_LIST (the client must still opt in
+    with PROTMESSID_CLM_REQ_CHANNEL_LEVEL_LIST)
+
+
+- PROTMESSID_AUDIO_PACKET_EXT: Audio packet extension supported
+
+    +------------------+--------------+
+    | 1 byte supported | 1 byte flags |
+    +------------------+--------------+
+
+    - "supported": boolean, true if the sender of the message accepts audio
+                   packets with the extension
+    - "flags":     bit 0: the other side shall answer with its support
+
+    each side only appends the extension to its audio packets after the other
+    side has announced its support (old versions ignore the message), the
+    extension is appended to the coded audio data of an audio packet:
+
+    +---------------------------+------------------------------+
+    | 2 bytes sequence number   | 4 bytes sender time in us    |
+    +---------------------------+------------------------------+
+
+    - "sequence number": incremented by one for each audio packet (wraps
+                         around), the receiver uses it to put reordered
+                         packets in the jitter buffer in the correct order
+    - "sender time":     time when the packet was sent in microseconds
+                         (arbitrary start, wraps around)
+
+    note: the receiver distinguishes audio packets with and without the
+          extension by their size
+
+
 // #### COMPATIBILITY OLD VERSION, TO BE REMOVED ####
 - PROTMESSID_OPUS_SUPPORTED: Informs that OPUS codec is supported
 
@@ -331,6 +435,27 @@ CONNECTION LESS MESSAGES
           (standard re-registration timeout).
 
 
+- PROTMESSID_CLM_CHANNEL_LEVEL_DELTA: Changed channel levels
+
+    +---------------------------+--------------+---------------+ ...
+    | 1 byte sequence number    | 1 byte flags | 1 byte number | ...
+    +---------------------------+--------------+---------------+ ...
+        ... ---------------------+----------------------------------+
+        ...  n bytes channel IDs | ( ( n + 1 ) / 2 ) * 4 bit values |
+        ... ---------------------+----------------------------------+
+
+    - "sequence number": incremented with each message, the receiver ignores
+                         messages which are older than the last one
+    - "flags":           bit 0: the message is complete, i.e., the levels of
+                         all channels which are not given are zero
+
+    the levels are coded like in PROTMESSID_CLM_CHANNEL_LEVEL_LIST; only the
+    levels of the subscribed channels (see
+    PROTMESSID_REQ_CHANNEL_LEVEL_SUBSCR) which changed since the last message
+    are given, a complete message is sent from time to time since messages
+    may get lost
+
+
  ******************************************************************************
  *
  * This program is free software; you can redistribute it and/or modify it under
@@ -352,15 +477,144 @@ CONNECTION LESS MESSAGES
 #include "protocol.h"
 
 
+/* Message body buffer pool ***************************************************/
+class CMesBodyBufPool
+{
+public:
+    CMesBodyBufPool()
+    {
+        // allocate all buffers with the maximum message size and make sure
+        // that returning a buffer to the pool never allocates memory
+        vecpFreeSlots.reserve ( NUM_MES_BODY_BUF_POOL_SLOTS );
+
+        for ( int i = 0; i < NUM_MES_BODY_BUF_POOL_SLOTS; i++ )
+        {
+            CMesBodyBuf::CSlot* pSlot = new CMesBodyBuf::CSlot;
+
+            pSlot->vecbyData.reserve ( MAX_SIZE_BYTES_NETW_BUF );
+            pSlot->bIsPooled = true;
+
+            vecpFreeSlots.push_back ( pSlot );
+        }
+    }
+
+    static CMesBodyBufPool& Instance()
+    {
+        static CMesBodyBufPool Pool;
+        return Pool;
+    }
+
+    CMesBodyBuf::CSlot* Get()
+    {
+        QMutexLocker locker ( &Mutex );
+
+        if ( vecpFreeSlots.empty() )
+        {
+            return nullptr;
+        }
+
+        CMesBodyBuf::CSlot* pSlot = vecpFreeSlots.back();
+        vecpFreeSlots.pop_back();
+
+        return pSlot;
+    }
+
+    void Put ( CMesBodyBuf::CSlot* pSlot )
+    {
+        QMutexLocker locker ( &Mutex );
+
+        vecpFreeSlots.push_back ( pSlot );
+    }
+
+protected:
+    std::vector<CMesBodyBuf::CSlot*> vecpFreeSlots;
+    QMutex                           Mutex;
+};
+
+
+/* Message body buffer implementation *****************************************/
+CMesBodyBuf& CMesBodyBuf::operator= ( const CMesBodyBuf& Other )
+{
+    if ( pSlot != Other.pSlot )
+    {
+        Release();
+        pSlot = Other.pSlot;
+        AddRef();
+    }
+
+    return *this;
+}
+
+void CMesBodyBuf::Init ( const int iNewSize )
+{
+    // the data of a shared buffer must not be modified, get a new one
+    Release();
+
+    if ( iNewSize <= MAX_SIZE_BYTES_NETW_BUF )
+    {
+        pSlot = CMesBodyBufPool::Instance().Get();
+    }
+
+    if ( pSlot == nullptr )
+    {
+        // the pool is exhausted, fall back to a heap allocated buffer
+        pSlot            = new CSlot;
+        pSlot->bIsPooled = false;
+    }
+
+    pSlot->iRefCnt.storeRelease ( 1 );
+
+    // note that this does not allocate memory for pooled buffers since their
+    // capacity is already the maximum message size
+    pSlot->vecbyData.Init ( iNewSize );
+}
+
+const CVector<uint8_t>& CMesBodyBuf::GetData() const
+{
+    static const CVector<uint8_t> vecbyEmpty;
+
+    return ( pSlot != nullptr ) ? pSlot->vecbyData : vecbyEmpty;
+}
+
+void CMesBodyBuf::Release()
+{
+    if ( ( pSlot != nullptr ) && !pSlot->iRefCnt.deref() )
+    {
+        if ( pSlot->bIsPooled )
+        {
+            CMesBodyBufPool::Instance().Put ( pSlot );
+        }
+        else
+        {
+            delete pSlot;
+        }
+    }
+
+    pSlot = nullptr;
+}
+
+
 /* Implementation *************************************************************/
-CProtocol::CProtocol()
+CProtocol::CProtocol() :
+    veciRecHistory      ( RECV_MESS_HISTORY_LEN, -1 ),
+    iRecHistoryIdx      ( 0 ),
+    veciPendingAcknIDs  ( 0 ),
+    veciPendingAcknCnts ( 0 )
 {
     Reset();
 
+    // the acknowledgements of the messages which are received in one go are
+    // sent together
+    TimerSendAckn.setSingleShot ( true );
+    TimerSendAckn.setInterval ( 0 );
+
 
     // Connections -------------------------------------------------------------
     QObject::connect ( &TimerSendMess, SIGNAL ( timeout() ),
         this, SLOT ( OnTimerSendMess() ) );
+
+    QObject::connect ( &TimerSendAckn, SIGNAL ( timeout() ),
+        this, SLOT ( OnTimerSendAckn() ) );
 }
 
 void CProtocol::Reset()
@@ -372,60 +626,170 @@ void CProtocol::Reset()
     iOldRecID  = PROTMESSID_ILLEGAL;
     iOldRecCnt = 0;
 
+    // the receive window is announced with the first message and until the
+    // other side announces its receive window, it is treated like an old
+    // version which only supports one message in flight
+    bRecvWindowAnnounced = false;
+    iPeerRecvWindowSize  = 1;
+    bPeerRecvWindowKnown = false;
+    veciRecHistory.Reset ( -1 );
+    veciPendingAcknIDs.Init ( 0 );
+    veciPendingAcknCnts.Init ( 0 );
+
     // delete complete "send message queue"
     SendMessQueue.clear();
 }
 
-void CProtocol::EnqueueMessage ( CVector<uint8_t>& vecMessage,
-                                 const int         iCnt,
-                                 const int         iID )
+int CProtocol::GetSendMessageKey ( const int               iID,
+                                   const CVector<uint8_t>& vecData )
+{
+    switch ( iID )
+    {
+    case PROTMESSID_CHANNEL_GAIN:
+        // the gains of the different channels are independent (the first
+        // byte of the message is the channel ID)
+        return ( iID << 8 ) | vecData[0];
+
+    case PROTMESSID_CONN_CLIENTS_LIST_DELTA:
+        // the deltas must not overtake a complete list
+        return PROTMESSID_CONN_CLIENTS_LIST << 8;
+
+    default:
+        return iID << 8;
+    }
+}
+
+bool CProtocol::IsCoalescableMessageID ( const int iID )
 {
-    bool bListWasEmpty;
+    switch ( iID )
+    {
+    case PROTMESSID_JITT_BUF_SIZE:
+    case PROTMESSID_REQ_JITT_BUF_SIZE:
+    case PROTMESSID_CHANNEL_GAIN:
+    case PROTMESSID_CONN_CLIENTS_LIST:
+    case PROTMESSID_REQ_CONN_CLIENTS_LIST:
+    case PROTMESSID_CHANNEL_INFOS:
+    case PROTMESSID_REQ_CHANNEL_INFOS:
+    case PROTMESSID_NETW_TRANSPORT_PROPS:
+    case PROTMESSID_REQ_NETW_TRANSPORT_PROPS:
+    case PROTMESSID_REQ_CHANNEL_LEVEL_LIST:
+    case PROTMESSID_REQ_CLIENTS_LIST_DELTAS:
+    case PROTMESSID_REQ_CHANNEL_LEVEL_SUBSCR:
+    case PROTMESSID_AUDIO_PACKET_EXT:
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+void CProtocol::EnqueueMessage ( const CVector<uint8_t>& vecData,
+                                 const int               iID )
+{
+    const int iKey = GetSendMessageKey ( iID, vecData );
 
     Mutex.lock();
     {
-        // check if list is empty so that we have to initiate a send process
-        bListWasEmpty = SendMessQueue.empty();
+        bool bCoalesced = false;
+
+        if ( IsCoalescableMessageID ( iID ) )
+        {
+            // if the last queued message with the same key is of the same type
+            // and was not yet sent, it is outdated and we replace its data
+            std::list<CSendMessage>::reverse_iterator it;
 
-        // create send message object for the queue
-        CSendMessage SendMessageObj ( vecMessage, iCnt, iID );
+            for ( it = SendMessQueue.rbegin(); it != SendMessQueue.rend(); ++it )
+            {
+                if ( it->iKey == iKey )
+                {
+                    if ( !it->bInFlight && ( it->iID == iID ) )
+                    {
+                        it->vecData = vecData;
+                        bCoalesced  = true;
+                    }
+                    break;
+                }
+            }
+        }
 
-        // we want to have a FIFO: we add at the end and take from the beginning
-        SendMessQueue.push_back ( SendMessageObj );
+        if ( !bCoalesced )
+        {
+            // we want to have a FIFO: we add at the end and take from the beginning
+            SendMessQueue.push_back ( CSendMessage ( vecData, iID, iKey ) );
+        }
     }
     Mutex.unlock();
 
-    // if list was empty, initiate send process
-    if ( bListWasEmpty )
-    {
-        SendMessage();
-    }
+    // send the message if the window allows it
+    SendMessage();
 }
 
-void CProtocol::SendMessage()
+void CProtocol::SendMessage ( const bool bResendInFlight )
 {
-    CVector<uint8_t> vecMessage;
-    bool             bSendMess = false;
+    std::vector<CVector<uint8_t> > vecvecMessages;
+    std::vector<int>               veciUsedKeys;
+    int                            iNumInFlight = 0;
 
     Mutex.lock();
     {
-        // we have to check that list is not empty, since in another thread the
-        // last element of the list might have been erased
-        if ( !SendMessQueue.empty() )
+        std::list<CSendMessage>::iterator it;
+
+        for ( it = SendMessQueue.begin(); it != SendMessQueue.end(); ++it )
+        {
+            if ( it->bInFlight )
+            {
+                iNumInFlight++;
+            }
+        }
+
+        // Go through the queue in FIFO order. A message is sent if the number
+        // of messages in flight is below the receive window of the other side
+        // and no earlier message with the same key is queued. Messages in
+        // flight are only sent again on the time-out.
+        for ( it = SendMessQueue.begin(); it != SendMessQueue.end(); ++it )
         {
-            vecMessage.Init ( SendMessQueue.front().vecMessage.Size() );
-            vecMessage = SendMessQueue.front().vecMessage;
+            const bool bKeyIsUsed = std::find ( veciUsedKeys.begin(),
+                                                veciUsedKeys.end(),
+                                                it->iKey ) != veciUsedKeys.end();
+
+            if ( it->bInFlight )
+            {
+                if ( bResendInFlight )
+                {
+                    vecvecMessages.push_back ( it->vecMessage );
+                }
+            }
+            else if ( !bKeyIsUsed && ( iNumInFlight < iPeerRecvWindowSize ) )
+            {
+                // the counter is assigned in the order the messages are sent
+                // (it wraps around automatically)
+                it->iCnt = iCounter;
+                iCounter++;
+
+                GenMessageFrame ( it->vecMessage, it->iCnt, it->iID, it->vecData );
+
+                it->bInFlight = true;
+                iNumInFlight++;
+
+                vecvecMessages.push_back ( it->vecMessage );
+            }
 
-            bSendMess = true;
+            if ( !bKeyIsUsed )
+            {
+                veciUsedKeys.push_back ( it->iKey );
+            }
         }
     }
     Mutex.unlock();
 
-    if ( bSendMess )
+    // send messages
+    for ( size_t i = 0; i < vecvecMessages.size(); i++ )
     {
-        // send message
-        emit MessReadyForSending ( vecMessage );
+        emit MessReadyForSending ( vecvecMessages[i] );
+    }
 
+    if ( iNumInFlight > 0 )
+    {
         // start time-out timer if not active
         if ( !TimerSendMess.isActive() )
         {
@@ -442,24 +806,133 @@ void CProtocol::SendMessage()
 void CProtocol::CreateAndSendMessage ( const int               iID,
                                        const CVector<uint8_t>& vecData )
 {
-    CVector<uint8_t> vecNewMessage;
-    int              iCurCounter;
+    bool bAnnounceRecvWindow;
 
     Mutex.lock();
     {
-        // store current counter value
-        iCurCounter = iCounter;
-
-        // increase counter (wraps around automatically)
-        iCounter++;
+        bAnnounceRecvWindow  = !bRecvWindowAnnounced;
+        bRecvWindowAnnounced = true;
     }
     Mutex.unlock();
 
-    // build complete message
-    GenMessageFrame ( vecNewMessage, iCurCounter, iID, vecData );
+    // the first message after a reset announces our receive window which
+    // starts a new session at the other side
+    if ( bAnnounceRecvWindow && ( iID != PROTMESSID_RECV_WINDOW_SIZE ) )
+    {
+        CreateRecvWindowSizeMes ( true );
+    }
+
+    // enqueue message (the complete message is generated when it is sent)
+    EnqueueMessage ( vecData, iID );
+}
+
+bool CProtocol::AcknowledgeSentMessage ( const int iID,
+                                         const int iCnt )
+{
+    QMutexLocker locker ( &Mutex );
+
+    std::list<CSendMessage>::iterator it;
+
+    for ( it = SendMessQueue.begin(); it != SendMessQueue.end(); ++it )
+    {
+        // check if this is the correct acknowledgment
+        if ( it->bInFlight && ( it->iCnt == iCnt ) && ( it->iID == iID ) )
+        {
+            // message acknowledged, remove from queue
+            SendMessQueue.erase ( it );
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool CProtocol::IsResentMessage ( const int iRecID,
+                                  const int iRecCounter ) const
+{
+    if ( bPeerRecvWindowKnown )
+    {
+        // several messages may be in flight, check all recently received
+        return std::find ( veciRecHistory.begin(),
+                           veciRecHistory.end(),
+                           ( iRecID << 8 ) | iRecCounter ) != veciRecHistory.end();
+    }
+
+    return ( iOldRecID == iRecID ) && ( iOldRecCnt == iRecCounter );
+}
+
+void CProtocol::StoreReceivedMessage ( const int iRecID,
+                                       const int iRecCounter )
+{
+    // save current message ID and counter to find out if message
+    // was resent
+    iOldRecID  = iRecID;
+    iOldRecCnt = iRecCounter;
+
+    if ( bPeerRecvWindowKnown )
+    {
+        veciRecHistory[iRecHistoryIdx] = ( iRecID << 8 ) | iRecCounter;
+        iRecHistoryIdx = ( iRecHistoryIdx + 1 ) % RECV_MESS_HISTORY_LEN;
+    }
+}
+
+void CProtocol::SendAcknMess ( const int iID,
+                               const int iCnt )
+{
+    // old versions do not know the acknowledge list message
+    if ( !bPeerRecvWindowKnown )
+    {
+        CreateAndImmSendAcknMess ( iID, iCnt );
+        return;
+    }
+
+    veciPendingAcknIDs.Add ( iID );
+    veciPendingAcknCnts.Add ( iCnt );
+
+    if ( veciPendingAcknIDs.Size() >= MAX_NUM_ACKN_IN_LIST )
+    {
+        OnTimerSendAckn();
+    }
+    else if ( !TimerSendAckn.isActive() )
+    {
+        TimerSendAckn.start();
+    }
+}
+
+void CProtocol::OnTimerSendAckn()
+{
+    const int iNumAckn = veciPendingAcknIDs.Size();
+
+    TimerSendAckn.stop();
+
+    if ( iNumAckn == 1 )
+    {
+        CreateAndImmSendAcknMess ( veciPendingAcknIDs[0], veciPendingAcknCnts[0] );
+    }
+    else if ( iNumAckn > 1 )
+    {
+        CVector<uint8_t> vecAcknListMessage;
+        CVector<uint8_t> vecData ( 3 * iNumAckn ); // 3 bytes per acknowledgement
+        int              iPos = 0; // init position pointer
+
+        for ( int i = 0; i < iNumAckn; i++ )
+        {
+            PutValOnStream ( vecData, iPos,
+                static_cast<uint32_t> ( veciPendingAcknIDs[i] ), 2 );
+
+            PutValOnStream ( vecData, iPos,
+                static_cast<uint32_t> ( veciPendingAcknCnts[i] ), 1 );
+        }
+
+        // build complete message (the counter is not used)
+        GenMessageFrame ( vecAcknListMessage, 0, PROTMESSID_ACKN_LIST, vecData );
+
+        // immediately send acknowledge list message
+        emit MessReadyForSending ( vecAcknListMessage );
+    }
 
-    // enqueue message
-    EnqueueMessage ( vecNewMessage, iCurCounter, iID );
+    veciPendingAcknIDs.Init ( 0 );
+    veciPendingAcknCnts.Init ( 0 );
 }
 
 void CProtocol::CreateAndImmSendAcknMess ( const int& iID,
@@ -501,7 +974,6 @@ bool CProtocol::ParseMessageBody ( const CVector<uint8_t>& vecbyMesBodyData,
     return code: false -> ok; true -> error
 */
     bool bRet = false;
-    bool bSendNextMess;
 
 /*
 // TEST channel implementation: randomly delete protocol messages (50 % loss)
@@ -510,15 +982,17 @@ if ( rand() < ( RAND_MAX / 2 ) ) return false;
 
     // In case we received a message and returned an answer but our answer
     // did not make it to the receiver, he will resend his message. We check
-    // here if the message is the same as the old one, and if this is the
-    // case, just resend our old answer again
-    if ( ( iOldRecID == iRecID ) && ( iOldRecCnt == iRecCounter ) )
+    // here if the message is the same as a previous one, and if this is the
+    // case, just resend our old answer again (the receive window message
+    // starts a new session of the other side and is always evaluated)
+    if ( ( iRecID != PROTMESSID_RECV_WINDOW_SIZE ) &&
+         IsResentMessage ( iRecID, iRecCounter ) )
     {
         // acknowledgments are not acknowledged
-        if ( iRecID != PROTMESSID_ACKN )
+        if ( ( iRecID != PROTMESSID_ACKN ) && ( iRecID != PROTMESSID_ACKN_LIST ) )
         {
             // resend acknowledgement
-            CreateAndImmSendAcknMess ( iRecID, iRecCounter );
+            SendAcknMess ( iRecID, iRecCounter );
         }
     }
     else
@@ -531,30 +1005,17 @@ if ( rand() < ( RAND_MAX / 2 ) ) return false;
             const int iData =
                 static_cast<int> ( GetValFromStream ( vecbyMesBodyData, iPos, 2 ) );
 
-            Mutex.lock();
-            {
-                // check if this is the correct acknowledgment
-                bSendNextMess = false;
-                if ( !SendMessQueue.empty() )
-                {
-                    if ( ( SendMessQueue.front().iCnt == iRecCounter ) &&
-                         ( SendMessQueue.front().iID == iData ) )
-                    {
-                        // message acknowledged, remove from queue
-                        SendMessQueue.pop_front();
-
-                        // send next message in queue
-                        bSendNextMess = true;
-                    }
-                }
-            }
-            Mutex.unlock();
-
-            if ( bSendNextMess )
+            // if the message was acknowledged, the next message in the queue
+            // may be sent
+            if ( AcknowledgeSentMessage ( iData, iRecCounter ) )
             {
                 SendMessage();
             }
         }
+        else if ( iRecID == PROTMESSID_ACKN_LIST )
+        {
+            bRet = EvaluateAcknListMes ( vecbyMesBodyData );
+        }
         else
         {
             // check which type of message we received and do action
@@ -607,15 +1068,33 @@ if ( rand() < ( RAND_MAX / 2 ) ) return false;
             case PROTMESSID_REQ_CHANNEL_LEVEL_LIST:
                 bRet = EvaluateReqChannelLevelListMes ( vecbyMesBodyData );
                 break;
+
+            case PROTMESSID_REQ_CLIENTS_LIST_DELTAS:
+                bRet = EvaluateReqConClientListDeltasMes ( vecbyMesBodyData );
+                break;
+
+            case PROTMESSID_CONN_CLIENTS_LIST_DELTA:
+                bRet = EvaluateConClientListDeltaMes ( vecbyMesBodyData );
+                break;
+
+            case PROTMESSID_RECV_WINDOW_SIZE:
+                bRet = EvaluateRecvWindowSizeMes ( vecbyMesBodyData );
+                break;
+
+            case PROTMESSID_REQ_CHANNEL_LEVEL_SUBSCR:
+                bRet = EvaluateReqChannelLevelSubscrMes ( vecbyMesBodyData );
+                break;
+
+            case PROTMESSID_AUDIO_PACKET_EXT:
+                bRet = EvaluateAudioPacketExtMes ( vecbyMesBodyData );
+                break;
             }
 
-            // immediately send acknowledge message
-            CreateAndImmSendAcknMess ( iRecID, iRecCounter );
+            // send acknowledge message
+            SendAcknMess ( iRecID, iRecCounter );
 
-            // save current message ID and counter to find out if message
-            // was resent
-            iOldRecID  = iRecID;
-            iOldRecCnt = iRecCounter;
+            // remember the message to find out if it is resent
+            StoreReceivedMessage ( iRecID, iRecCounter );
         }
     }
 
@@ -700,6 +1179,10 @@ if ( rand() < ( RAND_MAX / 2 ) ) return false;
         case PROTMESSID_CLM_REGISTER_SERVER_RESP:
             bRet = EvaluateCLRegisterServerResp ( InetAddr, vecbyMesBodyData );
             break;
+
+        case PROTMESSID_CLM_CHANNEL_LEVEL_DELTA:
+            bRet = EvaluateCLChannelLevelDeltaMes ( InetAddr, vecbyMesBodyData );
+            break;
         }
     }
     else
@@ -820,113 +1303,29 @@ void CProtocol::CreateConClientListMes ( const CVector<CChannelInfo>& vecChanInf
 
     for ( int i = 0; i < iNumClients; i++ )
     {
-        // convert strings to utf-8
-        const QByteArray strUTF8Name = vecChanInfo[i].strName.toUtf8();
-        const QByteArray strUTF8City = vecChanInfo[i].strCity.toUtf8();
+        PutChanInfoOnStream ( vecData, iPos, vecChanInfo[i] );
+    }
 
-        // size of current list entry
-        const int iCurListEntrLen =
-            1 /* chan ID */ + 2 /* country */ +
-            4 /* instrument */ + 1 /* skill level */ +
-            4 /* IP address */ +
-            2 /* utf-8 str. size */ + strUTF8Name.size() +
-            2 /* utf-8 str. size */ + strUTF8City.size();
+    CreateAndSendMessage ( PROTMESSID_CONN_CLIENTS_LIST, vecData );
+}
 
-        // make space for new data
-        vecData.Enlarge ( iCurListEntrLen );
+bool CProtocol::EvaluateConClientListMes ( const CVector<uint8_t>& vecData )
+{
+    int                   iPos     = 0; // init position pointer
+    const int             iDataLen = vecData.Size();
+    CVector<CChannelInfo> vecChanInfo ( 0 );
 
-        // channel ID (1 byte)
-        PutValOnStream ( vecData, iPos,
-            static_cast<uint32_t> ( vecChanInfo[i].iChanID ), 1 );
+    while ( iPos < iDataLen )
+    {
+        CChannelInfo CurChanInfo;
 
-        // country (2 bytes)
-        PutValOnStream ( vecData, iPos,
-            static_cast<uint32_t> ( vecChanInfo[i].eCountry ), 2 );
-
-        // instrument (4 bytes)
-        PutValOnStream ( vecData, iPos,
-            static_cast<uint32_t> ( vecChanInfo[i].iInstrument ), 4 );
-
-        // skill level (1 byte)
-        PutValOnStream ( vecData, iPos,
-            static_cast<uint32_t> ( vecChanInfo[i].eSkillLevel ), 1 );
-
-        // IP address (4 bytes)
-        PutValOnStream ( vecData, iPos,
-            static_cast<uint32_t> ( vecChanInfo[i].iIpAddr ), 4 );
-
-        // name
-        PutStringUTF8OnStream ( vecData, iPos, strUTF8Name );
-
-        // city
-        PutStringUTF8OnStream ( vecData, iPos, strUTF8City );
-    }
-
-    CreateAndSendMessage ( PROTMESSID_CONN_CLIENTS_LIST, vecData );
-}
-
-bool CProtocol::EvaluateConClientListMes ( const CVector<uint8_t>& vecData )
-{
-    int                   iPos     = 0; // init position pointer
-    const int             iDataLen = vecData.Size();
-    CVector<CChannelInfo> vecChanInfo ( 0 );
-
-    while ( iPos < iDataLen )
-    {
-        // check size (the next 12 bytes)
-        if ( ( iDataLen - iPos ) < 12 )
-        {
-            return true; // return error code
-        }
-
-        // channel ID (1 byte)
-        const int iChanID =
-            static_cast<int> ( GetValFromStream ( vecData, iPos, 1 ) );
-
-        // country (2 bytes)
-        const QLocale::Country eCountry =
-            static_cast<QLocale::Country> ( GetValFromStream ( vecData, iPos, 2 ) );
-
-        // instrument (4 bytes)
-        const int iInstrument =
-            static_cast<int> ( GetValFromStream ( vecData, iPos, 4 ) );
-
-        // skill level (1 byte)
-        const ESkillLevel eSkillLevel =
-            static_cast<ESkillLevel> ( GetValFromStream ( vecData, iPos, 1 ) );
-
-        // IP address (4 bytes)
-        const int iIpAddr =
-            static_cast<int> ( GetValFromStream ( vecData, iPos, 4 ) );
-
-        // name
-        QString strCurName;
-        if ( GetStringFromStream ( vecData,
-                                   iPos,
-                                   MAX_LEN_FADER_TAG,
-                                   strCurName ) )
-        {
-            return true; // return error code
-        }
-
-        // city
-        QString strCurCity;
-        if ( GetStringFromStream ( vecData,
-                                   iPos,
-                                   MAX_LEN_SERVER_CITY,
-                                   strCurCity ) )
+        if ( GetChanInfoFromStream ( vecData, iPos, CurChanInfo ) )
         {
             return true; // return error code
         }
 
         // add channel information to vector
-        vecChanInfo.Add ( CChannelInfo ( iChanID,
-                                         iIpAddr,
-                                         strCurName,
-                                         eCountry,
-                                         strCurCity,
-                                         iInstrument,
-                                         eSkillLevel ) );
+        vecChanInfo.Add ( CurChanInfo );
     }
 
     // check size: all data is read, the position must now be at the end
@@ -1243,93 +1642,457 @@ bool CProtocol::EvaluateNetwTranspPropsMes ( const CVector<uint8_t>& vecData )
     return false; // no error
 }
 
-void CProtocol::CreateReqNetwTranspPropsMes()
+void CProtocol::CreateReqNetwTranspPropsMes()
+{
+    CreateAndSendMessage ( PROTMESSID_REQ_NETW_TRANSPORT_PROPS,
+                           CVector<uint8_t> ( 0 ) );
+}
+
+bool CProtocol::EvaluateReqNetwTranspPropsMes()
+{
+    // invoke message action
+    emit ReqNetTranspProps();
+
+    return false; // no error
+}
+
+void CProtocol::CreateLicenceRequiredMes ( const ELicenceType eLicenceType )
+{
+    CVector<uint8_t> vecData ( 1 ); // 1 bytes of data
+    int              iPos = 0;      // init position pointer
+
+    // build data vector
+    PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( eLicenceType ), 1 );
+
+    CreateAndSendMessage ( PROTMESSID_LICENCE_REQUIRED, vecData );
+}
+
+bool CProtocol::EvaluateLicenceRequiredMes ( const CVector<uint8_t>& vecData )
+{
+    int iPos = 0; // init position pointer
+
+    // check size
+    if ( vecData.Size() != 1 )
+    {
+        return true; // return error code
+    }
+
+    // extract licence type
+    const ELicenceType eLicenceType =
+        static_cast<ELicenceType> ( GetValFromStream ( vecData, iPos, 1 ) );
+
+    if ( ( eLicenceType != LT_CREATIVECOMMONS ) &&
+         ( eLicenceType != LT_NO_LICENCE ) )
+    {
+        return true; // return error code
+    }
+
+    // invoke message action
+    emit LicenceRequired ( eLicenceType );
+
+    return false; // no error
+}
+
+void CProtocol::CreateOpusSupportedMes()
+{
+    CreateAndSendMessage ( PROTMESSID_OPUS_SUPPORTED,
+                           CVector<uint8_t> ( 0 ) );
+}
+
+void CProtocol::CreateReqChannelLevelListMes ( const bool bRCL )
+{
+    CVector<uint8_t> vecData ( 1 ); // 1 byte of data
+    int              iPos = 0; // init position pointer
+    PutValOnStream ( vecData, iPos,
+        static_cast<uint32_t> ( bRCL ), 1 );
+
+    CreateAndSendMessage ( PROTMESSID_REQ_CHANNEL_LEVEL_LIST, vecData );
+}
+
+bool CProtocol::EvaluateReqChannelLevelListMes ( const CVector<uint8_t>& vecData )
+{
+    int iPos = 0; // init position pointer
+
+    // check size
+    if ( vecData.Size() != 1 )
+    {
+        return true; // return error code
+    }
+
+    // extract opt in / out for channel levels
+    uint32_t val = GetValFromStream ( vecData, iPos, 1 );
+
+    if ( val != 0 && val != 1 )
+    {
+        return true; // return error code
+    }
+
+    // invoke message action
+    emit ReqChannelLevelList ( static_cast<bool> ( val ) );
+
+    return false; // no error
+}
+
+void CProtocol::CreateReqConClientListDeltasMes ( const bool bOptIn )
+{
+    CVector<uint8_t> vecData ( 1 ); // 1 byte of data
+    int              iPos = 0; // init position pointer
+    PutValOnStream ( vecData, iPos,
+        static_cast<uint32_t> ( bOptIn ), 1 );
+
+    CreateAndSendMessage ( PROTMESSID_REQ_CLIENTS_LIST_DELTAS, vecData );
+}
+
+bool CProtocol::EvaluateReqConClientListDeltasMes ( const CVector<uint8_t>& vecData )
+{
+    int iPos = 0; // init position pointer
+
+    // check size
+    if ( vecData.Size() != 1 )
+    {
+        return true; // return error code
+    }
+
+    // extract opt in / out for the list deltas
+    uint32_t val = GetValFromStream ( vecData, iPos, 1 );
+
+    if ( val != 0 && val != 1 )
+    {
+        return true; // return error code
+    }
+
+    // invoke message action
+    emit ReqConClientListDeltas ( static_cast<bool> ( val ) );
+
+    return false; // no error
+}
+
+void CProtocol::CreateConClientListDeltaMes ( const int                    iVersion,
+                                              const int                    iBaseVersion,
+                                              const bool                   bReset,
+                                              const CVector<CChannelInfo>& vecChanInfo,
+                                              const CVector<int>&          veciRemovedChanIDs )
+{
+    const int iNumRemoved = veciRemovedChanIDs.Size();
+    const int iNumClients = vecChanInfo.Size();
+
+    // build data vector, the client entries are appended below
+    CVector<uint8_t> vecData ( 4 /* version */ + 4 /* base version */ +
+                               1 /* reset */ + 1 /* num removed */ +
+                               iNumRemoved );
+    int              iPos = 0; // init position pointer
+
+    // version (4 bytes)
+    PutValOnStream ( vecData, iPos,
+        static_cast<uint32_t> ( iVersion ), 4 );
+
+    // base version (4 bytes)
+    PutValOnStream ( vecData, iPos,
+        static_cast<uint32_t> ( iBaseVersion ), 4 );
+
+    // reset (1 byte)
+    PutValOnStream ( vecData, iPos,
+        static_cast<uint32_t> ( bReset ), 1 );
+
+    // removed channel IDs (1 byte each)
+    PutValOnStream ( vecData, iPos,
+        static_cast<uint32_t> ( iNumRemoved ), 1 );
+
+    for ( int i = 0; i < iNumRemoved; i++ )
+    {
+        PutValOnStream ( vecData, iPos,
+            static_cast<uint32_t> ( veciRemovedChanIDs[i] ), 1 );
+    }
+
+    // added or changed clients
+    for ( int i = 0; i < iNumClients; i++ )
+    {
+        PutChanInfoOnStream ( vecData, iPos, vecChanInfo[i] );
+    }
+
+    CreateAndSendMessage ( PROTMESSID_CONN_CLIENTS_LIST_DELTA, vecData );
+}
+
+bool CProtocol::EvaluateConClientListDeltaMes ( const CVector<uint8_t>& vecData )
+{
+    int                   iPos     = 0; // init position pointer
+    const int             iDataLen = vecData.Size();
+    CVector<CChannelInfo> vecChanInfo ( 0 );
+    CVector<int>          veciRemovedChanIDs ( 0 );
+
+    // check size (the fixed part is 10 bytes)
+    if ( iDataLen < 10 )
+    {
+        return true; // return error code
+    }
+
+    // version (4 bytes)
+    const int iVersion =
+        static_cast<int> ( GetValFromStream ( vecData, iPos, 4 ) );
+
+    // base version (4 bytes)
+    const int iBaseVersion =
+        static_cast<int> ( GetValFromStream ( vecData, iPos, 4 ) );
+
+    // reset (1 byte)
+    const uint32_t iReset = GetValFromStream ( vecData, iPos, 1 );
+
+    if ( iReset != 0 && iReset != 1 )
+    {
+        return true; // return error code
+    }
+
+    // removed channel IDs (1 byte each)
+    const int iNumRemoved =
+        static_cast<int> ( GetValFromStream ( vecData, iPos, 1 ) );
+
+    if ( ( iDataLen - iPos ) < iNumRemoved )
+    {
+        return true; // return error code
+    }
+
+    for ( int i = 0; i < iNumRemoved; i++ )
+    {
+        veciRemovedChanIDs.Add (
+            static_cast<int> ( GetValFromStream ( vecData, iPos, 1 ) ) );
+    }
+
+    // added or changed clients
+    while ( iPos < iDataLen )
+    {
+        CChannelInfo CurChanInfo;
+
+        if ( GetChanInfoFromStream ( vecData, iPos, CurChanInfo ) )
+        {
+            return true; // return error code
+        }
+
+        vecChanInfo.Add ( CurChanInfo );
+    }
+
+    // check size: all data is read, the position must now be at the end
+    if ( iPos != iDataLen )
+    {
+        return true; // return error code
+    }
+
+    // invoke message action
+    emit ConClientListDeltaMesReceived ( iVersion,
+                                         iBaseVersion,
+                                         static_cast<bool> ( iReset ),
+                                         vecChanInfo,
+                                         veciRemovedChanIDs );
+
+    return false; // no error
+}
+
+void CProtocol::CreateRecvWindowSizeMes ( const bool bReqAnswer )
+{
+    CVector<uint8_t> vecData ( 2 ); // 2 bytes of data
+    int              iPos = 0; // init position pointer
+
+    // window size (1 byte)
+    PutValOnStream ( vecData, iPos,
+        static_cast<uint32_t> ( MAX_NUM_MESS_IN_FLIGHT ), 1 );
+
+    // flags (1 byte)
+    PutValOnStream ( vecData, iPos,
+        static_cast<uint32_t> ( bReqAnswer ), 1 );
+
+    CreateAndSendMessage ( PROTMESSID_RECV_WINDOW_SIZE, vecData );
+}
+
+bool CProtocol::EvaluateRecvWindowSizeMes ( const CVector<uint8_t>& vecData )
+{
+    int iPos = 0; // init position pointer
+
+    // check size
+    if ( vecData.Size() != 2 )
+    {
+        return true; // return error code
+    }
+
+    // window size (1 byte)
+    const int iWindowSize =
+        static_cast<int> ( GetValFromStream ( vecData, iPos, 1 ) );
+
+    // flags (1 byte)
+    const uint32_t iFlags = GetValFromStream ( vecData, iPos, 1 );
+
+    if ( iWindowSize < 1 )
+    {
+        return true; // return error code
+    }
+
+    Mutex.lock();
+    {
+        iPeerRecvWindowSize = std::min ( iWindowSize, MAX_NUM_MESS_IN_FLIGHT );
+    }
+    Mutex.unlock();
+
+    // a new session of the other side starts, the messages received before
+    // are not relevant anymore
+    bPeerRecvWindowKnown = true;
+    veciRecHistory.Reset ( -1 );
+
+    if ( iFlags & 1 )
+    {
+        CreateRecvWindowSizeMes ( false );
+    }
+
+    // the window may allow to send more messages now
+    SendMessage();
+
+    return false; // no error
+}
+
+bool CProtocol::EvaluateAcknListMes ( const CVector<uint8_t>& vecData )
 {
-    CreateAndSendMessage ( PROTMESSID_REQ_NETW_TRANSPORT_PROPS,
-                           CVector<uint8_t> ( 0 ) );
-}
+    int       iPos          = 0; // init position pointer
+    const int iDataLen      = vecData.Size();
+    bool      bSendNextMess = false;
 
-bool CProtocol::EvaluateReqNetwTranspPropsMes()
-{
-    // invoke message action
-    emit ReqNetTranspProps();
+    // check size (3 bytes per acknowledgement)
+    if ( ( iDataLen == 0 ) || ( ( iDataLen % 3 ) != 0 ) )
+    {
+        return true; // return error code
+    }
+
+    while ( iPos < iDataLen )
+    {
+        // ID of the acknowledged message (2 bytes)
+        const int iID =
+            static_cast<int> ( GetValFromStream ( vecData, iPos, 2 ) );
+
+        // counter of the acknowledged message (1 byte)
+        const int iCnt =
+            static_cast<int> ( GetValFromStream ( vecData, iPos, 1 ) );
+
+        if ( AcknowledgeSentMessage ( iID, iCnt ) )
+        {
+            bSendNextMess = true;
+        }
+    }
+
+    // send next messages in queue
+    if ( bSendNextMess )
+    {
+        SendMessage();
+    }
 
     return false; // no error
 }
 
-void CProtocol::CreateLicenceRequiredMes ( const ELicenceType eLicenceType )
+void CProtocol::CreateReqChannelLevelSubscrMes ( const bool          bAllChannels,
+                                                 const CVector<int>& veciChanIDs )
 {
-    CVector<uint8_t> vecData ( 1 ); // 1 bytes of data
-    int              iPos = 0;      // init position pointer
+    const int iNumChan = bAllChannels ? 0 : veciChanIDs.Size();
+    int       iPos     = 0; // init position pointer
 
-    // build data vector
-    PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( eLicenceType ), 1 );
+    // build data vector: mode (1), number (1), channel IDs (1 byte each)
+    CVector<uint8_t> vecData ( 2 + iNumChan );
 
-    CreateAndSendMessage ( PROTMESSID_LICENCE_REQUIRED, vecData );
+    PutValOnStream ( vecData, iPos,
+        static_cast<uint32_t> ( bAllChannels ? 0 : 1 ), 1 );
+
+    PutValOnStream ( vecData, iPos,
+        static_cast<uint32_t> ( iNumChan ), 1 );
+
+    for ( int i = 0; i < iNumChan; i++ )
+    {
+        PutValOnStream ( vecData, iPos,
+            static_cast<uint32_t> ( veciChanIDs[i] ), 1 );
+    }
+
+    CreateAndSendMessage ( PROTMESSID_REQ_CHANNEL_LEVEL_SUBSCR, vecData );
 }
 
-bool CProtocol::EvaluateLicenceRequiredMes ( const CVector<uint8_t>& vecData )
+bool CProtocol::EvaluateReqChannelLevelSubscrMes ( const CVector<uint8_t>& vecData )
 {
-    int iPos = 0; // init position pointer
+    int       iPos     = 0; // init position pointer
+    const int iDataLen = vecData.Size();
 
-    // check size
-    if ( vecData.Size() != 1 )
+    // check size (the fixed part)
+    if ( iDataLen < 2 )
     {
         return true; // return error code
     }
 
-    // extract licence type
-    const ELicenceType eLicenceType =
-        static_cast<ELicenceType> ( GetValFromStream ( vecData, iPos, 1 ) );
+    // mode (1 byte)
+    const int iMode =
+        static_cast<int> ( GetValFromStream ( vecData, iPos, 1 ) );
 
-    if ( ( eLicenceType != LT_CREATIVECOMMONS ) &&
-         ( eLicenceType != LT_NO_LICENCE ) )
+    // number of channel IDs (1 byte)
+    const int iNumChan =
+        static_cast<int> ( GetValFromStream ( vecData, iPos, 1 ) );
+
+    if ( ( iMode > 1 ) ||
+         ( ( iMode == 0 ) && ( iNumChan != 0 ) ) ||
+         ( iNumChan > MAX_NUM_CHANNELS ) ||
+         ( iDataLen != 2 + iNumChan ) )
     {
         return true; // return error code
     }
 
+    CVector<int> veciChanIDs ( iNumChan );
+
+    for ( int i = 0; i < iNumChan; i++ )
+    {
+        veciChanIDs[i] = static_cast<int> ( GetValFromStream ( vecData, iPos, 1 ) );
+
+        if ( veciChanIDs[i] >= MAX_NUM_CHANNELS )
+        {
+            return true; // return error code
+        }
+    }
+
     // invoke message action
-    emit LicenceRequired ( eLicenceType );
+    emit ReqChannelLevelSubscr ( iMode == 0, veciChanIDs );
 
     return false; // no error
 }
 
-void CProtocol::CreateOpusSupportedMes()
-{
-    CreateAndSendMessage ( PROTMESSID_OPUS_SUPPORTED,
-                           CVector<uint8_t> ( 0 ) );
-}
-
-void CProtocol::CreateReqChannelLevelListMes ( const bool bRCL )
+void CProtocol::CreateAudioPacketExtMes ( const bool bSupported,
+                                          const bool bReqAnswer )
 {
-    CVector<uint8_t> vecData ( 1 ); // 1 byte of data
+    CVector<uint8_t> vecData ( 2 ); // 2 bytes of data
     int              iPos = 0; // init position pointer
+
+    // supported (1 byte)
     PutValOnStream ( vecData, iPos,
-        static_cast<uint32_t> ( bRCL ), 1 );
+        static_cast<uint32_t> ( bSupported ), 1 );
 
-    CreateAndSendMessage ( PROTMESSID_REQ_CHANNEL_LEVEL_LIST, vecData );
+    // flags (1 byte)
+    PutValOnStream ( vecData, iPos,
+        static_cast<uint32_t> ( bReqAnswer ), 1 );
+
+    CreateAndSendMessage ( PROTMESSID_AUDIO_PACKET_EXT, vecData );
 }
 
-bool CProtocol::EvaluateReqChannelLevelListMes ( const CVector<uint8_t>& vecData )
+bool CProtocol::EvaluateAudioPacketExtMes ( const CVector<uint8_t>& vecData )
 {
     int iPos = 0; // init position pointer
 
     // check size
-    if ( vecData.Size() != 1 )
+    if ( vecData.Size() != 2 )
     {
         return true; // return error code
     }
 
-    // extract opt in / out for channel levels
-    uint32_t val = GetValFromStream ( vecData, iPos, 1 );
+    // supported (1 byte)
+    const uint32_t iSupported = GetValFromStream ( vecData, iPos, 1 );
 
-    if ( val != 0 && val != 1 )
+    // flags (1 byte)
+    const uint32_t iFlags = GetValFromStream ( vecData, iPos, 1 );
+
+    if ( iSupported > 1 )
     {
         return true; // return error code
     }
 
     // invoke message action
-    emit ReqChannelLevelList ( static_cast<bool> ( val ) );
+    emit AudioPacketExtReceived ( static_cast<bool> ( iSupported ),
+                                  static_cast<bool> ( iFlags & 1 ) );
 
     return false; // no error
 }
@@ -2053,11 +2816,26 @@ bool CProtocol::EvaluateCLReqConnClientsListMes ( const CHostAddress& InetAddr )
 void CProtocol::CreateCLChannelLevelListMes  ( const CHostAddress&      InetAddr,
                                                const CVector<uint16_t>& vecLevelList,
                                                const int                iNumClients )
+{
+    CVector<uint8_t> vecData;
+    CVector<uint8_t> vecNewMessage;
+
+    GenCLChannelLevelListMes ( vecNewMessage, vecData, vecLevelList, iNumClients );
+
+    // immediately send message
+    emit CLMessReadyForSending ( InetAddr, vecNewMessage );
+}
+
+void CProtocol::GenCLChannelLevelListMes ( CVector<uint8_t>&        vecOut,
+                                           CVector<uint8_t>&        vecData,
+                                           const CVector<uint16_t>& vecLevelList,
+                                           const int                iNumClients )
 {
     // This must be a multiple of bytes at four bits per client
-    const int        iNumBytes = ( iNumClients + 1 ) / 2;
-    CVector<uint8_t> vecData( iNumBytes );
-    int              iPos = 0; // init position pointer
+    const int iNumBytes = ( iNumClients + 1 ) / 2;
+    int       iPos      = 0; // init position pointer
+
+    vecData.Init ( iNumBytes );
 
     for ( int i = 0, j = 0; i < iNumClients; i += 2 /* pack two per byte */, j++ )
     {
@@ -2069,9 +2847,9 @@ void CProtocol::CreateCLChannelLevelListMes  ( const CHostAddress&      InetAddr
             static_cast<uint32_t> ( byte ), 1 );
     }
 
-    CreateAndImmSendConLessMessage ( PROTMESSID_CLM_CHANNEL_LEVEL_LIST,
-                                     vecData,
-                                     InetAddr );
+    // build complete message (counter per definition=0 for connection less
+    // messages)
+    GenMessageFrame ( vecOut, 0, PROTMESSID_CLM_CHANNEL_LEVEL_LIST, vecData );
 }
 
 bool CProtocol::EvaluateCLChannelLevelListMes  ( const CHostAddress&     InetAddr,
@@ -2148,36 +2926,148 @@ bool CProtocol::EvaluateCLRegisterServerResp ( const CHostAddress&     InetAddr,
     return false; // no error
 }
 
+void CProtocol::CreateCLChannelLevelDeltaMes ( const CHostAddress&      InetAddr,
+                                               const int                iSeqNum,
+                                               const bool               bComplete,
+                                               const CVector<int>&      veciChanIDs,
+                                               const CVector<uint16_t>& vecLevelList )
+{
+    CVector<uint8_t> vecData;
+    CVector<uint8_t> vecNewMessage;
+
+    GenCLChannelLevelDeltaMes ( vecNewMessage, vecData, iSeqNum, bComplete, veciChanIDs, vecLevelList );
+
+    // immediately send message
+    emit CLMessReadyForSending ( InetAddr, vecNewMessage );
+}
+
+void CProtocol::GenCLChannelLevelDeltaMes ( CVector<uint8_t>&        vecOut,
+                                            CVector<uint8_t>&        vecData,
+                                            const int                iSeqNum,
+                                            const bool               bComplete,
+                                            const CVector<int>&      veciChanIDs,
+                                            const CVector<uint16_t>& vecLevelList )
+{
+    const int iNumChan = veciChanIDs.Size();
+    int       iPos     = 0; // init position pointer
+
+    // build data vector: sequence number (1), flags (1), number (1), channel
+    // IDs (1 byte each) and levels (four bits each)
+    vecData.Init ( 3 + iNumChan + ( iNumChan + 1 ) / 2 );
+
+    PutValOnStream ( vecData, iPos,
+        static_cast<uint32_t> ( iSeqNum & 0xFF ), 1 );
+
+    PutValOnStream ( vecData, iPos,
+        static_cast<uint32_t> ( bComplete ? 1 : 0 ), 1 );
+
+    PutValOnStream ( vecData, iPos,
+        static_cast<uint32_t> ( iNumChan ), 1 );
+
+    for ( int i = 0; i < iNumChan; i++ )
+    {
+        PutValOnStream ( vecData, iPos,
+            static_cast<uint32_t> ( veciChanIDs[i] ), 1 );
+    }
+
+    // pack two levels per byte, the earlier channel in the lower half
+    for ( int i = 0; i < iNumChan; i += 2 )
+    {
+        uint16_t levelLo = vecLevelList[i] & 0x0F;
+        uint16_t levelHi = ( i + 1 < iNumChan ) ? vecLevelList[i + 1] & 0x0F : 0x0F;
+
+        PutValOnStream ( vecData, iPos,
+            static_cast<uint32_t> ( levelLo | ( levelHi << 4 ) ), 1 );
+    }
+
+    // build complete message (counter per definition=0 for connection less
+    // messages)
+    GenMessageFrame ( vecOut, 0, PROTMESSID_CLM_CHANNEL_LEVEL_DELTA, vecData );
+}
+
+bool CProtocol::EvaluateCLChannelLevelDeltaMes ( const CHostAddress&     InetAddr,
+                                                 const CVector<uint8_t>& vecData )
+{
+    int       iPos     = 0; // init position pointer
+    const int iDataLen = vecData.Size();
+
+    // check size (the fixed part)
+    if ( iDataLen < 3 )
+    {
+        return true; // return error code
+    }
+
+    // sequence number (1 byte)
+    const int iSeqNum =
+        static_cast<int> ( GetValFromStream ( vecData, iPos, 1 ) );
+
+    // flags (1 byte)
+    const bool bComplete =
+        ( GetValFromStream ( vecData, iPos, 1 ) & 1 ) != 0;
+
+    // number of channels (1 byte)
+    const int iNumChan =
+        static_cast<int> ( GetValFromStream ( vecData, iPos, 1 ) );
+
+    if ( ( iNumChan > MAX_NUM_CHANNELS ) ||
+         ( iDataLen != 3 + iNumChan + ( iNumChan + 1 ) / 2 ) )
+    {
+        return true; // return error code
+    }
+
+    CVector<int>      veciChanIDs ( iNumChan );
+    CVector<uint16_t> vecLevelList ( iNumChan );
+
+    for ( int i = 0; i < iNumChan; i++ )
+    {
+        veciChanIDs[i] = static_cast<int> ( GetValFromStream ( vecData, iPos, 1 ) );
+
+        if ( veciChanIDs[i] >= MAX_NUM_CHANNELS )
+        {
+            return true; // return error code
+        }
+    }
+
+    for ( int i = 0; i < iNumChan; i += 2 )
+    {
+        const uint8_t byte = static_cast<uint8_t> ( GetValFromStream ( vecData, iPos, 1 ) );
+
+        vecLevelList[i] = byte & 0x0F;
+
+        if ( i + 1 < iNumChan )
+        {
+            vecLevelList[i + 1] = ( byte >> 4 ) & 0x0F;
+        }
+    }
+
+    // invoke message action
+    emit CLChannelLevelDeltaReceived ( InetAddr, iSeqNum, bComplete, veciChanIDs, vecLevelList );
+
+    return false; // no error
+}
+
 /******************************************************************************\
 * Message generation and parsing                                               *
 \******************************************************************************/
 bool CProtocol::ParseMessageFrame ( const CVector<uint8_t>& vecbyData,
                                     const int               iNumBytesIn,
-                                    CVector<uint8_t>&       vecbyMesBodyData,
+                                    CMesBodyBuf&            MesBodyBuf,
                                     int&                    iCnt,
                                     int&                    iID )
 {
     int i;
     int iCurPos;
 
-    // vector must be at least "MESS_LEN_WITHOUT_DATA_BYTE" bytes long
-    if ( iNumBytesIn < MESS_LEN_WITHOUT_DATA_BYTE )
+    // the vector must be at least "MESS_LEN_WITHOUT_DATA_BYTE" bytes long and
+    // the tag and the length must be correct (this rejects audio packets)
+    if ( !IsProtocolMessageFrame ( vecbyData, iNumBytesIn ) )
     {
         return true; // return error code
     }
 
 
     // Decode header -----------------------------------------------------------
-    iCurPos = 0; // start from beginning
-
-    // 2 bytes TAG
-    const int iTag = static_cast<int> ( GetValFromStream ( vecbyData, iCurPos, 2 ) );
-
-    // check if tag is correct
-    if ( iTag != 0 )
-    {
-        return true; // return error code
-    }
+    iCurPos = 2; // skip the 2 bytes TAG
 
     // 2 bytes ID
     iID = static_cast<int> ( GetValFromStream ( vecbyData, iCurPos, 2 ) );
@@ -2188,25 +3078,15 @@ bool CProtocol::ParseMessageFrame ( const CVector<uint8_t>& vecbyData,
     // 2 bytes length
     const int iLenBy = static_cast<int> ( GetValFromStream ( vecbyData, iCurPos, 2 ) );
 
-    // make sure the length is correct
-    if ( iLenBy != iNumBytesIn - MESS_LEN_WITHOUT_DATA_BYTE )
-    {
-        return true; // return error code
-    }
-
 
     // Now check CRC -----------------------------------------------------------
     CCRC CRCObj;
 
     const int iLenCRCCalc = MESS_HEADER_LENGTH_BYTE + iLenBy;
 
-    iCurPos = 0; // start from the beginning
+    CRCObj.AddBytes ( &vecbyData[0], iLenCRCCalc );
 
-    for ( i = 0; i < iLenCRCCalc; i++ )
-    {
-        CRCObj.AddByte ( static_cast<uint8_t> ( 
-            GetValFromStream ( vecbyData, iCurPos, 1 ) ) );
-    }
+    iCurPos = iLenCRCCalc; // CRC follows the header and the data
 
     if ( CRCObj.GetCRC () != GetValFromStream ( vecbyData, iCurPos, 2 ) )
     {
@@ -2215,17 +3095,14 @@ bool CProtocol::ParseMessageFrame ( const CVector<uint8_t>& vecbyData,
 
 
     // Extract actual data -----------------------------------------------------
-
-// TODO this memory allocation is done in the real time thread but should be
-//      done in the low priority protocol management thread
-
-    vecbyMesBodyData.Init ( iLenBy );
+    // note that the message body buffer is taken from a preallocated pool
+    MesBodyBuf.Init ( iLenBy );
 
     iCurPos = MESS_HEADER_LENGTH_BYTE; // start from beginning of data
 
     for ( i = 0; i < iLenBy; i++ )
     {
-        vecbyMesBodyData[i] = static_cast<uint8_t> (
+        MesBodyBuf[i] = static_cast<uint8_t> (
             GetValFromStream ( vecbyData, iCurPos, 1 ) );
     }
 
@@ -2348,15 +3225,11 @@ void CProtocol::GenMessageFrame ( CVector<uint8_t>&       vecOut,
     // Encode CRC --------------------------------------------------------------
     CCRC CRCObj;
 
-    iCurPos = 0; // start from beginning
-
     const int iLenCRCCalc = MESS_HEADER_LENGTH_BYTE + iDataLenByte;
 
-    for ( i = 0; i < iLenCRCCalc; i++ )
-    {
-        CRCObj.AddByte ( static_cast<uint8_t> ( 
-            GetValFromStream ( vecOut, iCurPos, 1 ) ) );
-    }
+    CRCObj.AddBytes ( &vecOut[0], iLenCRCCalc );
+
+    iCurPos = iLenCRCCalc; // CRC follows the header and the data
 
     PutValOnStream ( vecOut, iCurPos,
         static_cast<uint32_t> ( CRCObj.GetCRC() ), 2 );
@@ -2402,3 +3275,117 @@ void CProtocol::PutStringUTF8OnStream ( CVector<uint8_t>& vecIn,
             static_cast<uint32_t> ( sStringUTF8[j] ), 1 );
     }
 }
+
+void CProtocol::PutChanInfoOnStream ( CVector<uint8_t>&   vecIn,
+                                      int&                iPos,
+                                      const CChannelInfo& ChanInfo )
+{
+/*
+    note: the vector is enlarged by the size of the list entry and iPos is
+          automatically incremented in this function
+*/
+    // convert strings to utf-8
+    const QByteArray strUTF8Name = ChanInfo.strName.toUtf8();
+    const QByteArray strUTF8City = ChanInfo.strCity.toUtf8();
+
+    // size of current list entry
+    const int iCurListEntrLen =
+        1 /* chan ID */ + 2 /* country */ +
+        4 /* instrument */ + 1 /* skill level */ +
+        4 /* IP address */ +
+        2 /* utf-8 str. size */ + strUTF8Name.size() +
+        2 /* utf-8 str. size */ + strUTF8City.size();
+
+    // make space for new data
+    vecIn.Enlarge ( iCurListEntrLen );
+
+    // channel ID (1 byte)
+    PutValOnStream ( vecIn, iPos,
+        static_cast<uint32_t> ( ChanInfo.iChanID ), 1 );
+
+    // country (2 bytes)
+    PutValOnStream ( vecIn, iPos,
+        static_cast<uint32_t> ( ChanInfo.eCountry ), 2 );
+
+    // instrument (4 bytes)
+    PutValOnStream ( vecIn, iPos,
+        static_cast<uint32_t> ( ChanInfo.iInstrument ), 4 );
+
+    // skill level (1 byte)
+    PutValOnStream ( vecIn, iPos,
+        static_cast<uint32_t> ( ChanInfo.eSkillLevel ), 1 );
+
+    // IP address (4 bytes)
+    PutValOnStream ( vecIn, iPos,
+        static_cast<uint32_t> ( ChanInfo.iIpAddr ), 4 );
+
+    // name
+    PutStringUTF8OnStream ( vecIn, iPos, strUTF8Name );
+
+    // city
+    PutStringUTF8OnStream ( vecIn, iPos, strUTF8City );
+}
+
+bool CProtocol::GetChanInfoFromStream ( const CVector<uint8_t>& vecIn,
+                                        int&                    iPos,
+                                        CChannelInfo&           ChanInfo )
+{
+/*
+    note: iPos is automatically incremented in this function
+*/
+    // check size (the next 12 bytes)
+    if ( ( vecIn.Size() - iPos ) < 12 )
+    {
+        return true; // return error code
+    }
+
+    // channel ID (1 byte)
+    const int iChanID =
+        static_cast<int> ( GetValFromStream ( vecIn, iPos, 1 ) );
+
+    // country (2 bytes)
+    const QLocale::Country eCountry =
+        static_cast<QLocale::Country> ( GetValFromStream ( vecIn, iPos, 2 ) );
+
+    // instrument (4 bytes)
+    const int iInstrument =
+        static_cast<int> ( GetValFromStream ( vecIn, iPos, 4 ) );
+
+    // skill level (1 byte)
+    const ESkillLevel eSkillLevel =
+        static_cast<ESkillLevel> ( GetValFromStream ( vecIn, iPos, 1 ) );
+
+    // IP address (4 bytes)
+    const int iIpAddr =
+        static_cast<int> ( GetValFromStream ( vecIn, iPos, 4 ) );
+
+    // name
+    QString strCurName;
+    if ( GetStringFromStream ( vecIn,
+                               iPos,
+                               MAX_LEN_FADER_TAG,
+                               strCurName ) )
+    {
+        return true; // return error code
+    }
+
+    // city
+    QString strCurCity;
+    if ( GetStringFromStream ( vecIn,
+                               iPos,
+                               MAX_LEN_SERVER_CITY,
+                               strCurCity ) )
+    {
+        return true; // return error code
+    }
+
+    ChanInfo = CChannelInfo ( iChanID,
+                              iIpAddr,
+                              strCurName,
+                              eCountry,
+                              strCurCity,
+                              iInstrument,
+                              eSkillLevel );
+
+    return false; // no error
+}
@@ -25,6 +25,7 @@
 #pragma once
 
 #include <QMutex>
+#include <QAtomicInt>
 #include <QTimer>
 #include <QDateTime>
 #include <list>
@@ -55,6 +56,12 @@
 #define PROTMESSID_OPUS_SUPPORTED             26 // tells that OPUS codec is supported
 #define PROTMESSID_LICENCE_REQUIRED           27 // licence required
 #define PROTMESSID_REQ_CHANNEL_LEVEL_LIST     28 // request the channel level list
+#define PROTMESSID_REQ_CLIENTS_LIST_DELTAS    29 // opt in to conn. clients list deltas
+#define PROTMESSID_CONN_CLIENTS_LIST_DELTA    30 // changes of the conn. clients list
+#define PROTMESSID_RECV_WINDOW_SIZE           31 // max. number of unackn. messages
+#define PROTMESSID_ACKN_LIST                  32 // acknowledge of several messages
+#define PROTMESSID_REQ_CHANNEL_LEVEL_SUBSCR   33 // subscribe to channel level deltas
+#define PROTMESSID_AUDIO_PACKET_EXT           34 // audio packet extension supported
 
 // message IDs of connection less messages (CLM)
 // DEFINITION -> start at 1000, end at 1999, see IsConnectionLessMessageID
@@ -74,6 +81,7 @@
 #define PROTMESSID_CLM_REQ_CONN_CLIENTS_LIST  1014 // request the connected clients list
 #define PROTMESSID_CLM_CHANNEL_LEVEL_LIST     1015 // channel level list
 #define PROTMESSID_CLM_REGISTER_SERVER_RESP   1016 // status of server registration request
+#define PROTMESSID_CLM_CHANNEL_LEVEL_DELTA    1017 // changed channel levels
 
 // lengths of message as defined in protocol.cpp file
 #define MESS_HEADER_LENGTH_BYTE         7 // TAG (2), ID (2), cnt (1), length (2)
@@ -82,8 +90,64 @@
 // time out for message re-send if no acknowledgement was received
 #define SEND_MESS_TIMEOUT_MS            400 // ms
 
+// maximum number of messages which are sent without waiting for the
+// acknowledgement (if the other side supports it, see
+// PROTMESSID_RECV_WINDOW_SIZE) and the number of received messages which are
+// remembered to detect resent messages
+#define MAX_NUM_MESS_IN_FLIGHT          8
+#define RECV_MESS_HISTORY_LEN           32
+
+// maximum number of acknowledgements in one PROTMESSID_ACKN_LIST message
+#define MAX_NUM_ACKN_IN_LIST            32
+
+// number of preallocated buffers for received protocol message bodies
+#define NUM_MES_BODY_BUF_POOL_SLOTS     32
+
+// version of the connected clients list if no list was received yet (see
+// PROTMESSID_CONN_CLIENTS_LIST_DELTA)
+#define INVALID_CHAN_LIST_VERSION       -1
+
+// sequence number of the channel level deltas if no delta was received yet
+// (see PROTMESSID_CLM_CHANNEL_LEVEL_DELTA)
+#define INVALID_LEVEL_SEQ_NUM           -1
+
 
 /* Classes ********************************************************************/
+// Buffer for a received protocol message body. The memory is taken from a
+// preallocated pool and is reference counted, i.e., copying the buffer (e.g.
+// for a queued signal) does not copy the data. This way the high priority
+// socket thread does not allocate memory for received protocol messages (only
+// if the pool is exhausted, a buffer is allocated on the heap).
+class CMesBodyBuf
+{
+public:
+    class CSlot
+    {
+    public:
+        CVector<uint8_t> vecbyData;
+        QAtomicInt       iRefCnt;
+        bool             bIsPooled;
+    };
+
+    CMesBodyBuf() : pSlot ( nullptr ) {}
+    CMesBodyBuf ( const CMesBodyBuf& Other ) : pSlot ( Other.pSlot ) { AddRef(); }
+    ~CMesBodyBuf() { Release(); }
+
+    CMesBodyBuf& operator= ( const CMesBodyBuf& Other );
+
+    void Init ( const int iNewSize );
+
+    uint8_t& operator[] ( const int iPos ) { return pSlot->vecbyData[iPos]; }
+    const CVector<uint8_t>& GetData() const;
+
+protected:
+    void AddRef() { if ( pSlot != nullptr ) { pSlot->iRefCnt.ref(); } }
+    void Release();
+
+    CSlot* pSlot;
+};
+
+
 class CProtocol : public QObject
 {
     Q_OBJECT
@@ -106,6 +170,16 @@ public:
     void CreateLicenceRequiredMes ( const ELicenceType eLicenceType );
     void CreateOpusSupportedMes();
     void CreateReqChannelLevelListMes ( const bool bRCL );
+    void CreateReqConClientListDeltasMes ( const bool bOptIn );
+    void CreateConClientListDeltaMes ( const int                    iVersion,
+                                       const int                    iBaseVersion,
+                                       const bool                   bReset,
+                                       const CVector<CChannelInfo>& vecChanInfo,
+                                       const CVector<int>&          veciRemovedChanIDs );
+    void CreateReqChannelLevelSubscrMes ( const bool          bAllChannels,
+                                          const CVector<int>& veciChanIDs );
+    void CreateAudioPacketExtMes ( const bool bSupported,
+                                   const bool bReqAnswer );
 
     void CreateCLPingMes               ( const CHostAddress& InetAddr, const int iMs );
     void CreateCLPingWithNumClientsMes ( const CHostAddress& InetAddr,
@@ -133,13 +207,42 @@ public:
                                          const int                iNumClients );
     void CreateCLRegisterServerResp    ( const CHostAddress& InetAddr,
                                          const ESvrRegResult eResult );
+    void CreateCLChannelLevelDeltaMes  ( const CHostAddress&      InetAddr,
+                                         const int                iSeqNum,
+                                         const bool               bComplete,
+                                         const CVector<int>&      veciChanIDs,
+                                         const CVector<uint16_t>& vecLevelList );
+
+    // the channel level messages are generated by the server frame processing
+    // which sends them with the audio packets (the message and data vectors
+    // are not reallocated if they have enough capacity)
+    static void GenCLChannelLevelListMes  ( CVector<uint8_t>&        vecOut,
+                                            CVector<uint8_t>&        vecData,
+                                            const CVector<uint16_t>& vecLevelList,
+                                            const int                iNumClients );
+    static void GenCLChannelLevelDeltaMes ( CVector<uint8_t>&        vecOut,
+                                            CVector<uint8_t>&        vecData,
+                                            const int                iSeqNum,
+                                            const bool               bComplete,
+                                            const CVector<int>&      veciChanIDs,
+                                            const CVector<uint16_t>& vecLevelList );
 
     static bool ParseMessageFrame ( const CVector<uint8_t>& vecbyData,
                                     const int               iNumBytesIn,
-                                    CVector<uint8_t>&       vecbyMesBodyData,
+                                    CMesBodyBuf&            MesBodyBuf,
                                     int&                    iRecCounter,
                                     int&                    iRecID );
 
+    // cheap check of the frame header (tag and length) which rejects audio
+    // packets before any parsing or CRC calculation
+    static bool IsProtocolMessageFrame ( const CVector<uint8_t>& vecbyData,
+                                         const int               iNumBytesIn )
+    {
+        return ( iNumBytesIn >= MESS_LEN_WITHOUT_DATA_BYTE ) &&
+               ( vecbyData[0] == 0 ) && ( vecbyData[1] == 0 ) &&
+               ( ( vecbyData[5] | ( vecbyData[6] << 8 ) ) == iNumBytesIn - MESS_LEN_WITHOUT_DATA_BYTE );
+    }
+
     bool ParseMessageBody ( const CVector<uint8_t>& vecbyMesBodyData,
                             const int               iRecCounter,
                             const int               iRecID );
@@ -159,39 +262,54 @@ protected:
     class CSendMessage
     {
     public:
-        CSendMessage() : vecMessage ( 0 ), iID ( PROTMESSID_ILLEGAL ),
-            iCnt ( 0 ) {}
-        CSendMessage ( const CVector<uint8_t>& nMess, const int iNCnt,
-            const int iNID ) : vecMessage ( nMess ), iID ( iNID ),
-            iCnt ( iNCnt ) {}
-
-        CSendMessage& operator= ( const CSendMessage& NewSendMess )
-        {
-            vecMessage.Init ( NewSendMess.vecMessage.Size() );
-            vecMessage = NewSendMess.vecMessage;
-
-            iID  = NewSendMess.iID;
-            iCnt = NewSendMess.iCnt;
-            return *this; 
-        }
-
+        CSendMessage() : vecData ( 0 ), vecMessage ( 0 ),
+            iID ( PROTMESSID_ILLEGAL ), iKey ( 0 ), iCnt ( 0 ),
+            bInFlight ( false ) {}
+        CSendMessage ( const CVector<uint8_t>& vecNData, const int iNID,
+            const int iNKey ) : vecData ( vecNData ), vecMessage ( 0 ),
+            iID ( iNID ), iKey ( iNKey ), iCnt ( 0 ), bInFlight ( false ) {}
+
+        // the complete message (and the counter) is generated when the
+        // message is sent for the first time
+        CVector<uint8_t> vecData;
         CVector<uint8_t> vecMessage;
-        int              iID, iCnt;
+        int              iID, iKey, iCnt;
+        bool             bInFlight;
     };
 
-    void EnqueueMessage ( CVector<uint8_t>& vecMessage,
-                          const int         iCnt,
-                          const int         iID );
+    // messages with the same key are delivered in order, i.e., only one of
+    // them is in flight at a time
+    static int GetSendMessageKey ( const int               iID,
+                                   const CVector<uint8_t>& vecData );
+
+    // a queued message of these types is replaced by a newer one with the
+    // same key since it only carries a state which is superseded
+    static bool IsCoalescableMessageID ( const int iID );
+
+    void EnqueueMessage ( const CVector<uint8_t>& vecData,
+                          const int               iID );
+
+    bool IsResentMessage ( const int iRecID,
+                           const int iRecCounter ) const;
+
+    void StoreReceivedMessage ( const int iRecID,
+                                const int iRecCounter );
 
-    void GenMessageFrame ( CVector<uint8_t>&       vecOut,
-                           const int               iCnt,
-                           const int               iID,
-                           const CVector<uint8_t>& vecData );
+    bool AcknowledgeSentMessage ( const int iID,
+                                  const int iCnt );
 
-    void PutValOnStream ( CVector<uint8_t>& vecIn,
-                          int&              iPos,
-                          const uint32_t    iVal,
-                          const int         iNumOfBytes );
+    void SendAcknMess ( const int iID,
+                        const int iCnt );
+
+    static void GenMessageFrame ( CVector<uint8_t>&       vecOut,
+                                  const int               iCnt,
+                                  const int               iID,
+                                  const CVector<uint8_t>& vecData );
+
+    static void PutValOnStream ( CVector<uint8_t>& vecIn,
+                                 int&              iPos,
+                                 const uint32_t    iVal,
+                                 const int         iNumOfBytes );
 
     void PutStringUTF8OnStream ( CVector<uint8_t>& vecIn,
                                  int&              iPos,
@@ -206,7 +324,17 @@ protected:
                                const int               iMaxStringLen,
                                QString&                strOut );
 
-    void SendMessage();
+    void PutChanInfoOnStream ( CVector<uint8_t>&   vecIn,
+                               int&                iPos,
+                               const CChannelInfo& ChanInfo );
+
+    bool GetChanInfoFromStream ( const CVector<uint8_t>& vecIn,
+                                 int&                    iPos,
+                                 CChannelInfo&           ChanInfo );
+
+    void SendMessage ( const bool bResendInFlight = false );
+
+    void CreateRecvWindowSizeMes ( const bool bReqAnswer );
 
     void CreateAndSendMessage ( const int               iID,
                                 const CVector<uint8_t>& vecData );
@@ -227,6 +355,12 @@ protected:
     bool EvaluateReqNetwTranspPropsMes();
     bool EvaluateLicenceRequiredMes     ( const CVector<uint8_t>& vecData );
     bool EvaluateReqChannelLevelListMes ( const CVector<uint8_t>& vecData );
+    bool EvaluateReqConClientListDeltasMes ( const CVector<uint8_t>& vecData );
+    bool EvaluateConClientListDeltaMes ( const CVector<uint8_t>& vecData );
+    bool EvaluateRecvWindowSizeMes ( const CVector<uint8_t>& vecData );
+    bool EvaluateAcknListMes ( const CVector<uint8_t>& vecData );
+    bool EvaluateReqChannelLevelSubscrMes ( const CVector<uint8_t>& vecData );
+    bool EvaluateAudioPacketExtMes ( const CVector<uint8_t>& vecData );
 
     bool EvaluateCLPingMes               ( const CHostAddress&     InetAddr,
                                            const CVector<uint8_t>& vecData );
@@ -251,19 +385,35 @@ protected:
                                            const CVector<uint8_t>& vecData );
     bool EvaluateCLRegisterServerResp    ( const CHostAddress&     InetAddr,
                                            const CVector<uint8_t>& vecData );
+    bool EvaluateCLChannelLevelDeltaMes  ( const CHostAddress&     InetAddr,
+                                           const CVector<uint8_t>& vecData );
 
     int                     iOldRecID;
     int                     iOldRecCnt;
 
-    // these two objects must be sequred by a mutex
+    // received messages of the current session of the other side (only used
+    // if the other side announced its receive window, it then may have
+    // several messages in flight) and the acknowledgements which are sent
+    // together in one message
+    bool                    bPeerRecvWindowKnown;
+    CVector<int>            veciRecHistory;
+    int                     iRecHistoryIdx;
+    CVector<int>            veciPendingAcknIDs;
+    CVector<int>            veciPendingAcknCnts;
+
+    // these objects must be sequred by a mutex
     uint8_t                 iCounter;
     std::list<CSendMessage> SendMessQueue;
+    bool                    bRecvWindowAnnounced;
+    int                     iPeerRecvWindowSize;
 
     QTimer                  TimerSendMess;
+    QTimer                  TimerSendAckn;
     QMutex                  Mutex;
 
 public slots:
-    void OnTimerSendMess() { SendMessage(); }
+    void OnTimerSendMess() { SendMessage ( true ); }
+    void OnTimerSendAckn();
 
 signals:
     // transmitting
@@ -286,6 +436,14 @@ signals:
     void ReqNetTranspProps();
     void LicenceRequired ( ELicenceType eLicenceType );
     void ReqChannelLevelList ( bool bOptIn );
+    void ReqConClientListDeltas ( bool bOptIn );
+    void ConClientListDeltaMesReceived ( int                   iVersion,
+                                         int                   iBaseVersion,
+                                         bool                  bReset,
+                                         CVector<CChannelInfo> vecChanInfo,
+                                         CVector<int>          veciRemovedChanIDs );
+    void ReqChannelLevelSubscr ( bool bAllChannels, CVector<int> veciChanIDs );
+    void AudioPacketExtReceived ( bool bSupported, bool bReqAnswer );
 
     void CLPingReceived               ( CHostAddress           InetAddr,
                                         int                    iMs );
@@ -312,4 +470,9 @@ signals:
                                         CVector<uint16_t>      vecLevelList );
     void CLRegisterServerResp         ( CHostAddress           InetAddr,
                                         ESvrRegResult          eStatus );
+    void CLChannelLevelDeltaReceived  ( CHostAddress           InetAddr,
+                                        int                    iSeqNum,
+                                        bool                   bComplete,
+                                        CVector<int>           veciChanIDs,
+                                        CVector<uint16_t>      vecLevelList );
 };
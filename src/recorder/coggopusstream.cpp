@@ -0,0 +1,294 @@
+/******************************************************************************\
+ *
+ * Author(s):
+ *  pljones
+ *
+ ******************************************************************************
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+\******************************************************************************/
+
+#include <QFile>
+#include <QDebug>
+#include <QtEndian>
+
+#include "coggopusstream.h"
+#include "cwavestream.h"
+
+/******************************************************************************\
+* Implementations of recorder.COggOpusStream methods                           *
+\******************************************************************************/
+
+using namespace recorder;
+
+// Ogg page header flags
+static const uint8_t oggHeaderTypeBeginOfStream = 0x02;
+static const uint8_t oggHeaderTypeEndOfStream   = 0x04;
+static const int     oggPageHeaderSize          = 27;
+
+/**
+ * @brief COggOpusStream::COggOpusStream Create the Opus encoder and write the identification and comment headers
+ * @param iod the device to write the stream to
+ * @param numChannels 1 for mono, 2 for stereo
+ */
+COggOpusStream::COggOpusStream(QIODevice* iod, const uint16_t numChannels) :
+    iod (iod),
+    numChannels (numChannels),
+    encoder (nullptr),
+    preSkip (0),
+    serialNo (0x4a616d75), // "Jamu", there is only one logical stream per file
+    pageSeqNo (0),
+    frame (OGG_OPUS_FRAME_SIZE_SAMPLES * numChannels),
+    frameFill (0),
+    packet (OGG_OPUS_MAX_PACKET_SIZE_BYTES),
+    numInputSamples (0),
+    numEncodedSamples (0),
+    pageBody (OGG_OPUS_PACKETS_PER_PAGE * OGG_OPUS_MAX_PACKET_SIZE_BYTES),
+    pageBodyFill (0),
+    segmentTable (OGG_MAX_SEGMENTS_PER_PAGE),
+    numSegments (0),
+    numPagePackets (0)
+{
+    int opusError;
+
+    encoder = opus_encoder_create(FmtSubChunk::sampleRate, numChannels, OPUS_APPLICATION_AUDIO, &opusError);
+    if (encoder == nullptr)
+    {
+        throw std::runtime_error( "Could not create the Opus encoder" );
+    }
+
+    opus_encoder_ctl(encoder, OPUS_SET_BITRATE(OGG_OPUS_BITRATE_PER_CHANNEL * numChannels));
+    opus_encoder_ctl(encoder, OPUS_GET_LOOKAHEAD(&preSkip));
+
+    // identification header (RFC 7845, section 5.1)
+    uint8_t opusHead[19] = { 'O', 'p', 'u', 's', 'H', 'e', 'a', 'd' };
+    opusHead[8] = 1; // version
+    opusHead[9] = static_cast<uint8_t>(numChannels);
+    qToLittleEndian<quint16>(static_cast<quint16>(preSkip), &opusHead[10]);
+    qToLittleEndian<quint32>(FmtSubChunk::sampleRate, &opusHead[12]); // input sample rate
+    qToLittleEndian<quint16>(0, &opusHead[16]); // output gain
+    opusHead[18] = 0; // channel mapping family
+
+    addPacket(opusHead, sizeof(opusHead));
+    writePage(oggHeaderTypeBeginOfStream, 0);
+
+    // comment header (RFC 7845, section 5.2)
+    static const char vendor[] = "Jamulus";
+    uint8_t opusTags[8 + 4 + sizeof(vendor) - 1 + 4] = { 'O', 'p', 'u', 's', 'T', 'a', 'g', 's' };
+    qToLittleEndian<quint32>(sizeof(vendor) - 1, &opusTags[8]);
+    memcpy(&opusTags[12], vendor, sizeof(vendor) - 1);
+    qToLittleEndian<quint32>(0, &opusTags[12 + sizeof(vendor) - 1]); // no user comments
+
+    addPacket(opusTags, sizeof(opusTags));
+    writePage(0, 0);
+}
+
+COggOpusStream::~COggOpusStream()
+{
+    opus_encoder_destroy(encoder);
+}
+
+/**
+ * @brief COggOpusStream::write Encode interleaved PCM samples
+ * @param pcm the samples (in host byte order)
+ * @param numSamples the number of samples of all channels
+ */
+void COggOpusStream::write(const int16_t* pcm, const int numSamples)
+{
+    int pos = 0;
+
+    while (pos < numSamples)
+    {
+        const int toCopy = std::min(numSamples - pos, frame.Size() - frameFill);
+
+        std::copy(pcm + pos, pcm + pos + toCopy, frame.begin() + frameFill);
+        frameFill += toCopy;
+        pos       += toCopy;
+
+        if (frameFill == frame.Size())
+        {
+            encodeFrame();
+        }
+    }
+
+    numInputSamples += numSamples / numChannels;
+}
+
+/**
+ * @brief COggOpusStream::finalise Encode the remaining samples and write the last page
+ *
+ * The granule position of the last page marks the end of the audio so that the padding is discarded on decoding.
+ */
+void COggOpusStream::finalise()
+{
+    // the encoder delay must be flushed, too
+    const qint64 numTotalSamples = numInputSamples + preSkip;
+
+    while (numEncodedSamples < numTotalSamples)
+    {
+        std::fill(frame.begin() + frameFill, frame.end(), 0);
+        frameFill = frame.Size();
+
+        encodeFrame();
+    }
+
+    writePage(oggHeaderTypeEndOfStream, numTotalSamples);
+}
+
+/**
+ * @brief COggOpusStream::flush Write the page with the packets encoded so far
+ *
+ * The samples of a partial frame stay buffered until the frame is complete.
+ */
+void COggOpusStream::flush()
+{
+    writePage(0, numEncodedSamples);
+}
+
+/**
+ * @brief COggOpusStream::lengthSamples Get the length of an Ogg Opus file from the granule position of its last page
+ * @param fileName the file
+ * @return the number of samples per channel or zero if the file could not be read
+ */
+qint64 COggOpusStream::lengthSamples(const QString& fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return 0;
+    }
+
+    // the first page only contains the identification header
+    const QByteArray firstPage = file.read(oggPageHeaderSize + 1 + 19);
+    if (firstPage.size() < oggPageHeaderSize + 1 + 19 || !firstPage.startsWith("OggS"))
+    {
+        return 0;
+    }
+    const qint64 filePreSkip = qFromLittleEndian<quint16>(reinterpret_cast<const uchar*>(firstPage.constData()) + oggPageHeaderSize + 1 + 10);
+
+    // an Ogg page is at most 65307 bytes long
+    const qint64 tailSize = std::min(file.size(), static_cast<qint64>(65307));
+    file.seek(file.size() - tailSize);
+    const QByteArray tail = file.read(tailSize);
+
+    const int lastPagePos = tail.lastIndexOf("OggS");
+    if (lastPagePos < 0 || lastPagePos + 14 > tail.size())
+    {
+        return 0;
+    }
+    const qint64 granulePos = qFromLittleEndian<qint64>(reinterpret_cast<const uchar*>(tail.constData()) + lastPagePos + 6);
+
+    return std::max(granulePos - filePreSkip, static_cast<qint64>(0));
+}
+
+void COggOpusStream::encodeFrame()
+{
+    const int size = opus_encode(encoder, &frame[0], OGG_OPUS_FRAME_SIZE_SAMPLES, &packet[0], packet.Size());
+
+    frameFill = 0;
+    numEncodedSamples += OGG_OPUS_FRAME_SIZE_SAMPLES;
+
+    if (size < 0)
+    {
+        qWarning() << "COggOpusStream::encodeFrame: Opus encoding failed:" << opus_strerror(size);
+        return;
+    }
+
+    // the page is written before the next packet is added so that the last page always holds the
+    // last packet (segments of a packet: n * 255 bytes plus a possibly empty remainder)
+    if (numPagePackets == OGG_OPUS_PACKETS_PER_PAGE ||
+        numSegments + size / 255 + 1 > OGG_MAX_SEGMENTS_PER_PAGE)
+    {
+        writePage(0, numEncodedSamples - OGG_OPUS_FRAME_SIZE_SAMPLES);
+    }
+
+    addPacket(&packet[0], size);
+}
+
+void COggOpusStream::addPacket(const uint8_t* data, const int size)
+{
+    std::copy(data, data + size, pageBody.begin() + pageBodyFill);
+    pageBodyFill += size;
+
+    int remaining = size;
+    while (remaining >= 255)
+    {
+        segmentTable[numSegments++] = 255;
+        remaining -= 255;
+    }
+    segmentTable[numSegments++] = static_cast<uint8_t>(remaining);
+
+    numPagePackets++;
+}
+
+void COggOpusStream::writePage(const uint8_t headerType, const qint64 granulePos)
+{
+    if (numSegments == 0 && headerType != oggHeaderTypeEndOfStream)
+    {
+        return;
+    }
+
+    uint8_t header[oggPageHeaderSize] = { 'O', 'g', 'g', 'S' };
+    header[4] = 0; // stream structure version
+    header[5] = headerType;
+    qToLittleEndian<qint64>(granulePos, &header[6]);
+    qToLittleEndian<quint32>(serialNo, &header[14]);
+    qToLittleEndian<quint32>(pageSeqNo, &header[18]);
+    qToLittleEndian<quint32>(0, &header[22]); // CRC, see below
+    header[26] = static_cast<uint8_t>(numSegments);
+
+    uint32_t pageCrc = crc(header, oggPageHeaderSize, 0);
+    pageCrc = crc(&segmentTable[0], numSegments, pageCrc);
+    pageCrc = crc(&pageBody[0], pageBodyFill, pageCrc);
+    qToLittleEndian<quint32>(pageCrc, &header[22]);
+
+    iod->write(reinterpret_cast<const char*>(header), oggPageHeaderSize);
+    iod->write(reinterpret_cast<const char*>(&segmentTable[0]), numSegments);
+    iod->write(reinterpret_cast<const char*>(&pageBody[0]), pageBodyFill);
+
+    pageSeqNo++;
+    pageBodyFill   = 0;
+    numSegments    = 0;
+    numPagePackets = 0;
+}
+
+/**
+ * @brief COggOpusStream::crc Ogg CRC32 (polynomial 0x04c11db7, not reflected, initial value zero)
+ */
+uint32_t COggOpusStream::crc(const uint8_t* data, const int size, uint32_t crc)
+{
+    static uint32_t table[256] = { 0 };
+
+    if (table[1] == 0)
+    {
+        for (uint32_t i = 0; i < 256; i++)
+        {
+            uint32_t r = i << 24;
+            for (int bit = 0; bit < 8; bit++)
+            {
+                r = (r & 0x80000000) ? ((r << 1) ^ 0x04c11db7) : (r << 1);
+            }
+            table[i] = r;
+        }
+    }
+
+    for (int i = 0; i < size; i++)
+    {
+        crc = (crc << 8) ^ table[((crc >> 24) ^ data[i]) & 0xff];
+    }
+
+    return crc;
+}
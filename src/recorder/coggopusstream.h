@@ -0,0 +1,95 @@
+/******************************************************************************\
+ *
+ * Author(s):
+ *  pljones
+ *
+ ******************************************************************************
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+\******************************************************************************/
+
+#pragma once
+
+#include <QIODevice>
+#include <QString>
+#ifdef USE_OPUS_SHARED_LIB
+# include "opus/opus.h"
+#else
+# include "opus.h"
+#endif
+
+#include "../util.h"
+
+// Ogg Opus encoding parameters: 20 ms frames at 48 kHz
+#define OGG_OPUS_FRAME_SIZE_SAMPLES     960
+#define OGG_OPUS_BITRATE_PER_CHANNEL    64000
+#define OGG_OPUS_MAX_PACKET_SIZE_BYTES  1275
+
+// an Ogg page is written after one second of audio (or if the segment table is full or on flush())
+#define OGG_OPUS_PACKETS_PER_PAGE       50
+#define OGG_MAX_SEGMENTS_PER_PAGE       255
+
+namespace recorder {
+
+/**
+ * @brief Writes 16 bit PCM data as an Ogg Opus stream (RFC 7845)
+ *
+ * The samples are encoded in 20 ms frames and the packets are collected in Ogg pages.  Like
+ * CWaveStream, the stream must be finalised to write the last (partial) frame and page.
+ */
+class COggOpusStream
+{
+public:
+    COggOpusStream(QIODevice* iod, const uint16_t numChannels);
+    ~COggOpusStream();
+
+    void write(const int16_t* pcm, const int numSamples);
+
+    void flush();
+
+    void finalise();
+
+    static qint64 lengthSamples(const QString& fileName);
+
+private:
+    void encodeFrame();
+    void addPacket(const uint8_t* data, const int size);
+    void writePage(const uint8_t headerType, const qint64 granulePos);
+
+    static uint32_t crc(const uint8_t* data, const int size, uint32_t crc);
+
+    QIODevice*         iod;
+    const uint16_t     numChannels;
+    OpusEncoder*       encoder;
+    int                preSkip;
+
+    const uint32_t     serialNo;
+    uint32_t           pageSeqNo;
+
+    CVector<int16_t>   frame;
+    int                frameFill;
+    CVector<uint8_t>   packet;
+    qint64             numInputSamples; // per channel
+    qint64             numEncodedSamples; // per channel
+
+    CVector<uint8_t>   pageBody;
+    int                pageBodyFill;
+    CVector<uint8_t>   segmentTable;
+    int                numSegments;
+    int                numPagePackets;
+};
+
+}
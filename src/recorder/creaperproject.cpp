@@ -50,9 +50,9 @@ using namespace recorder;
 // Reaper Project writer -------------------------------------------------------
 
 /**
- * @brief CReaperItem::CReaperItem Construct a Reaper RPP "<ITEM>" for a given RIFF WAVE file
+ * @brief CReaperItem::CReaperItem Construct a Reaper RPP "<ITEM>" for a given RIFF WAVE or Ogg Opus file
  * @param name the item name
- * @param trackItem the details of where the item is in the track, along with the RIFF WAVE filename
+ * @param trackItem the details of where the item is in the track, along with the RIFF WAVE or Ogg Opus filename
  * @param iid the sequential item id
  */
 CReaperItem::CReaperItem(const QString& name, const STrackItem& trackItem, const qint32& iid, int frameSize)
@@ -71,7 +71,7 @@ CReaperItem::CReaperItem(const QString& name, const STrackItem& trackItem, const
     sOut << "      NAME " << name << endl;
     sOut << "      GUID " << guid.toString() << endl;
 
-    sOut << "      <SOURCE WAVE" << endl;
+    sOut << "      <SOURCE " << (wavName.endsWith(".opus") ? "OPUS" : "WAVE") << endl;
     sOut << "        FILE " << '"' << wavName << '"' << endl;
     sOut << "      >" << endl;
 
@@ -120,7 +120,13 @@ void CWaveStream::waveStreamHeaders()
     *this << scHdrRiff << cFmtSubChunk << scDataSubChunkHdr;
 }
 
-void CWaveStream::finalise()
+/**
+ * @brief CWaveStream::writeSizes Update the RIFF and data chunk sizes to the current length of the stream
+ *
+ * The stream is positioned at its end afterwards and keeps its Little Endian byte order, so it can
+ * be called repeatedly on a stream which is still written.
+ */
+void CWaveStream::writeSizes()
 {
     static const uint32_t hdrRiffChunkSize = sizeof(uint32_t) + sizeof(uint32_t) + sizeof(uint32_t);
     static const uint32_t fmtSubChunkSize = sizeof(uint32_t) + sizeof(uint32_t) + sizeof(uint16_t) + sizeof(uint16_t) + sizeof(uint32_t) + sizeof(uint32_t) + sizeof(uint16_t) + sizeof(uint16_t);
@@ -141,7 +147,15 @@ void CWaveStream::finalise()
     this->device()->seek(initialPos + dataSubChunkHdrChunkSizeOffset);
     out << static_cast<uint32_t>(fileLength - (dataSubChunkHdrChunkSizeOffset + sizeof (uint32_t)));
 
-    // and then restore the position and byte order
+    // and then restore the position
     this->device()->seek(currentPos);
+}
+
+/**
+ * @brief CWaveStream::finalise Write the final chunk sizes and restore the initial byte order of the stream
+ */
+void CWaveStream::finalise()
+{
+    writeSizes();
     setByteOrder(initialByteOrder);
 }
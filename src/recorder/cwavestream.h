@@ -73,6 +73,7 @@ public:
     CWaveStream(QByteArray *iod, QIODevice::OpenMode flags, const uint16_t numChannels);
     CWaveStream(const QByteArray &ba, const uint16_t numChannels);
 
+    void writeSizes();
     void finalise();
 
 private:
@@ -25,6 +25,123 @@
 
 using namespace recorder;
 
+/* ********************************************************************************************************
+ * CJamFrameRing
+ * ********************************************************************************************************/
+
+/**
+ * @brief CJamFrameRing::Init Allocate the sample memory of all slots
+ * @param _frameSizeSamples the server frame size
+ *
+ * Each slot holds a stereo frame so that the number of audio channels of a client may change at any time.
+ */
+void CJamFrameRing::Init(const int _frameSizeSamples)
+{
+    frameSizeSamples = _frameSizeSamples;
+    samples.Init(NUM_JAM_FRAME_RING_SLOTS * 2 * frameSizeSamples);
+
+    for (int i = 0; i < NUM_JAM_FRAME_RING_SLOTS; i++)
+    {
+        frames[i].frame            = 0;
+        frames[i].numAudioChannels = 0;
+        frames[i].data             = &samples[i * 2 * frameSizeSamples];
+    }
+
+    putPos.storeRelease(0);
+    getPos.storeRelease(0);
+    numDropped.storeRelease(0);
+}
+
+/**
+ * @brief CJamFrameRing::NextPutSlot Get the slot for the next frame (producer only)
+ * @return the slot or nullptr if the ring is full
+ */
+CJamFrameRing::SFrame* CJamFrameRing::NextPutSlot()
+{
+    if ((frameSizeSamples == 0) ||
+        ((putPos.loadAcquire() + 1) % NUM_JAM_FRAME_RING_SLOTS == getPos.loadAcquire()))
+    {
+        numDropped.fetchAndAddOrdered(1);
+        return nullptr;
+    }
+
+    return &frames[putPos.loadAcquire()];
+}
+
+/**
+ * @brief CJamFrameRing::Put Queue a frame of PCM data (producer only)
+ * @return false if the ring is full and the frame was dropped
+ *
+ * Assigning the name and address only references the implicitly shared data, no memory is allocated.
+ */
+bool CJamFrameRing::Put(const qint64 frame, const QString& name, const CHostAddress& address, const int numAudioChannels, const CVector<int16_t>& data)
+{
+    SFrame* slot = NextPutSlot();
+
+    if (slot == nullptr)
+    {
+        return false;
+    }
+
+    const int numSamples = std::min(numAudioChannels, 2) * frameSizeSamples;
+
+    slot->frame            = frame;
+    slot->numAudioChannels = numAudioChannels;
+    slot->name             = name;
+    slot->address          = address;
+    std::copy(data.begin(), data.begin() + numSamples, slot->data);
+
+    // publish the slot to the consumer
+    putPos.storeRelease((putPos.loadAcquire() + 1) % NUM_JAM_FRAME_RING_SLOTS);
+
+    return true;
+}
+
+/**
+ * @brief CJamFrameRing::PutDisconnect Queue the disconnection of the client (producer only)
+ * @return false if the ring is full
+ */
+bool CJamFrameRing::PutDisconnect(const qint64 frame)
+{
+    SFrame* slot = NextPutSlot();
+
+    if (slot == nullptr)
+    {
+        return false;
+    }
+
+    slot->frame            = frame;
+    slot->numAudioChannels = 0;
+
+    putPos.storeRelease((putPos.loadAcquire() + 1) % NUM_JAM_FRAME_RING_SLOTS);
+
+    return true;
+}
+
+/**
+ * @brief CJamFrameRing::Peek Get the oldest queued frame (consumer only)
+ * @return the frame or nullptr if the ring is empty
+ */
+const CJamFrameRing::SFrame* CJamFrameRing::Peek()
+{
+    const int curGetPos = getPos.loadAcquire();
+
+    if (curGetPos == putPos.loadAcquire())
+    {
+        return nullptr;
+    }
+
+    return &frames[curGetPos];
+}
+
+/**
+ * @brief CJamFrameRing::Pop Release the frame returned by Peek() (consumer only)
+ */
+void CJamFrameRing::Pop()
+{
+    getPos.storeRelease((getPos.loadAcquire() + 1) % NUM_JAM_FRAME_RING_SLOTS);
+}
+
 /* ********************************************************************************************************
  * CJamClient
  * ********************************************************************************************************/
@@ -36,59 +153,170 @@ using namespace recorder;
  * @param name The client's current name
  * @param address IP and Port
  * @param recordBaseDir Session recording directory
+ * @param compressed true to write an Ogg Opus file instead of a RIFF WAVE file
  *
- * Creates a file for the raw PCM data and sets up a QDataStream to which to write received frames.
- * The data is stored Little Endian.
+ * Creates a file for the PCM data and sets up a QDataStream (or an Ogg Opus encoder) to which to write received frames.
+ * The WAVE data is stored Little Endian.
  */
-CJamClient::CJamClient(const qint64 frame, const int _numChannels, const QString name, const CHostAddress address, const QDir recordBaseDir) :
+CJamClient::CJamClient(const qint64 frame, const int _numChannels, const QString name, const CHostAddress address, const QDir recordBaseDir, const bool compressed) :
     startFrame (frame),
     numChannels (static_cast<uint16_t>(_numChannels)),
     name (name),
-    address (address)
+    address (address),
+    out (nullptr),
+    opusOut (nullptr)
 {
+    const QString suffix = compressed ? ".opus" : ".wav";
+
     // At this point we may not have much of a name
     QString fileName = ClientName() + "-" + QString::number(frame) + "-" + QString::number(_numChannels);
     QString affix = "";
-    while (recordBaseDir.exists(fileName + affix + ".wav"))
+    while (recordBaseDir.exists(fileName + affix + suffix))
     {
         affix = affix.length() == 0 ? "_1" : "_" + QString::number(affix.remove(0, 1).toInt() + 1);
     }
-    fileName = fileName + affix + ".wav";
+    fileName = fileName + affix + suffix;
 
     wavFile = new QFile(recordBaseDir.absoluteFilePath(fileName));
     if (!wavFile->open(QFile::OpenMode(QIODevice::OpenModeFlag::ReadWrite))) // need to allow rewriting headers
     {
-        throw new std::runtime_error( ("Could not write to WAV file "  + wavFile->fileName()).toStdString() );
+        throw new std::runtime_error( ("Could not write to recording file "  + wavFile->fileName()).toStdString() );
+    }
+
+    if (compressed)
+    {
+        opusOut = new COggOpusStream(wavFile, numChannels);
+    }
+    else
+    {
+        out = new CWaveStream(wavFile, numChannels);
     }
-    out = new CWaveStream(wavFile, numChannels);
 
     filename = wavFile->fileName();
+
+    writeBuffer.Init(JAM_CLIENT_WRITE_BUFFER_SAMPLES);
 }
 
 /**
  * @brief CJamClient::Frame Handle a frame of PCM data from a client connected to the server
  * @param _name The client's current name
  * @param pcm The PCM data
+ *
+ * The samples are collected in the write buffer which is written to the file in one block when it is full.
  */
-void CJamClient::Frame(const QString _name, const CVector<int16_t>& pcm, int iServerFrameSizeSamples)
+void CJamClient::Frame(const QString& _name, const int16_t* pcm, int iServerFrameSizeSamples)
 {
-    name = _name;
+    if (name != _name)
+    {
+        name = _name;
+    }
+
+    const int numSamples = numChannels * iServerFrameSizeSamples;
 
-    for(int i = 0; i < numChannels * iServerFrameSizeSamples; i++)
+    if (writeBufferFill + numSamples > writeBuffer.Size())
     {
-        *out << pcm[i];
+        Flush();
     }
 
+    std::copy(pcm, pcm + numSamples, writeBuffer.begin() + writeBufferFill);
+    writeBufferFill += numSamples;
+
     frameCount++;
 }
 
+/**
+ * @brief CJamClient::Silence Fill frames which were dropped with silence to keep the tracks aligned
+ * @param numFrames number of frames
+ */
+void CJamClient::Silence(const qint64 numFrames, int iServerFrameSizeSamples)
+{
+    const int numSamples = numChannels * iServerFrameSizeSamples;
+
+    for (qint64 frame = 0; frame < numFrames; frame++)
+    {
+        if (writeBufferFill + numSamples > writeBuffer.Size())
+        {
+            Flush();
+        }
+
+        std::fill(writeBuffer.begin() + writeBufferFill, writeBuffer.begin() + writeBufferFill + numSamples, 0);
+        writeBufferFill += numSamples;
+
+        frameCount++;
+    }
+}
+
+/**
+ * @brief CJamClient::Flush Write the buffered samples to the file
+ */
+void CJamClient::Flush()
+{
+    if (writeBufferFill == 0)
+    {
+        return;
+    }
+
+    if (opusOut != nullptr)
+    {
+        opusOut->write(&writeBuffer[0], writeBufferFill);
+    }
+    else
+    {
+#if Q_BYTE_ORDER == Q_BIG_ENDIAN
+        // the WAV data is stored Little Endian
+        for (int i = 0; i < writeBufferFill; i++)
+        {
+            writeBuffer[i] = qToLittleEndian(writeBuffer[i]);
+        }
+#endif
+        out->writeRawData(reinterpret_cast<const char*>(&writeBuffer[0]), writeBufferFill * static_cast<int>(sizeof(int16_t)));
+    }
+
+    writeBufferFill = 0;
+}
+
+/**
+ * @brief CJamClient::Checkpoint Write the buffered samples and make the file valid up to this point
+ *
+ * The RIFF and data chunk sizes of a WAVE file are updated and the pending Ogg page is written, so
+ * that the file can be used without a recovery pass if the server stops abruptly (an Ogg Opus file
+ * only loses the samples of the last partial 20 ms frame).
+ */
+void CJamClient::Checkpoint()
+{
+    Flush();
+
+    if (out != nullptr)
+    {
+        static_cast<CWaveStream*>(out)->writeSizes();
+    }
+
+    if (opusOut != nullptr)
+    {
+        opusOut->flush();
+    }
+
+    wavFile->flush();
+}
+
 /**
  * @brief CJamClient::Disconnect Clean up after a disconnected client
  */
 void CJamClient::Disconnect()
 {
-    static_cast<CWaveStream*>(out)->finalise();
-    out = nullptr;
+    Flush();
+
+    if (opusOut != nullptr)
+    {
+        opusOut->finalise();
+        delete opusOut;
+        opusOut = nullptr;
+    }
+    else
+    {
+        static_cast<CWaveStream*>(out)->finalise();
+        out = nullptr;
+    }
 
     wavFile->close();
 
@@ -103,11 +331,14 @@ void CJamClient::Disconnect()
 /**
  * @brief CJamSession::CJamSession Construct a new jam recording session
  * @param recordBaseDir The recording base directory
+ * @param compressed true to record Ogg Opus files instead of RIFF WAVE files
  *
  * Each session is stored into its own subdirectory of the recording base directory.
  */
-CJamSession::CJamSession(QDir recordBaseDir) :
+CJamSession::CJamSession(QDir recordBaseDir, const bool compressed) :
     sessionDir (QDir(recordBaseDir.absoluteFilePath("Jam-" + QDateTime().currentDateTimeUtc().toString("yyyyMMdd-HHmmsszzz")))),
+    compressed (compressed),
+    firstFrame (-1),
     currentFrame (0),
     vecptrJamClients (MAX_NUM_CHANNELS),
     jamClientConnections()
@@ -140,6 +371,11 @@ CJamSession::CJamSession(QDir recordBaseDir) :
  */
 void CJamSession::DisconnectClient(int iChID)
 {
+    if (vecptrJamClients[iChID] == nullptr)
+    {
+        return;
+    }
+
     vecptrJamClients[iChID]->Disconnect();
 
     jamClientConnections.append(new CJamClientConnection(vecptrJamClients[iChID]->NumAudioChannels(),
@@ -153,8 +389,21 @@ void CJamSession::DisconnectClient(int iChID)
 }
 
 /**
- * @brief CJamSession::Frame Process a frame emited for a client by the server
+ * @brief CJamSession::SetFirstFrame Set the server frame number at which the session starts, if not yet set
+ * @param frame the oldest server frame number queued for any client
+ */
+void CJamSession::SetFirstFrame(const qint64 frame)
+{
+    if (firstFrame < 0)
+    {
+        firstFrame = frame;
+    }
+}
+
+/**
+ * @brief CJamSession::Frame Process a frame queued for a client by the server
  * @param iChID the client channel id
+ * @param frame the server frame number
  * @param name the client name
  * @param address the client IP and port number
  * @param numAudioChannels the client number of audio channels
@@ -163,14 +412,19 @@ void CJamSession::DisconnectClient(int iChID)
  * Manages changes that affect how the recording is stored - i.e. if the number of audio channels changes, we need a new file.
  * Files are grouped by IP and port number, so if either of those change for a connection, we also start a new file.
  *
- * Also manages the overall current frame counter for the session.
+ * The current frame of the session is taken from the server frame number, as the frames of the clients
+ * are not processed in server order.
  */
-void CJamSession::Frame(const int iChID, const QString name, const CHostAddress address, const int numAudioChannels, const CVector<int16_t> data, int iServerFrameSizeSamples)
+void CJamSession::Frame(const int iChID, const qint64 frame, const QString& name, const CHostAddress& address, const int numAudioChannels, const int16_t* data, int iServerFrameSizeSamples)
 {
+    SetFirstFrame(frame);
+
+    currentFrame = frame - firstFrame;
+
     if (vecptrJamClients[iChID] == nullptr)
     {
         // then we have not seen this client this session
-        vecptrJamClients[iChID] = new CJamClient(currentFrame, numAudioChannels, name, address, sessionDir);
+        vecptrJamClients[iChID] = new CJamClient(currentFrame, numAudioChannels, name, address, sessionDir, compressed);
     }
     else if (numAudioChannels != vecptrJamClients[iChID]->NumAudioChannels()
              || address.InetAddr != vecptrJamClients[iChID]->ClientAddress().InetAddr
@@ -183,7 +437,7 @@ void CJamSession::Frame(const int iChID, const QString name, const CHostAddress
         }
         else
         {
-            vecptrJamClients[iChID] = new CJamClient(currentFrame, numAudioChannels, name, address, sessionDir);
+            vecptrJamClients[iChID] = new CJamClient(currentFrame, numAudioChannels, name, address, sessionDir, compressed);
         }
     }
 
@@ -193,12 +447,41 @@ void CJamSession::Frame(const int iChID, const QString name, const CHostAddress
         return;
     }
 
+    // Frames dropped because the recorder thread fell behind are replaced by silence
+    const qint64 missingFrames = currentFrame - (vecptrJamClients[iChID]->StartFrame() + vecptrJamClients[iChID]->FrameCount());
+    if (missingFrames > 0)
+    {
+        vecptrJamClients[iChID]->Silence(missingFrames, iServerFrameSizeSamples);
+    }
+
     vecptrJamClients[iChID]->Frame(name, data, iServerFrameSizeSamples);
+}
 
-    // If _any_ connected client frame steps past currentFrame, increase currentFrame
-    if (vecptrJamClients[iChID]->StartFrame() + vecptrJamClients[iChID]->FrameCount() > currentFrame)
+/**
+ * @brief CJamSession::Flush Write the buffered samples of all clients
+ */
+void CJamSession::Flush()
+{
+    for (int iChID = 0; iChID < vecptrJamClients.size(); iChID++)
+    {
+        if (vecptrJamClients[iChID] != nullptr)
+        {
+            vecptrJamClients[iChID]->Flush();
+        }
+    }
+}
+
+/**
+ * @brief CJamSession::Checkpoint Update the files of all connected clients
+ */
+void CJamSession::Checkpoint()
+{
+    for (int iChID = 0; iChID < vecptrJamClients.size(); iChID++)
     {
-        currentFrame++;
+        if (vecptrJamClients[iChID] != nullptr)
+        {
+            vecptrJamClients[iChID]->Checkpoint();
+        }
     }
 }
 
@@ -220,11 +503,26 @@ void CJamSession::End()
 /**
  * @brief CJamSession::Tracks Retrieve a map of (latest) client name to connection items
  * @return a map of (latest) client name to connection items
+ *
+ * The clients which are still connected are included with their current length.
  */
 QMap<QString, QList<STrackItem>> CJamSession::Tracks()
 {
     QMap<QString, QList<STrackItem>> tracks;
 
+    for (int iChID = 0; iChID < vecptrJamClients.size(); iChID++)
+    {
+        if (vecptrJamClients[iChID] != nullptr)
+        {
+            tracks[vecptrJamClients[iChID]->ClientName()].append(STrackItem(
+                vecptrJamClients[iChID]->NumAudioChannels(),
+                vecptrJamClients[iChID]->StartFrame(),
+                vecptrJamClients[iChID]->FrameCount(),
+                vecptrJamClients[iChID]->FileName()
+            ));
+        }
+    }
+
     for (int i = 0; i < jamClientConnections.count(); i++ )
     {
         STrackItem track (
@@ -255,7 +553,7 @@ QMap<QString, QList<STrackItem>> CJamSession::TracksFromSessionDir(const QString
     QMap<QString, QList<STrackItem>> tracks;
 
     const QDir sessionDir(sessionDirName);
-    foreach(auto entry, sessionDir.entryList({ "*.pcm" }))
+    foreach(auto entry, sessionDir.entryList({ "*.wav", "*.opus" }))
     {
 
         auto split = entry.split(".")[0].split("-");
@@ -272,7 +570,16 @@ QMap<QString, QList<STrackItem>> CJamSession::TracksFromSessionDir(const QString
         }
 
         QFileInfo fiEntry(sessionDir.absoluteFilePath(entry));
-        qint64 length = fiEntry.size() / numChannels.toInt() / iServerFrameSizeSamples;
+        qint64 length;
+        if (fiEntry.suffix() == "opus")
+        {
+            length = COggOpusStream::lengthSamples(fiEntry.absoluteFilePath()) / iServerFrameSizeSamples;
+        }
+        else
+        {
+            // 44 bytes of RIFF WAVE headers, 16 bit samples
+            length = (fiEntry.size() - 44) / static_cast<qint64>(sizeof(int16_t)) / numChannels.toInt() / iServerFrameSizeSamples;
+        }
 
         STrackItem track (
                     numChannels.toInt(),
@@ -318,69 +625,120 @@ void CJamRecorder::Init( const CServer* server,
                       this, SLOT( OnEnd() ),
                       Qt::ConnectionType::QueuedConnection );
 
-    QObject::connect( (const QObject *)server, SIGNAL ( ClientDisconnected ( int ) ),
-                      this, SLOT( OnDisconnected ( int ) ),
-                      Qt::ConnectionType::QueuedConnection );
-
-    qRegisterMetaType<CVector<int16_t>>();
-    QObject::connect( (const QObject *)server, SIGNAL ( AudioFrame( const int, const QString, const CHostAddress, const int, const CVector<int16_t> ) ),
-                      this, SLOT(  OnFrame (const int, const QString, const CHostAddress, const int, const CVector<int16_t> ) ),
-                      Qt::ConnectionType::QueuedConnection );
-
     QObject::connect( QCoreApplication::instance(),
                       SIGNAL ( aboutToQuit() ),
                       this, SLOT( OnAboutToQuit() ) );
 
     iServerFrameSizeSamples = _iServerFrameSizeSamples;
 
+    // the frames and disconnections are handed over by the server through the
+    // per-channel rings which are drained periodically by the recorder thread
+    for ( int iChID = 0; iChID < MAX_NUM_CHANNELS; iChID++ )
+    {
+        frameRings[iChID].Init ( iServerFrameSizeSamples );
+    }
+
+    QObject::connect( &drainTimer, SIGNAL ( timeout() ),
+                      this, SLOT( OnDrainTimer() ) );
+
+    QObject::connect( &checkpointTimer, SIGNAL ( timeout() ),
+                      this, SLOT( OnCheckpointTimer() ) );
+
+    // the active timers are moved to the recorder thread with this object
+    drainTimer.start ( JAM_FRAME_RING_DRAIN_INTERVAL_MS );
+    checkpointTimer.start ( JAM_SESSION_CHECKPOINT_INTERVAL_MS );
+
     thisThread = new QThread();
     moveToThread ( thisThread );
+
+    // the signal is emitted by the new thread itself
+    QObject::connect( thisThread, SIGNAL ( started() ),
+                      this, SLOT( OnThreadStarted() ),
+                      Qt::ConnectionType::DirectConnection );
+
     thisThread->start();
 }
 
+void CJamRecorder::OnThreadStarted()
+{
+    CRealTimeUtil::ApplyToCurrentThread( "recorder", 0, threadCPUs );
+}
+
 
 /**
  * @brief CJamRecorder::OnStart Start up tasks when the first client connects
  */
 void CJamRecorder::OnStart() {
     // Ensure any previous cleaning up has been done.
-    OnEnd();
+    EndSession();
 
-    currentSession = new CJamSession( recordBaseDir );
+    currentSession = new CJamSession( recordBaseDir, compressed );
     isRecording = true;
 }
 
 /**
- * @brief CJamRecorder::OnEnd Finalise the recording and emit the Reaper RPP file
+ * @brief CJamRecorder::OnEnd Write the remaining queued frames and finalise the recording
  */
 void CJamRecorder::OnEnd()
+{
+    Drain();
+    EndSession();
+}
+
+/**
+ * @brief CJamRecorder::EndSession Finalise the recording and emit the Reaper RPP file
+ */
+void CJamRecorder::EndSession()
 {
     if ( isRecording )
     {
         isRecording = false;
         currentSession->End();
 
-        QString reaperProjectFileName = currentSession->SessionDir().filePath(currentSession->Name().append(".rpp"));
-        const QFileInfo fi(reaperProjectFileName);
-
-        if (fi.exists())
-        {
-            qWarning() << "CJamRecorder::OnEnd():" << fi.absolutePath() << "exists and will not be overwritten.";
-        }
-        else
-        {
-            QFile outf (reaperProjectFileName);
-            outf.open(QFile::WriteOnly);
-            QTextStream out(&outf);
-            out << CReaperProject( currentSession->Tracks(), iServerFrameSizeSamples ).toString() << endl;
-            qDebug() << "Session RPP:" << reaperProjectFileName;
-        }
+        WriteReaperProject();
+        qDebug() << "Session RPP:" << currentSession->SessionDir().filePath(currentSession->Name().append(".rpp"));
 
         delete currentSession;
         currentSession = nullptr;
     }
 }
 
+/**
+ * @brief CJamRecorder::WriteReaperProject Write the Reaper RPP file of the current session
+ *
+ * The file is written while the session is running, too, therefore it is replaced atomically.
+ */
+void CJamRecorder::WriteReaperProject()
+{
+    QSaveFile outf (currentSession->SessionDir().filePath(currentSession->Name().append(".rpp")));
+
+    if (!outf.open(QFile::WriteOnly))
+    {
+        qWarning() << "CJamRecorder::WriteReaperProject():" << outf.fileName() << "could not be written.";
+        return;
+    }
+
+    QTextStream out(&outf);
+    out << CReaperProject( currentSession->Tracks(), iServerFrameSizeSamples ).toString() << endl;
+    out.flush();
+
+    outf.commit();
+}
+
+/**
+ * @brief CJamRecorder::OnCheckpointTimer Update the WAVE headers and the RPP file of the running session
+ */
+void CJamRecorder::OnCheckpointTimer()
+{
+    if ( isRecording )
+    {
+        Drain();
+
+        currentSession->Checkpoint();
+        WriteReaperProject();
+    }
+}
+
 void CJamRecorder::OnAboutToQuit()
 {
     OnEnd();
@@ -420,40 +778,71 @@ void CJamRecorder::SessionDirToReaper(QString& strSessionDirName, int serverFram
 }
 
 /**
- * @brief CJamRecorder::OnDisconnected Handle disconnection of a client
- * @param iChID the client channel id
+ * @brief CJamRecorder::OnDrainTimer Handle the frames queued by the server since the last call
  */
-void CJamRecorder::OnDisconnected(int iChID)
+void CJamRecorder::OnDrainTimer()
 {
-    if ( !isRecording )
-    {
-        qWarning() << "CJamRecorder::OnDisconnected: channel" << iChID << "disconnected but not recording";
-    }
-    if ( currentSession == nullptr )
-    {
-        qWarning() << "CJamRecorder::OnDisconnected: channel" << iChID << "disconnected but no currentSession";
-        return;
-    }
-    currentSession->DisconnectClient(iChID);
+    Drain();
 }
 
 /**
- * @brief CJamRecorder::OnFrame Handle a frame emited for a client by the server
- * @param iChID the client channel id
- * @param name the client name
- * @param address the client IP and port number
- * @param numAudioChannels the client number of audio channels
- * @param data the frame data
+ * @brief CJamRecorder::Drain Process all frames and disconnections queued in the channel rings
  *
- * Ensures recording has started.
+ * Ensures recording has started when a frame is available.
  */
-void CJamRecorder::OnFrame(const int iChID, const QString name, const CHostAddress address, const int numAudioChannels, const CVector<int16_t> data)
+void CJamRecorder::Drain()
 {
-    // Make sure we are ready
-    if ( !isRecording )
+    // the channels are drained in index order, so a new session must start with the
+    // oldest queued frame of all channels (the oldest frame of a ring is at its head)
+    qint64 oldestFrame = -1;
+
+    for ( int iChID = 0; iChID < MAX_NUM_CHANNELS; iChID++ )
     {
-        OnStart();
+        const CJamFrameRing::SFrame* frame = frameRings[iChID].Peek();
+
+        if ( ( frame != nullptr ) && ( ( oldestFrame < 0 ) || ( frame->frame < oldestFrame ) ) )
+        {
+            oldestFrame = frame->frame;
+        }
     }
 
-    currentSession->Frame( iChID, name, address, numAudioChannels, data, iServerFrameSizeSamples );
+    for ( int iChID = 0; iChID < MAX_NUM_CHANNELS; iChID++ )
+    {
+        const CJamFrameRing::SFrame* frame;
+
+        while ( ( frame = frameRings[iChID].Peek() ) != nullptr )
+        {
+            if ( frame->numAudioChannels == 0 )
+            {
+                if ( currentSession == nullptr )
+                {
+                    qWarning() << "CJamRecorder::Drain: channel" << iChID << "disconnected but no currentSession";
+                }
+                else
+                {
+                    currentSession->DisconnectClient ( iChID );
+                }
+            }
+            else
+            {
+                // Make sure we are ready
+                if ( !isRecording )
+                {
+                    OnStart();
+                }
+
+                currentSession->SetFirstFrame ( oldestFrame );
+                currentSession->Frame ( iChID, frame->frame, frame->name, frame->address, frame->numAudioChannels, frame->data, iServerFrameSizeSamples );
+            }
+
+            frameRings[iChID].Pop();
+        }
+
+        const int numDropped = frameRings[iChID].TakeNumDropped();
+
+        if ( numDropped > 0 )
+        {
+            qWarning() << "CJamRecorder::Drain: channel" << iChID << "dropped" << numDropped << "frames";
+        }
+    }
 }
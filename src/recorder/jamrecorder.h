@@ -25,16 +25,76 @@
 
 #include <QDir>
 #include <QFile>
+#include <QSaveFile>
 #include <QDateTime>
+#include <QTimer>
+#include <QAtomicInt>
+#include <QtEndian>
 
 #include "../util.h"
 #include "../channel.h"
 
 #include "creaperproject.h"
 #include "cwavestream.h"
+#include "coggopusstream.h"
+
+// number of frames each per-channel ring can hold (must cover more than one
+// drain interval, also for the small 64 samples frames)
+#define NUM_JAM_FRAME_RING_SLOTS 256
+
+// interval in which the recorder thread drains the frame rings
+#define JAM_FRAME_RING_DRAIN_INTERVAL_MS 50
+
+// size of the per-client write buffer (in samples)
+#define JAM_CLIENT_WRITE_BUFFER_SAMPLES 32768
+
+// interval in which the file headers and the RPP file of a running session are updated
+#define JAM_SESSION_CHECKPOINT_INTERVAL_MS 10000
 
 namespace recorder {
 
+/**
+ * @brief Lock-free single producer/single consumer ring of recorded audio frames of one channel
+ *
+ * The server timer thread puts the frames, the recorder thread drains them. All memory
+ * is allocated in Init() so that putting a frame only copies the samples.
+ */
+class CJamFrameRing
+{
+public:
+    struct SFrame
+    {
+        qint64         frame;            // server frame number
+        int            numAudioChannels; // zero marks the disconnection of the client
+        QString        name;
+        CHostAddress   address;
+        int16_t*       data;
+    };
+
+    CJamFrameRing() : frameSizeSamples(0), putPos(0), getPos(0), numDropped(0) {}
+
+    void Init(const int _frameSizeSamples);
+
+    // producer
+    bool Put(const qint64 frame, const QString& name, const CHostAddress& address, const int numAudioChannels, const CVector<int16_t>& data);
+    bool PutDisconnect(const qint64 frame);
+
+    // consumer
+    const SFrame* Peek();
+    void          Pop();
+    int           TakeNumDropped() { return numDropped.fetchAndStoreOrdered(0); }
+
+private:
+    SFrame* NextPutSlot();
+
+    int              frameSizeSamples;
+    SFrame           frames[NUM_JAM_FRAME_RING_SLOTS];
+    CVector<int16_t> samples;
+    QAtomicInt       putPos;
+    QAtomicInt       getPos;
+    QAtomicInt       numDropped;
+};
+
 class CJamClientConnection : public QObject
 {
     Q_OBJECT
@@ -68,9 +128,15 @@ class CJamClient : public QObject
     Q_OBJECT
 
 public:
-    CJamClient(const qint64 frame, const int numChannels, const QString name, const CHostAddress address, const QDir recordBaseDir);
+    CJamClient(const qint64 frame, const int numChannels, const QString name, const CHostAddress address, const QDir recordBaseDir, const bool compressed);
+
+    void Frame(const QString& name, const int16_t* pcm, int iServerFrameSizeSamples);
 
-    void Frame(const QString name, const CVector<int16_t>& pcm, int iServerFrameSizeSamples);
+    void Silence(const qint64 numFrames, int iServerFrameSizeSamples);
+
+    void Flush();
+
+    void Checkpoint();
 
     void Disconnect();
 
@@ -95,7 +161,11 @@ private:
           QString      filename;
           QFile*       wavFile;
           QDataStream* out;
+          COggOpusStream* opusOut;
           qint64       frameCount = 0;
+
+          CVector<int16_t> writeBuffer;
+          int              writeBufferFill = 0;
 };
 
 class CJamSession : public QObject
@@ -104,9 +174,13 @@ class CJamSession : public QObject
 
 public:
 
-    CJamSession(QDir recordBaseDir);
+    CJamSession(QDir recordBaseDir, const bool compressed);
+
+    void Frame(const int iChID, const qint64 frame, const QString& name, const CHostAddress& address, const int numAudioChannels, const int16_t* data, int iServerFrameSizeSamples);
+
+    void Flush();
 
-    void Frame(const int iChID, const QString name, const CHostAddress address, const int numAudioChannels, const CVector<int16_t> data, int iServerFrameSizeSamples);
+    void Checkpoint();
 
     void End();
 
@@ -120,13 +194,17 @@ public:
 
     void DisconnectClient(int iChID);
 
+    void SetFirstFrame(const qint64 frame);
+
     static QMap<QString, QList<STrackItem>> TracksFromSessionDir(const QString& name, int iServerFrameSizeSamples);
 
 private:
     CJamSession();
 
     const QDir sessionDir;
+    const bool compressed;
 
+    qint64 firstFrame;
     qint64 currentFrame;
     QVector<CJamClient*> vecptrJamClients;
     QList<CJamClientConnection*> jamClientConnections;
@@ -137,14 +215,43 @@ class CJamRecorder : public QObject
     Q_OBJECT
 
 public:
-    CJamRecorder ( const QString recordingDirName ) :
-        recordBaseDir ( recordingDirName ),
-        isRecording   ( false )
+    CJamRecorder ( const QString recordingDirName, const bool _compressed = false ) :
+        recordBaseDir   ( recordingDirName ),
+        compressed      ( _compressed ),
+        isRecording     ( false ),
+        currentSession  ( nullptr ),
+        producerFrame   ( 0 ),
+        drainTimer      ( this ),
+        checkpointTimer ( this )
     {
     }
 
     void Init( const CServer* server, const int _iServerFrameSizeSamples );
 
+    /**
+     * @brief Sets the CPU affinity of the recorder thread, must be called before Init()
+     */
+    void SetThreadCPUs( const QString& cpus ) { threadCPUs = cpus; }
+
+    /**
+     * @brief Called by the server timer thread for each connected client in a frame (lock-free)
+     */
+    void PutFrame ( const int iChID, const QString& name, const CHostAddress& address, const int numAudioChannels, const CVector<int16_t>& data )
+    {
+        // on a ring overrun the frame is dropped and the recorder thread fills the gap with silence
+        frameRings[iChID].Put ( producerFrame, name, address, numAudioChannels, data );
+    }
+
+    /**
+     * @brief Called by the server timer thread when a client disconnected (lock-free)
+     */
+    void PutDisconnect ( const int iChID ) { frameRings[iChID].PutDisconnect ( producerFrame ); }
+
+    /**
+     * @brief Called by the server timer thread after all frames of the current frame were put
+     */
+    void EndOfFrame() { producerFrame++; }
+
     static void SessionDirToReaper( QString& strSessionDirName, int serverFrameSizeSamples );
 
 public slots:
@@ -164,27 +271,40 @@ public slots:
     void OnAboutToQuit();
 
     /**
-     * @brief Raised when an existing client leaves the server.
-     * @param iChID channel number of client
+     * @brief Raised periodically to write the frames queued by the server
+     */
+    void OnDrainTimer();
+
+    /**
+     * @brief Raised periodically to make the files of the running session readable after a crash
      */
-    void OnDisconnected ( int iChID );
+    void OnCheckpointTimer();
 
     /**
-     * @brief Raised when a frame of data is available to process
+     * @brief Raised in the recorder thread when it has started
      */
-    void OnFrame ( const int iChID, const QString name, const CHostAddress address, const int numAudioChannels, const CVector<int16_t> data );
+    void OnThreadStarted();
 
 private:
+    void Drain();
+    void EndSession();
+    void WriteReaperProject();
+
     QDir recordBaseDir;
+    bool compressed;
 
     bool         isRecording;
     CJamSession* currentSession;
     int          iServerFrameSizeSamples;
 
+    // written by the server timer thread only
+    qint64        producerFrame;
+    CJamFrameRing frameRings[MAX_NUM_CHANNELS];
+
+    QTimer   drainTimer;
+    QTimer   checkpointTimer;
     QThread* thisThread;
+    QString  threadCPUs;
 };
 
 }
-
-Q_DECLARE_METATYPE(int16_t)
-Q_DECLARE_METATYPE(CVector<int16_t>)
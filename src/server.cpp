@@ -115,7 +115,10 @@ void CHighPrecisionTimer::OnTimer()
 }
 #else // Mac and Linux
 CHighPrecisionTimer::CHighPrecisionTimer ( const bool bUseDoubleSystemFrameSize ) :
-    bRun ( false )
+    bRun                  ( 0 ),
+    iLastWakeUpLatenessNs ( 0 ),
+    iFIFOPriority         ( 0 ),
+    strCPUs               ( "" )
 {
     // calculate delay in ns
     uint64_t iNsDelay;
@@ -136,6 +139,9 @@ CHighPrecisionTimer::CHighPrecisionTimer ( const bool bUseDoubleSystemFrameSize
     struct mach_timebase_info timeBaseInfo;
     mach_timebase_info ( &timeBaseInfo );
 
+    iTimeBaseNumer = timeBaseInfo.numer;
+    iTimeBaseDenom = timeBaseInfo.denom;
+
     Delay = ( iNsDelay * (uint64_t) timeBaseInfo.denom ) /
         (uint64_t) timeBaseInfo.numer;
 #else
@@ -147,10 +153,10 @@ CHighPrecisionTimer::CHighPrecisionTimer ( const bool bUseDoubleSystemFrameSize
 void CHighPrecisionTimer::Start()
 {
     // only start if not already running
-    if ( !bRun )
+    if ( bRun.loadAcquire() == 0 )
     {
         // set run flag
-        bRun = true;
+        bRun.storeRelease ( 1 );
 
         // set initial end time
 #if defined ( __APPLE__ ) || defined ( __MACOSX )
@@ -174,7 +180,7 @@ void CHighPrecisionTimer::Start()
 void CHighPrecisionTimer::Stop()
 {
     // set flag so that thread can leave the main loop
-    bRun = false;
+    bRun.storeRelease ( 0 );
 
     // give thread some time to terminate
     wait ( 5000 );
@@ -182,15 +188,15 @@ void CHighPrecisionTimer::Stop()
 
 void CHighPrecisionTimer::run()
 {
+    // the Qt thread priority does not give real-time scheduling on Linux
+    CRealTimeUtil::ApplyToCurrentThread ( "timer", iFIFOPriority, strCPUs );
+
     // loop until the thread shall be terminated
-    while ( bRun )
+    while ( bRun.loadAcquire() != 0 )
     {
-        // call processing routine by fireing signal
-
-// TODO by emit a signal we leave the high priority thread -> maybe use some
-//      other connection type to have something like a true callback, e.g.
-//      "Qt::DirectConnection" -> Can this work?
-
+        // call processing routine by fireing signal (the frames are processed
+        // in the thread of the server object which serializes the frame
+        // processing with the protocol and connection handling)
         emit timeout();
 
         // now wait until the next buffer shall be processed (we
@@ -199,6 +205,13 @@ void CHighPrecisionTimer::run()
 #if defined ( __APPLE__ ) || defined ( __MACOSX )
         mach_wait_until ( NextEnd );
 
+        // store the wake-up lateness for the timing statistics
+        const uint64_t iWakeUpTime = mach_absolute_time();
+
+        iLastWakeUpLatenessNs.storeRelease ( static_cast<int> ( std::min<uint64_t> (
+            ( iWakeUpTime > NextEnd ) ? ( ( iWakeUpTime - NextEnd ) * iTimeBaseNumer ) / iTimeBaseDenom : 0,
+            INT_MAX ) ) );
+
         NextEnd += Delay;
 #else
         clock_nanosleep ( CLOCK_MONOTONIC,
@@ -206,6 +219,17 @@ void CHighPrecisionTimer::run()
                           &NextEnd,
                           NULL );
 
+        // store the wake-up lateness for the timing statistics
+        timespec WakeUpTime;
+        clock_gettime ( CLOCK_MONOTONIC, &WakeUpTime );
+
+        const int64_t iLatenessNs =
+            static_cast<int64_t> ( WakeUpTime.tv_sec - NextEnd.tv_sec ) * 1000000000 +
+            ( WakeUpTime.tv_nsec - NextEnd.tv_nsec );
+
+        iLastWakeUpLatenessNs.storeRelease ( static_cast<int> (
+            std::max<int64_t> ( 0, std::min<int64_t> ( iLatenessNs, INT_MAX ) ) ) );
+
         NextEnd.tv_nsec += Delay;
         if ( NextEnd.tv_nsec >= 1000000000L )
         {
@@ -233,14 +257,27 @@ CServer::CServer ( const int          iNewMaxNumChan,
                    const bool         bNCentServPingServerInList,
                    const bool         bNDisconnectAllClientsOnQuit,
                    const bool         bNUseDoubleSystemFrameSize,
-                   const ELicenceType eNLicenceType ) :
+                   const ELicenceType eNLicenceType,
+                   const int          iNNumMixThreads,
+                   const bool         bNUseReferenceMix,
+                   const bool         bNUseBusMix,
+                   const CMixKernels::EKernelType eNMixKernelType,
+                   const bool         bNRecordCompressed,
+                   const int          iNRTPriority,
+                   const QString&     strNTimerCPUs,
+                   const QString&     strNSocketCPUs,
+                   const QString&     strNRecorderCPUs ) :
     bUseDoubleSystemFrameSize   ( bNUseDoubleSystemFrameSize ),
+    bUseReferenceMix            ( bNUseReferenceMix ),
+    bUseBusMix                  ( bNUseBusMix ),
     iMaxNumChannels             ( iNewMaxNumChan ),
     Socket                      ( this, iPortNumber ),
     Logging                     ( iMaxDaysHistory ),
-    JamRecorder                 ( strRecordingDirName ),
+    JamRecorder                 ( strRecordingDirName, bNRecordCompressed ),
     bEnableRecording            ( !strRecordingDirName.isEmpty() ),
     bWriteStatusHTMLFile        ( false ),
+    iTimingStatsUpdateNumFrames ( 1 ),
+    iTimingStatsFrameCnt        ( 0 ),
     HighPrecisionTimer          ( bNUseDoubleSystemFrameSize ),
     ServerListManager           ( iPortNumber,
                                   strCentralServer,
@@ -252,55 +289,41 @@ CServer::CServer ( const int          iNewMaxNumChan,
     strWelcomeMessage           ( strNewWelcomeMessage ),
     eLicenceType                ( eNLicenceType ),
     bDisconnectAllClientsOnQuit ( bNDisconnectAllClientsOnQuit ),
-    pSignalHandler              ( CSignalHandler::getSingletonP() )
+    pSignalHandler              ( CSignalHandler::getSingletonP() ),
+    iNumMixThreads              ( std::max ( 1, std::min ( iNNumMixThreads, MAX_NUM_MIX_THREADS ) ) ),
+    bMixThreadsRun              ( true ),
+    iMixJobFrame                ( 0 ),
+    iMixJobNumPending           ( 0 ),
+    iMixJobNumClients           ( 0 ),
+    iMixJobNumMixes             ( 0 ),
+    iMixJobNextMix              ( 0 ),
+    iRTPriority                 ( iNRTPriority ),
+    strTimerCPUs                ( strNTimerCPUs ),
+    bRealTimeSettingsApplied    ( false ),
+    SideEffectWorker            ( &Logging )
 {
     int iOpusError;
     int i;
 
-    // create OPUS encoder/decoder for each channel (must be done before
-    // enabling the channels), create a mono and stereo encoder/decoder
-    // for each channel
+    // create the OPUS modes which are shared by all channels, the encoders and
+    // decoders are created on first use of a channel
+    OpusMode = opus_custom_mode_create ( SYSTEM_SAMPLE_RATE_HZ,
+                                         DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES,
+                                         &iOpusError );
+
+    Opus64Mode = opus_custom_mode_create ( SYSTEM_SAMPLE_RATE_HZ,
+                                           SYSTEM_FRAME_SIZE_SAMPLES,
+                                           &iOpusError );
+
+    vecChanIDsToRelease.reserve ( iMaxNumChannels );
+
     for ( i = 0; i < iMaxNumChannels; i++ )
     {
-        // init OPUS -----------------------------------------------------------
-        OpusMode[i] = opus_custom_mode_create ( SYSTEM_SAMPLE_RATE_HZ,
-                                                DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES,
-                                                &iOpusError );
-
-        Opus64Mode[i] = opus_custom_mode_create ( SYSTEM_SAMPLE_RATE_HZ,
-                                                  SYSTEM_FRAME_SIZE_SAMPLES,
-                                                  &iOpusError );
-
-        // init audio encoders and decoders
-        OpusEncoderMono[i]     = opus_custom_encoder_create ( OpusMode[i],   1, &iOpusError ); // mono encoder legacy
-        OpusDecoderMono[i]     = opus_custom_decoder_create ( OpusMode[i],   1, &iOpusError ); // mono decoder legacy
-        OpusEncoderStereo[i]   = opus_custom_encoder_create ( OpusMode[i],   2, &iOpusError ); // stereo encoder legacy
-        OpusDecoderStereo[i]   = opus_custom_decoder_create ( OpusMode[i],   2, &iOpusError ); // stereo decoder legacy
-        Opus64EncoderMono[i]   = opus_custom_encoder_create ( Opus64Mode[i], 1, &iOpusError ); // mono encoder OPUS64
-        Opus64DecoderMono[i]   = opus_custom_decoder_create ( Opus64Mode[i], 1, &iOpusError ); // mono decoder OPUS64
-        Opus64EncoderStereo[i] = opus_custom_encoder_create ( Opus64Mode[i], 2, &iOpusError ); // stereo encoder OPUS64
-        Opus64DecoderStereo[i] = opus_custom_decoder_create ( Opus64Mode[i], 2, &iOpusError ); // stereo decoder OPUS64
-
-        // we require a constant bit rate
-        opus_custom_encoder_ctl ( OpusEncoderMono[i],     OPUS_SET_VBR ( 0 ) );
-        opus_custom_encoder_ctl ( OpusEncoderStereo[i],   OPUS_SET_VBR ( 0 ) );
-        opus_custom_encoder_ctl ( Opus64EncoderMono[i],   OPUS_SET_VBR ( 0 ) );
-        opus_custom_encoder_ctl ( Opus64EncoderStereo[i], OPUS_SET_VBR ( 0 ) );
-
-        // for 64 samples frame size we have to adjust the PLC behavior to avoid loud artifacts
-        opus_custom_encoder_ctl ( Opus64EncoderMono[i],   OPUS_SET_PACKET_LOSS_PERC ( 35 ) );
-        opus_custom_encoder_ctl ( Opus64EncoderStereo[i], OPUS_SET_PACKET_LOSS_PERC ( 35 ) );
-
-        // we want as low delay as possible
-        opus_custom_encoder_ctl ( OpusEncoderMono[i],     OPUS_SET_APPLICATION ( OPUS_APPLICATION_RESTRICTED_LOWDELAY ) );
-        opus_custom_encoder_ctl ( OpusEncoderStereo[i],   OPUS_SET_APPLICATION ( OPUS_APPLICATION_RESTRICTED_LOWDELAY ) );
-        opus_custom_encoder_ctl ( Opus64EncoderMono[i],   OPUS_SET_APPLICATION ( OPUS_APPLICATION_RESTRICTED_LOWDELAY ) );
-        opus_custom_encoder_ctl ( Opus64EncoderStereo[i], OPUS_SET_APPLICATION ( OPUS_APPLICATION_RESTRICTED_LOWDELAY ) );
-
-        // set encoder low complexity for legacy 128 samples frame size
-        opus_custom_encoder_ctl ( OpusEncoderMono[i],   OPUS_SET_COMPLEXITY ( 1 ) );
-        opus_custom_encoder_ctl ( OpusEncoderStereo[i], OPUS_SET_COMPLEXITY ( 1 ) );
-
+        for ( int iType = 0; iType < NUM_OPUS_CODER_TYPES; iType++ )
+        {
+            OpusEncoders[i][iType] = nullptr;
+            OpusDecoders[i][iType] = nullptr;
+        }
 
         // init double-to-normal frame size conversion buffers -----------------
         // use worst case memory initialization to avoid allocating memory in
@@ -334,24 +357,57 @@ CServer::CServer ( const int          iNewMaxNumChan,
     // do not know the required sizes for the vectors, we allocate memory for
     // the worst case here:
 
-    // we always use stereo audio buffers (which is the worst case)
-    vecsSendData.Init ( 2 /* stereo */ * DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES /* worst case buffer size */ );
+    // we always use stereo audio buffers (which is the worst case), each mix
+    // thread needs its own send and coded data buffers
+    vecvecfMixData.Init    ( iNumMixThreads );
+    vecvecsSendData.Init   ( iNumMixThreads );
+    vecvecbyCodedData.Init ( iNumMixThreads );
+
+    for ( i = 0; i < iNumMixThreads; i++ )
+    {
+        vecvecfMixData[i].Init    ( 2 /* stereo */ * DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES /* worst case buffer size */ );
+        vecvecsSendData[i].Init   ( 2 /* stereo */ * DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES /* worst case buffer size */ );
+        vecvecbyCodedData[i].Init ( MAX_SIZE_BYTES_NETW_BUF );
+    }
 
     // allocate worst case memory for the temporary vectors
     vecChanIDsCurConChan.Init          ( iMaxNumChannels );
     vecvecdGains.Init                  ( iMaxNumChannels );
+    vecvecdGainSnapshot.Init           ( iMaxNumChannels );
+    vecGainSnapshotVersion.Init        ( iMaxNumChannels, -1 ); // invalid version, forces the first copy
+    vecGainMatrixChanIDs.Init          ( iMaxNumChannels, INVALID_CHANNEL_ID );
+    iGainMatrixNumClients = 0;
+    bGainMatrixFadeIn     = false;
     vecvecsData.Init                   ( iMaxNumChannels );
     vecNumAudioChannels.Init           ( iMaxNumChannels );
     vecNumFrameSizeConvBlocks.Init     ( iMaxNumChannels );
     vecUseDoubleSysFraSizeConvBuf.Init ( iMaxNumChannels );
     vecAudioComprType.Init             ( iMaxNumChannels );
+    vecSourceIsSilent.Init             ( iMaxNumChannels, 0 );
+    vecGainRowHash.Init                ( iMaxNumChannels );
+    vecSharedMixLeader.Init            ( iMaxNumChannels );
+    vecSharedMixClientIdx.Init         ( iMaxNumChannels );
+    vecEncoderStreamChanID.Init        ( iMaxNumChannels, INVALID_CHANNEL_ID );
+    vecEncoderStreamType.Init          ( iMaxNumChannels, INVALID_OPUS_CODER_TYPE );
+    vecdBusGains.Init                  ( iMaxNumChannels );
+    vecUseBusMix.Init                  ( iMaxNumChannels, 0 );
+    vecBusNumDeltas.Init               ( iMaxNumChannels, 0 );
+    vecvecBusDeltaIdx.Init             ( iMaxNumChannels );
+    vecvecfBusDeltaGains.Init          ( iMaxNumChannels );
+    vecfBusMixMono.Init                ( DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES );
+    vecfBusMixStereo.Init              ( 2 /* stereo */ * DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES );
 
     for ( i = 0; i < iMaxNumChannels; i++ )
     {
         // init vectors storing information of all channels
-        vecvecdGains[i].Init ( iMaxNumChannels );
+        vecvecdGains[i].Init        ( iMaxNumChannels );
+        vecvecdGainSnapshot[i].Init ( MAX_NUM_CHANNELS, 1.0 );
 
-        // we always use stereo audio buffers (see "vecsSendData")
+        // a row of the bus mix deltas has at most one entry per client
+        vecvecBusDeltaIdx[i].Init    ( iMaxNumChannels );
+        vecvecfBusDeltaGains[i].Init ( iMaxNumChannels );
+
+        // we always use stereo audio buffers (see "vecvecsSendData")
         vecvecsData[i].Init ( 2 /* stereo */ * DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES /* worst case buffer size */ );
     }
 
@@ -360,6 +416,52 @@ CServer::CServer ( const int          iNewMaxNumChan,
 
     // allocate worst case memory for the channel levels
     vecChannelLevels.Init     ( iMaxNumChannels );
+    vecdChanPeakLevels.Init   ( iMaxNumChannels, 0.0 );
+
+    veciChanNumDecodedFrames.Init ( iMaxNumChannels, 0 );
+
+    // the level message buffers are only resized within their capacity
+    veciLevelDeltaChanIDs.reserve ( MAX_NUM_CHANNELS );
+    vecLevelDeltaLevels.reserve   ( MAX_NUM_CHANNELS );
+    vecbyLevelMesData.reserve     ( MAX_SIZE_BYTES_NETW_BUF );
+    vecbyLevelMes.reserve         ( MAX_SIZE_BYTES_NETW_BUF );
+
+    // the versioned connected clients list table is empty at the beginning
+    vecChanInfoTable.Init     ( iMaxNumChannels );
+    vecChanInfoTableUsed.Init ( iMaxNumChannels, false );
+    vecChanListVersion.Init   ( iMaxNumChannels, INVALID_CHAN_LIST_VERSION );
+    iChanInfoTableVersion = 0;
+
+    // avoid rehashing of the channel address index
+    ChannelIDIndex.reserve       ( iMaxNumChannels );
+    SocketChannelIDIndex.reserve ( iMaxNumChannels );
+
+    // the worker for the file accesses owns the logging object from now on,
+    // all following log entries and status file updates are queued
+    SideEffectWorker.moveToThread ( &SideEffectThread );
+    SideEffectThread.start ( QThread::LowPriority );
+
+    QObject::connect ( this, SIGNAL ( WriteHTMLStatusFile ( QString, QString, QStringList ) ),
+        &SideEffectWorker, SLOT ( OnWriteHTMLStatusFile ( QString, QString, QStringList ) ),
+        Qt::QueuedConnection );
+
+    QObject::connect ( this, SIGNAL ( WriteTimingStatsFile ( QString ) ),
+        &SideEffectWorker, SLOT ( OnWriteTimingStatsFile ( QString ) ),
+        Qt::QueuedConnection );
+
+    QObject::connect ( this, SIGNAL ( LogNewConnection ( CHostAddress ) ),
+        &SideEffectWorker, SLOT ( OnLogNewConnection ( CHostAddress ) ),
+        Qt::QueuedConnection );
+
+    QObject::connect ( this, SIGNAL ( LogServerStopped() ),
+        &SideEffectWorker, SLOT ( OnLogServerStopped() ),
+        Qt::QueuedConnection );
+
+    // the channel list is not sent in the frame processing but afterwards by
+    // the event loop
+    QObject::connect ( this, SIGNAL ( ConnectedChannelsChanged() ),
+        this, SLOT ( OnConnectedChannelsChanged() ),
+        Qt::QueuedConnection );
 
     // enable history graph (if requested)
     if ( !strHistoryFileName.isEmpty() )
@@ -402,6 +504,7 @@ CServer::CServer ( const int          iNewMaxNumChan,
     // Enable jam recording (if requested) - kicks off the thread
     if ( bEnableRecording )
     {
+        JamRecorder.SetThreadCPUs ( strNRecorderCPUs );
         JamRecorder.Init ( this, iServerFrameSizeSamples );
     }
 
@@ -742,11 +845,74 @@ CServer::CServer ( const int          iNewMaxNumChan,
 
 #endif
 
+    // select the mix kernels before the first frame is processed
+    MixKernels.SetKernelType ( eNMixKernelType );
+
+    // start the mix worker threads (the timer thread itself processes the
+    // clients of thread index 0, therefore we need one thread less)
+    vecpMixThreads.Init ( iNumMixThreads - 1 );
+
+    for ( i = 0; i < iNumMixThreads - 1; i++ )
+    {
+        vecpMixThreads[i] = new CServerMixThread ( this, i + 1, iRTPriority, strTimerCPUs );
+        vecpMixThreads[i]->start ( QThread::TimeCriticalPriority );
+    }
+
+    // the high precision timer thread applies the real-time settings itself
+    HighPrecisionTimer.SetRealTimeSettings ( iRTPriority, strTimerCPUs );
+
     // start the socket (it is important to start the socket after all
     // initializations and connections)
+    Socket.SetThreadCPUs ( strNSocketCPUs );
     Socket.Start();
 }
 
+CServer::~CServer()
+{
+    // stop the timer before the mix threads are joined
+    HighPrecisionTimer.Stop();
+
+    // finish the queued file accesses
+    SideEffectThread.quit();
+    SideEffectThread.wait();
+
+    // stop the mix worker threads
+    MutexMixJob.lock();
+    {
+        bMixThreadsRun = false;
+        MixJobStarted.wakeAll();
+    }
+    MutexMixJob.unlock();
+
+    for ( int i = 0; i < vecpMixThreads.Size(); i++ )
+    {
+        vecpMixThreads[i]->wait();
+        delete vecpMixThreads[i];
+    }
+
+    // destroy all OPUS encoders/decoders and the shared modes
+    for ( int i = 0; i < iMaxNumChannels; i++ )
+    {
+        ReleaseOpusCoders ( i );
+    }
+
+    for ( int iType = 0; iType < NUM_OPUS_CODER_TYPES; iType++ )
+    {
+        for ( size_t i = 0; i < vecOpusEncoderPool[iType].size(); i++ )
+        {
+            opus_custom_encoder_destroy ( vecOpusEncoderPool[iType][i] );
+        }
+
+        for ( size_t i = 0; i < vecOpusDecoderPool[iType].size(); i++ )
+        {
+            opus_custom_decoder_destroy ( vecOpusDecoderPool[iType][i] );
+        }
+    }
+
+    opus_custom_mode_destroy ( OpusMode );
+    opus_custom_mode_destroy ( Opus64Mode );
+}
+
 #if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
 
 template<unsigned int slotId>
@@ -823,7 +989,7 @@ void CServer::OnNewConnection ( int          iChID,
     vecChannels[iChID].CreateReqJitBufMes();
 
     // logging of new connected channel
-    Logging.AddNewConnection ( RecHostAddr.InetAddr );
+    emit LogNewConnection ( RecHostAddr );
 
     // A new client connected to the server, the channel list
     // at all clients have to be updated. This is done by sending
@@ -845,6 +1011,9 @@ void CServer::OnNewConnection ( int          iChID,
     vecChannels[iChID].ResetTimeOutCounter();
     vecChannels[iChID].CreateReqChanInfoMes();
 
+    // the new client does not have any version of the channel list yet
+    vecChanListVersion[iChID] = INVALID_CHAN_LIST_VERSION;
+
 // COMPATIBILITY ISSUE
 // since old versions of the software did not implement the channel name
 // request message, we have to explicitely send the channel list here
@@ -866,10 +1035,6 @@ CreateAndSendChanListForAllConChannels();
     {
         vecChannels[iChID].CreateLicReqMes ( eLicenceType );
     }
-
-    // reset the conversion buffers
-    DoubleFrameSizeConvBufIn[iChID].Reset();
-    DoubleFrameSizeConvBufOut[iChID].Reset();
 }
 
 void CServer::OnServerFull ( CHostAddress RecHostAddr )
@@ -886,12 +1051,12 @@ void CServer::OnSendCLProtMessage ( CHostAddress     InetAddr,
     Socket.SendPacket ( vecMessage, InetAddr );
 }
 
-void CServer::OnProtcolCLMessageReceived ( int              iRecID,
-                                           CVector<uint8_t> vecbyMesBodyData,
-                                           CHostAddress     RecHostAddr )
+void CServer::OnProtcolCLMessageReceived ( int          iRecID,
+                                           CMesBodyBuf  MesBodyBuf,
+                                           CHostAddress RecHostAddr )
 {
     // connection less messages are always processed
-    ConnLessProtocol.ParseConnectionLessMessageBody ( vecbyMesBodyData,
+    ConnLessProtocol.ParseConnectionLessMessageBody ( MesBodyBuf.GetData(),
                                                       iRecID,
                                                       RecHostAddr );
 }
@@ -900,12 +1065,16 @@ void CServer::OnCLDisconnection ( CHostAddress InetAddr )
 {
     // check if the given address is actually a client which is connected to
     // this server, if yes, disconnect it
-    const int iCurChanID = FindChannel ( InetAddr );
-
-    if ( iCurChanID != INVALID_CHANNEL_ID )
+    Mutex.lock();
     {
-        vecChannels[iCurChanID].Disconnect();
+        const int iCurChanID = FindChannel ( InetAddr );
+
+        if ( iCurChanID != INVALID_CHANNEL_ID )
+        {
+            vecChannels[iCurChanID].Disconnect();
+        }
     }
+    Mutex.unlock();
 }
 
 void CServer::OnAboutToQuit()
@@ -966,7 +1135,7 @@ void CServer::Stop()
         HighPrecisionTimer.Stop();
 
         // logging (add "server stopped" logging entry)
-        Logging.AddServerStopped();
+        emit LogServerStopped();
 
         // emit stopped signal
         emit Stopped();
@@ -975,10 +1144,9 @@ void CServer::Stop()
 
 void CServer::OnTimer()
 {
-    int                i, j, iUnused;
+    int                i, iUnused;
     int                iClientFrameSizeSamples;
     OpusCustomDecoder* CurOpusDecoder;
-    OpusCustomEncoder* CurOpusEncoder;
     unsigned char*     pCurCodedData;
 
 /*
@@ -987,173 +1155,255 @@ static CTimingMeas JitterMeas ( 1000, "test2.dat" );
 JitterMeas.Measure();
 */
 
+    // The frames are processed in the thread of the server object since the
+    // per-channel state (transport properties, protocol, connection state) is
+    // changed by the protocol handling in this thread without further locks.
+    // Therefore this thread gets the same real-time settings as the timer
+    // thread on the first frame.
+    if ( !bRealTimeSettingsApplied )
+    {
+        bRealTimeSettingsApplied = true;
+        CRealTimeUtil::ApplyToCurrentThread ( "frame processing", iRTPriority, strTimerCPUs );
+    }
+
+    // measure the duration of the processing phases for the timing statistics
+    QElapsedTimer FrameTimer;
+    FrameTimer.start();
+
+
     // Get data from all connected clients -------------------------------------
     // some inits
     int  iNumClients               = 0; // init connected client counter
     bool bChannelIsNowDisconnected = false;
     bool bSendChannelLevels        = false;
-
-    // Make put and get calls thread safe. Do not forget to unlock mutex
-    // afterwards!
-    Mutex.lock();
+    bool bChannelLevelsRequired    = false;
+    bool bGainMatrixChanged        = false;
+    int  iNumSkippedDecodes        = 0;
+    int  iNumSilentChannels        = 0;
+
+    // Note that the server mutex is not locked here: the protocol handling
+    // runs in this thread, the connection state and the received packets of
+    // the channels are thread safe by themselves and a new connection is set
+    // up completely by the socket thread before the channel is connected
+    // (see PutAudioData()).
+
+    // first, get number and IDs of connected channels
+    for ( i = 0; i < iMaxNumChannels; i++ )
     {
-        // first, get number and IDs of connected channels
-        for ( i = 0; i < iMaxNumChannels; i++ )
+        if ( vecChannels[i].IsConnected() )
         {
-            if ( vecChannels[i].IsConnected() )
+            // add ID and increment counter (note that the vector length is
+            // according to the worst case scenario, if the number of
+            // connected clients is less, only a subset of elements of this
+            // vector are actually used and the others are dummy elements)
+            vecChanIDsCurConChan[iNumClients] = i;
+            iNumClients++;
+
+            // the channel peak levels are tracked in every frame if any
+            // client has requested the channel levels so that no peak
+            // between the level updates is missed
+            if ( vecChannels[i].ChannelLevelsRequired() )
             {
-                // add ID and increment counter (note that the vector length is
-                // according to the worst case scenario, if the number of
-                // connected clients is less, only a subset of elements of this
-                // vector are actually used and the others are dummy elements)
-                vecChanIDsCurConChan[iNumClients] = i;
-                iNumClients++;
+                bChannelLevelsRequired = true;
             }
         }
+    }
 
-        // process connected channels
-        for ( i = 0; i < iNumClients; i++ )
+    // get gains of all connected channels (the gains are needed before
+    // decoding to find the channels which nobody listens to)
+    bGainMatrixChanged = UpdateGainMatrix ( iNumClients );
+
+    // the channels which nobody listens to are only decoded for the level
+    // meters in the last frames before a level update
+    const bool bLevelProbeFrame = bChannelLevelsRequired &&
+        ( iFrameCount > CHANNEL_LEVEL_UPDATE_INTERVAL - CHANNEL_LEVEL_PROBE_FRAMES );
+
+    // process connected channels
+    for ( i = 0; i < iNumClients; i++ )
+    {
+        // get actual ID of current channel
+        const int iCurChanID = vecChanIDsCurConChan[i];
+
+        // get and store number of audio channels and compression type
+        vecNumAudioChannels[i] = vecChannels[iCurChanID].GetNumAudioChannels();
+        vecAudioComprType[i]   = vecChannels[iCurChanID].GetAudioCompressionType();
+
+        // get info about required frame size conversion properties
+        vecUseDoubleSysFraSizeConvBuf[i] = ( !bUseDoubleSystemFrameSize && ( vecAudioComprType[i] == CT_OPUS ) );
+
+        if ( bUseDoubleSystemFrameSize && ( vecAudioComprType[i] == CT_OPUS64 ) )
+        {
+            vecNumFrameSizeConvBlocks[i] = 2;
+        }
+        else
         {
-            // get actual ID of current channel
-            const int iCurChanID = vecChanIDsCurConChan[i];
+            vecNumFrameSizeConvBlocks[i] = 1;
+        }
 
-            // get and store number of audio channels and compression type
-            vecNumAudioChannels[i] = vecChannels[iCurChanID].GetNumAudioChannels();
-            vecAudioComprType[i]   = vecChannels[iCurChanID].GetAudioCompressionType();
+        // update conversion buffer size (nothing will happen if the size stays the same)
+        if ( vecUseDoubleSysFraSizeConvBuf[i] )
+        {
+            DoubleFrameSizeConvBufIn[iCurChanID].SetBufferSize  ( DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES  * vecNumAudioChannels[i] );
+            DoubleFrameSizeConvBufOut[iCurChanID].SetBufferSize ( DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES  * vecNumAudioChannels[i] );
+        }
 
-            // get info about required frame size conversion properties
-            vecUseDoubleSysFraSizeConvBuf[i] = ( !bUseDoubleSystemFrameSize && ( vecAudioComprType[i] == CT_OPUS ) );
+        // A channel which is muted in all mixes (e.g. during its fade-in)
+        // does not have to be decoded unless its signal is recorded. Its
+        // packets are still taken from the jitter buffer. If the channel
+        // becomes audible again, the decoder simply continues from its old
+        // state (as after lost packets). If the levels are shown, such a
+        // channel is decoded in the probe frames before each level update.
+        bool bDecodeRequired = bEnableRecording || bLevelProbeFrame;
 
-            if ( bUseDoubleSystemFrameSize && ( vecAudioComprType[i] == CT_OPUS64 ) )
-            {
-                vecNumFrameSizeConvBlocks[i] = 2;
-            }
-            else
-            {
-                vecNumFrameSizeConvBlocks[i] = 1;
-            }
+        for ( int j = 0; !bDecodeRequired && ( j < iNumClients ); j++ )
+        {
+            bDecodeRequired = ( vecvecdGains[j][i] != 0.0 );
+        }
 
-            // update conversion buffer size (nothing will happen if the size stays the same)
-            if ( vecUseDoubleSysFraSizeConvBuf[i] )
-            {
-                DoubleFrameSizeConvBufIn[iCurChanID].SetBufferSize  ( DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES  * vecNumAudioChannels[i] );
-                DoubleFrameSizeConvBufOut[iCurChanID].SetBufferSize ( DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES  * vecNumAudioChannels[i] );
-            }
+        // count the consecutively decoded frames (at 64 samples frame size) to
+        // know when the decoder has settled after skipped frames
+        if ( bDecodeRequired )
+        {
+            veciChanNumDecodedFrames[iCurChanID] = std::min ( CHANNEL_LEVEL_SETTLING_FRAMES,
+                veciChanNumDecodedFrames[iCurChanID] + ( bUseDoubleSystemFrameSize ? 2 : 1 ) );
+        }
+        else
+        {
+            veciChanNumDecodedFrames[iCurChanID] = 0;
+        }
+
+        // select the opus decoder and raw audio frame length
+        if ( vecAudioComprType[i] == CT_OPUS )
+        {
+            iClientFrameSizeSamples = DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES;
+        }
+        else if ( vecAudioComprType[i] == CT_OPUS64 )
+        {
+            iClientFrameSizeSamples = SYSTEM_FRAME_SIZE_SAMPLES;
+        }
+
+        CurOpusDecoder = GetOpusDecoder ( iCurChanID, vecAudioComprType[i], vecNumAudioChannels[i] );
+
+        // make sure the encoder exists before the mix/encode stage is
+        // started (which may run on multiple threads)
+        GetOpusEncoder ( iCurChanID, vecAudioComprType[i], vecNumAudioChannels[i] );
 
-            // select the opus decoder and raw audio frame length
-            if ( vecAudioComprType[i] == CT_OPUS )
+        // if the client has changed its coder, its decoder does not follow
+        // any encoder stream anymore
+        const int iCurOpusCoderType = GetOpusCoderType ( vecAudioComprType[i], vecNumAudioChannels[i] );
+
+        if ( vecEncoderStreamType[iCurChanID] != iCurOpusCoderType )
+        {
+            vecEncoderStreamType[iCurChanID]   = iCurOpusCoderType;
+            vecEncoderStreamChanID[iCurChanID] = INVALID_CHANNEL_ID;
+        }
+
+        // If the server frame size is smaller than the received OPUS frame size, we need a conversion
+        // buffer which stores the large buffer.
+        // Note that we have a shortcut here. If the conversion buffer is not needed, the boolean flag
+        // is false and the Get() function is not called at all. Therefore if the buffer is not needed
+        // we do not spend any time in the function but go directly inside the if condition.
+        if ( ( vecUseDoubleSysFraSizeConvBuf[i] == 0 ) ||
+             !DoubleFrameSizeConvBufIn[iCurChanID].Get ( vecvecsData[i], SYSTEM_FRAME_SIZE_SAMPLES * vecNumAudioChannels[i] ) )
+        {
+            // get current number of OPUS coded bytes
+            const int iCeltNumCodedBytes = vecChannels[iCurChanID].GetNetwFrameSize();
+
+            for ( int iB = 0; iB < vecNumFrameSizeConvBlocks[i]; iB++ )
             {
-                iClientFrameSizeSamples = DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES;
+                // get data
+                const EGetDataStat eGetStat = vecChannels[iCurChanID].GetData ( vecbyCodedData, iCeltNumCodedBytes );
 
-                if ( vecNumAudioChannels[i] == 1 )
-                {
-                    CurOpusDecoder = OpusDecoderMono[iCurChanID];
-                }
-                else
+                // if channel was just disconnected, set flag that connected
+                // client list is sent to all other clients
+                // and emit the client disconnected signal
+                if ( eGetStat == GS_CHAN_NOW_DISCONNECTED )
                 {
-                    CurOpusDecoder = OpusDecoderStereo[iCurChanID];
+                    // the encoders/decoders are still needed in this frame
+                    // (the address index entries of the channel are
+                    // removed when they are found to be outdated)
+                    vecChanIDsToRelease.push_back ( iCurChanID );
+
+                    if ( bEnableRecording )
+                    {
+                        // the disconnection is queued in order with the recorded frames
+                        JamRecorder.PutDisconnect ( iCurChanID );
+                    }
+
+                    bChannelIsNowDisconnected = true;
                 }
-            }
-            else if ( vecAudioComprType[i] == CT_OPUS64 )
-            {
-                iClientFrameSizeSamples = SYSTEM_FRAME_SIZE_SAMPLES;
 
-                if ( vecNumAudioChannels[i] == 1 )
+                // get pointer to coded data
+                if ( eGetStat == GS_BUFFER_OK )
                 {
-                    CurOpusDecoder = Opus64DecoderMono[iCurChanID];
+                    pCurCodedData = &vecbyCodedData[0];
                 }
                 else
                 {
-                    CurOpusDecoder = Opus64DecoderStereo[iCurChanID];
+                    // for lost packets use null pointer as coded input data
+                    pCurCodedData = nullptr;
                 }
-            }
-            else
-            {
-                CurOpusDecoder = nullptr;
-            }
-
-            // get gains of all connected channels
-            for ( j = 0; j < iNumClients; j++ )
-            {
-                // The second index of "vecvecdGains" does not represent
-                // the channel ID! Therefore we have to use
-                // "vecChanIDsCurConChan" to query the IDs of the currently
-                // connected channels
-                vecvecdGains[i][j] = vecChannels[iCurChanID].GetGain ( vecChanIDsCurConChan[j] );
-
-                // consider audio fade-in
-                vecvecdGains[i][j] *= vecChannels[vecChanIDsCurConChan[j]].GetFadeInGain();
-            }
 
-            // If the server frame size is smaller than the received OPUS frame size, we need a conversion
-            // buffer which stores the large buffer.
-            // Note that we have a shortcut here. If the conversion buffer is not needed, the boolean flag
-            // is false and the Get() function is not called at all. Therefore if the buffer is not needed
-            // we do not spend any time in the function but go directly inside the if condition.
-            if ( ( vecUseDoubleSysFraSizeConvBuf[i] == 0 ) ||
-                 !DoubleFrameSizeConvBufIn[iCurChanID].Get ( vecvecsData[i], SYSTEM_FRAME_SIZE_SAMPLES * vecNumAudioChannels[i] ) )
-            {
-                // get current number of OPUS coded bytes
-                const int iCeltNumCodedBytes = vecChannels[iCurChanID].GetNetwFrameSize();
-
-                for ( int iB = 0; iB < vecNumFrameSizeConvBlocks[i]; iB++ )
+                // OPUS decode received data stream
+                if ( CurOpusDecoder != nullptr )
                 {
-                    // get data
-                    const EGetDataStat eGetStat = vecChannels[iCurChanID].GetData ( vecbyCodedData, iCeltNumCodedBytes );
-
-                    // if channel was just disconnected, set flag that connected
-                    // client list is sent to all other clients
-                    // and emit the client disconnected signal
-                    if ( eGetStat == GS_CHAN_NOW_DISCONNECTED )
-                    {
-                        if ( bEnableRecording )
-                        {
-                            emit ClientDisconnected ( iCurChanID ); // TODO do this outside the mutex lock?
-                        }
-
-                        bChannelIsNowDisconnected = true;
-                    }
-
-                    // get pointer to coded data
-                    if ( eGetStat == GS_BUFFER_OK )
-                    {
-                        pCurCodedData = &vecbyCodedData[0];
-                    }
-                    else
-                    {
-                        // for lost packets use null pointer as coded input data
-                        pCurCodedData = nullptr;
-                    }
+                    int16_t* psCurDecodedData = &vecvecsData[i][iB * SYSTEM_FRAME_SIZE_SAMPLES * vecNumAudioChannels[i]];
 
-                    // OPUS decode received data stream
-                    if ( CurOpusDecoder != nullptr )
+                    if ( bDecodeRequired )
                     {
                         iUnused = opus_custom_decode ( CurOpusDecoder,
                                                        pCurCodedData,
                                                        iCeltNumCodedBytes,
-                                                       &vecvecsData[i][iB * SYSTEM_FRAME_SIZE_SAMPLES * vecNumAudioChannels[i]],
+                                                       psCurDecodedData,
                                                        iClientFrameSizeSamples );
                     }
+                    else
+                    {
+                        std::fill ( psCurDecodedData, psCurDecodedData + iClientFrameSizeSamples * vecNumAudioChannels[i], 0 );
+                    }
                 }
+            }
 
-                // a new large frame is ready, if the conversion buffer is required, put it in the buffer
-                // and read out the small frame size immediately for further processing
-                if ( vecUseDoubleSysFraSizeConvBuf[i] != 0 )
-                {
-                    DoubleFrameSizeConvBufIn[iCurChanID].PutAll ( vecvecsData[i] );
-                    DoubleFrameSizeConvBufIn[iCurChanID].Get ( vecvecsData[i], SYSTEM_FRAME_SIZE_SAMPLES * vecNumAudioChannels[i] );
-                }
+            if ( !bDecodeRequired )
+            {
+                iNumSkippedDecodes++;
+            }
+
+            // a new large frame is ready, if the conversion buffer is required, put it in the buffer
+            // and read out the small frame size immediately for further processing
+            if ( vecUseDoubleSysFraSizeConvBuf[i] != 0 )
+            {
+                DoubleFrameSizeConvBufIn[iCurChanID].PutAll ( vecvecsData[i] );
+                DoubleFrameSizeConvBufIn[iCurChanID].Get ( vecvecsData[i], SYSTEM_FRAME_SIZE_SAMPLES * vecNumAudioChannels[i] );
             }
         }
 
-        // a channel is now disconnected, take action on it
-        if ( bChannelIsNowDisconnected )
+        // digital silence (e.g. a listener without an input signal or a
+        // skipped decoding) is not added to the mixes
+        vecSourceIsSilent[i] = ( MixKernels.PeakMono ( &vecvecsData[i][0], iServerFrameSizeSamples * vecNumAudioChannels[i] ) == 0 );
+
+        if ( vecSourceIsSilent[i] != 0 )
         {
-            // update channel list for all currently connected clients
-            CreateAndSendChanListForAllConChannels();
+            iNumSilentChannels++;
         }
     }
-    Mutex.unlock(); // release mutex
+
+    // a channel is now disconnected, take action on it
+    if ( bChannelIsNowDisconnected )
+    {
+        // update channel list for all currently connected clients (the
+        // list is sent after this frame since this also updates the status
+        // HTML file)
+        emit ConnectedChannelsChanged();
+    }
+
+    // emit the client disconnected signals
+    for ( size_t iRel = 0; iRel < vecChanIDsToRelease.size(); iRel++ )
+    {
+        emit ClientDisconnected ( vecChanIDsToRelease[iRel] );
+    }
+
+    const qint64 iDecodeEndNs = FrameTimer.nsecsElapsed();
 
 
     // Process data ------------------------------------------------------------
@@ -1161,24 +1411,25 @@ JitterMeas.Measure();
     // one client is connected.
     if ( iNumClients > 0 )
     {
+        if ( bChannelLevelsRequired )
+        {
+            UpdatePeakLevelsForAllConChannels ( iNumClients,
+                                                vecNumAudioChannels,
+                                                vecvecsData );
+        }
+
         // low frequency updates
         if ( iFrameCount > CHANNEL_LEVEL_UPDATE_INTERVAL )
         {
             iFrameCount = 0;
 
             // Calculate channel levels if any client has requested them
-            for ( int i = 0; i < iNumClients; i++ )
+            if ( bChannelLevelsRequired )
             {
-                if ( vecChannels[vecChanIDsCurConChan[i]].ChannelLevelsRequired() )
-                {
-                    bSendChannelLevels = true;
+                bSendChannelLevels = true;
 
-                    CreateLevelsForAllConChannels ( iNumClients,
-                                                    vecNumAudioChannels,
-                                                    vecvecsData,
-                                                    vecChannelLevels );
-                    break;
-                }
+                CreateLevelsForAllConChannels ( iNumClients,
+                                                vecChannelLevels );
             }
         }
         iFrameCount++;
@@ -1188,114 +1439,125 @@ JitterMeas.Measure();
             iFrameCount++;
         }
 
-        for ( int i = 0; i < iNumClients; i++ )
+        // export the audio data for recording purpose (the frames are copied
+        // in preallocated rings which are drained by the recorder thread)
+        if ( bEnableRecording )
         {
-            // get actual ID of current channel
-            const int iCurChanID = vecChanIDsCurConChan[i];
-
-            // get number of audio channels of current channel
-            const int iCurNumAudChan = vecNumAudioChannels[i];
-
-            // export the audio data for recording purpose
-            if ( bEnableRecording )
+            for ( int i = 0; i < iNumClients; i++ )
             {
-                emit AudioFrame ( iCurChanID,
-                                  vecChannels[iCurChanID].GetName(),
-                                  vecChannels[iCurChanID].GetAddress(),
-                                  iCurNumAudChan,
-                                  vecvecsData[i] );
+                const int iCurChanID = vecChanIDsCurConChan[i];
+
+                if ( vecChannels[iCurChanID].IsConnected() )
+                {
+                    JamRecorder.PutFrame ( iCurChanID,
+                                           vecChannels[iCurChanID].GetName(),
+                                           vecChannels[iCurChanID].GetAddress(),
+                                           vecNumAudioChannels[i],
+                                           vecvecsData[i] );
+                }
             }
 
-            // generate a sparate mix for each channel
-            // actual processing of audio data -> mix
-            ProcessData ( vecvecsData,
-                          vecvecdGains[i],
-                          vecNumAudioChannels,
-                          vecsSendData,
-                          iCurNumAudChan,
-                          iNumClients );
+            JamRecorder.EndOfFrame();
+        }
 
-            // get current number of CELT coded bytes
-            const int iCeltNumCodedBytes = vecChannels[iCurChanID].GetNetwFrameSize();
+        // find clients which get identical mixes so that these mixes are only
+        // generated and encoded once
+        const int iNumMixes = CreateSharedMixGroups ( iNumClients, bGainMatrixChanged );
 
-            // select the opus encoder and raw audio frame length
-            if ( vecAudioComprType[i] == CT_OPUS )
-            {
-                iClientFrameSizeSamples = DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES;
+        // continue the encoder streams of clients whose group leader changed
+        SyncSharedMixEncoders ( iNumClients, iNumMixes );
 
-                if ( vecNumAudioChannels[i] == 1 )
-                {
-                    CurOpusEncoder = OpusEncoderMono[iCurChanID];
-                }
-                else
-                {
-                    CurOpusEncoder = OpusEncoderStereo[iCurChanID];
-                }
-            }
-            else if ( vecAudioComprType[i] == CT_OPUS64 )
-            {
-                iClientFrameSizeSamples = SYSTEM_FRAME_SIZE_SAMPLES;
+        const qint64 iMixStartNs = FrameTimer.nsecsElapsed();
 
-                if ( vecNumAudioChannels[i] == 1 )
-                {
-                    CurOpusEncoder = Opus64EncoderMono[iCurChanID];
-                }
-                else
-                {
-                    CurOpusEncoder = Opus64EncoderStereo[iCurChanID];
-                }
+        // generate the shared bus mixes which are the base of the client mixes
+        // (the deltas only change with the gain matrix)
+        if ( bUseBusMix && !bUseReferenceMix )
+        {
+            if ( bGainMatrixChanged )
+            {
+                UpdateBusMixDeltas ( iNumClients );
             }
-            else
+
+            CreateBusMixes ( iNumClients, iNumMixes );
+        }
+
+        // generate a separate mix for each channel, encode and transmit it
+        if ( iNumMixThreads > 1 )
+        {
+            // start the mix job on all worker threads
+            MutexMixJob.lock();
             {
-                CurOpusEncoder = nullptr;
+                iMixJobNumClients = iNumClients;
+                iMixJobNumMixes   = iNumMixes;
+                iMixJobNumPending = iNumMixThreads - 1;
+                iMixJobNextMix.storeRelease ( 0 );
+                iMixJobFrame++;
+                MixJobStarted.wakeAll();
             }
+            MutexMixJob.unlock();
+
+            // the timer thread takes part in the processing, too
+            MixEncodeTransmitDataJobs ( 0 );
 
-            // If the server frame size is smaller than the received OPUS frame size, we need a conversion
-            // buffer which stores the large buffer.
-            // Note that we have a shortcut here. If the conversion buffer is not needed, the boolean flag
-            // is false and the Get() function is not called at all. Therefore if the buffer is not needed
-            // we do not spend any time in the function but go directly inside the if condition.
-            if ( ( vecUseDoubleSysFraSizeConvBuf[i] == 0 ) ||
-                 DoubleFrameSizeConvBufOut[iCurChanID].Put ( vecsSendData, SYSTEM_FRAME_SIZE_SAMPLES * vecNumAudioChannels[i] ) )
+            // frame barrier: wait for all worker threads to finish
+            MutexMixJob.lock();
             {
-                if ( vecUseDoubleSysFraSizeConvBuf[i] != 0 )
+                while ( iMixJobNumPending > 0 )
                 {
-                    // get the large frame from the conversion buffer
-                    DoubleFrameSizeConvBufOut[iCurChanID].GetAll ( vecsSendData, DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES * vecNumAudioChannels[i] );
+                    MixJobFinished.wait ( &MutexMixJob );
                 }
+            }
+            MutexMixJob.unlock();
+        }
+        else
+        {
+            for ( int i = 0; i < iNumMixes; i++ )
+            {
+                MixEncodeTransmitData ( vecSharedMixClientIdx[i],
+                                        iNumClients,
+                                        vecvecfMixData[0],
+                                        vecvecsSendData[0],
+                                        vecvecbyCodedData[0] );
+            }
+        }
 
-                for ( int iB = 0; iB < vecNumFrameSizeConvBlocks[i]; iB++ )
-                {
-                    // OPUS encoding
-                    if ( CurOpusEncoder != nullptr )
-                    {
-// TODO find a better place than this: the setting does not change all the time
-//      so for speed optimization it would be better to set it only if the network
-//      frame size is changed
-opus_custom_encoder_ctl ( CurOpusEncoder,
-                          OPUS_SET_BITRATE ( CalcBitRateBitsPerSecFromCodedBytes ( iCeltNumCodedBytes, iClientFrameSizeSamples ) ) );
-
-                        iUnused = opus_custom_encode ( CurOpusEncoder,
-                                                       &vecsSendData[iB * SYSTEM_FRAME_SIZE_SAMPLES * vecNumAudioChannels[i]],
-                                                       iClientFrameSizeSamples,
-                                                       &vecbyCodedData[0],
-                                                       iCeltNumCodedBytes );
-                    }
+        const qint64 iMixEndNs = FrameTimer.nsecsElapsed();
 
-                    // send separate mix to current clients
-                    vecChannels[iCurChanID].PrepAndSendPacket ( &Socket,
-                                                                vecbyCodedData,
-                                                                iCeltNumCodedBytes );
-                }
+        // the channel level messages are queued after the mix barrier so
+        // that they are sent in the batch of the audio packets
+        if ( bSendChannelLevels )
+        {
+            SendChannelLevels ( iNumClients );
+        }
 
-                // update socket buffer size
-                vecChannels[iCurChanID].UpdateSocketBufferSize();
+        // send the audio packets and channel levels of all clients
+        Socket.FlushPacketQueue();
 
-                // send channel levels
-                if ( bSendChannelLevels && vecChannels[iCurChanID].ChannelLevelsRequired() )
-                {
-                    ConnLessProtocol.CreateCLChannelLevelListMes ( vecChannels[iCurChanID].GetAddress(), vecChannelLevels, iNumClients );
-                }
+        // update the timing statistics (only if the statistics file is written)
+        if ( bWriteStatusHTMLFile )
+        {
+            const qint64 iFrameEndNs = FrameTimer.nsecsElapsed();
+
+            TimingStats.AddPhase ( CServerTimingStats::TP_TIMER_LATENESS, HighPrecisionTimer.GetLastWakeUpLatenessNs() );
+            TimingStats.AddPhase ( CServerTimingStats::TP_DECODE,         iDecodeEndNs );
+            TimingStats.AddPhase ( CServerTimingStats::TP_MIX_ENCODE,     iMixEndNs - iMixStartNs );
+            TimingStats.AddPhase ( CServerTimingStats::TP_SEND,           iFrameEndNs - iMixEndNs );
+            TimingStats.AddFrame ( iFrameEndNs,
+                                   iNumClients,
+                                   iNumMixes,
+                                   iNumSkippedDecodes,
+                                   iNumSilentChannels );
+
+            // every few seconds, a copy of the statistics is posted to the
+            // worker which writes the file (if the worker is still busy with
+            // the last copy, we simply try again in the next frame)
+            iTimingStatsFrameCnt++;
+
+            if ( ( iTimingStatsFrameCnt >= iTimingStatsUpdateNumFrames ) &&
+                 SideEffectWorker.SetTimingStatsSnapshot ( TimingStats ) )
+            {
+                iTimingStatsFrameCnt = 0;
+                emit WriteTimingStatsFile ( strTimingStatsFileName );
             }
         }
     }
@@ -1306,36 +1568,871 @@ opus_custom_encoder_ctl ( CurOpusEncoder,
         Stop();
     }
 
+    // put the encoders/decoders of disconnected channels back in the pool (the
+    // encoder state is handed over to a client which still needs it before)
+    // and reset their conversion buffers for the next client
+    for ( size_t iRel = 0; iRel < vecChanIDsToRelease.size(); iRel++ )
+    {
+        HandOverEncoderStream ( vecChanIDsToRelease[iRel], iNumClients );
+        ReleaseOpusCoders ( vecChanIDsToRelease[iRel] );
+
+        DoubleFrameSizeConvBufIn[vecChanIDsToRelease[iRel]].Reset();
+        DoubleFrameSizeConvBufOut[vecChanIDsToRelease[iRel]].Reset();
+
+        veciChanNumDecodedFrames[vecChanIDsToRelease[iRel]] = 0;
+    }
+    vecChanIDsToRelease.clear();
+
     Q_UNUSED ( iUnused )
 }
 
-/// @brief Mix all audio data from all clients together.
-void CServer::ProcessData ( const CVector<CVector<int16_t> >& vecvecsData,
-                            const CVector<double>&            vecdGains,
-                            const CVector<int>&               vecNumAudioChannels,
-                            CVector<int16_t>&                 vecsOutData,
-                            const int                         iCurNumAudChan,
-                            const int                         iNumClients )
+void CServer::SendChannelLevels ( const int iNumClients )
 {
-    int i, j, k;
-
-    // init return vector with zeros since we mix all channels on that vector
-    vecsOutData.Reset ( 0 );
-
-    // distinguish between stereo and mono mode
-    if ( iCurNumAudChan == 1 )
+    // send channel levels (clients which subscribed to the deltas only get the
+    // changed levels of the subscribed channels), the messages are generated
+    // in the preallocated buffers and queued with the audio packets
+    for ( int i = 0; i < iNumClients; i++ )
     {
-        // Mono target channel -------------------------------------------------
-        for ( j = 0; j < iNumClients; j++ )
+        const int iCurChanID = vecChanIDsCurConChan[i];
+
+        if ( !vecChannels[iCurChanID].ChannelLevelsRequired() )
         {
-            // get a reference to the audio data and gain of the current client
-            const CVector<int16_t>& vecsData = vecvecsData[j];
-            const double            dGain    = vecdGains[j];
+            continue;
+        }
 
-            // if channel gain is 1, avoid multiplication for speed optimization
-            if ( dGain == static_cast<double> ( 1.0 ) )
+        if ( vecChannels[iCurChanID].ChannelLevelDeltasSupported() )
+        {
+            int  iSeqNum;
+            bool bComplete;
+
+            if ( !vecChannels[iCurChanID].GetChannelLevelDelta ( vecChanIDsCurConChan,
+                                                                 vecChannelLevels,
+                                                                 iNumClients,
+                                                                 iSeqNum,
+                                                                 bComplete,
+                                                                 veciLevelDeltaChanIDs,
+                                                                 vecLevelDeltaLevels ) )
             {
-                if ( vecNumAudioChannels[j] == 1 )
+                continue;
+            }
+
+            CProtocol::GenCLChannelLevelDeltaMes ( vecbyLevelMes,
+                                                   vecbyLevelMesData,
+                                                   iSeqNum,
+                                                   bComplete,
+                                                   veciLevelDeltaChanIDs,
+                                                   vecLevelDeltaLevels );
+        }
+        else
+        {
+            CProtocol::GenCLChannelLevelListMes ( vecbyLevelMes,
+                                                  vecbyLevelMesData,
+                                                  vecChannelLevels,
+                                                  iNumClients );
+        }
+
+        Socket.QueuePacket ( vecbyLevelMes, vecChannels[iCurChanID].GetAddress() );
+    }
+}
+
+void CServer::MixEncodeTransmitData ( const int         iClientIdx,
+                                      const int         iNumClients,
+                                      CVector<float>&   vecfMixData,
+                                      CVector<int16_t>& vecsSendData,
+                                      CVector<uint8_t>& vecbyCodedData )
+{
+    int                iUnused;
+    int                iClientFrameSizeSamples = 0; // initialize to avoid a compiler warning
+    OpusCustomEncoder* CurOpusEncoder;
+
+    // get actual ID of current channel
+    const int iCurChanID = vecChanIDsCurConChan[iClientIdx];
+
+    // get number of audio channels of current channel
+    const int iCurNumAudChan = vecNumAudioChannels[iClientIdx];
+
+    // generate a sparate mix for each channel
+    // actual processing of audio data -> mix
+    if ( bUseReferenceMix )
+    {
+        ProcessDataReference ( vecvecsData,
+                               vecvecdGains[iClientIdx],
+                               vecNumAudioChannels,
+                               vecsSendData,
+                               iCurNumAudChan,
+                               iNumClients );
+    }
+    else if ( bUseBusMix && ( vecUseBusMix[iClientIdx] != 0 ) )
+    {
+        ProcessDataBus ( vecvecsData,
+                         iClientIdx,
+                         vecNumAudioChannels,
+                         vecfMixData,
+                         vecsSendData,
+                         iCurNumAudChan );
+    }
+    else
+    {
+        ProcessData ( vecvecsData,
+                      vecvecdGains[iClientIdx],
+                      vecNumAudioChannels,
+                      vecfMixData,
+                      vecsSendData,
+                      iCurNumAudChan,
+                      iNumClients );
+    }
+
+    // get current number of CELT coded bytes
+    const int iCeltNumCodedBytes = vecChannels[iCurChanID].GetNetwFrameSize();
+
+    // select the opus encoder and raw audio frame length (the encoder was
+    // already created in the timer thread, see OnTimer())
+    if ( vecAudioComprType[iClientIdx] == CT_OPUS )
+    {
+        iClientFrameSizeSamples = DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES;
+    }
+    else if ( vecAudioComprType[iClientIdx] == CT_OPUS64 )
+    {
+        iClientFrameSizeSamples = SYSTEM_FRAME_SIZE_SAMPLES;
+    }
+
+    const int iOpusCoderType = GetOpusCoderType ( vecAudioComprType[iClientIdx], iCurNumAudChan );
+
+    if ( iOpusCoderType != INVALID_OPUS_CODER_TYPE )
+    {
+        CurOpusEncoder = OpusEncoders[iCurChanID][iOpusCoderType];
+    }
+    else
+    {
+        CurOpusEncoder = nullptr;
+    }
+
+    // If the server frame size is smaller than the received OPUS frame size, we need a conversion
+    // buffer which stores the large buffer.
+    // Note that we have a shortcut here. If the conversion buffer is not needed, the boolean flag
+    // is false and the Get() function is not called at all. Therefore if the buffer is not needed
+    // we do not spend any time in the function but go directly inside the if condition.
+    if ( ( vecUseDoubleSysFraSizeConvBuf[iClientIdx] == 0 ) ||
+         DoubleFrameSizeConvBufOut[iCurChanID].Put ( vecsSendData, SYSTEM_FRAME_SIZE_SAMPLES * iCurNumAudChan ) )
+    {
+        if ( vecUseDoubleSysFraSizeConvBuf[iClientIdx] != 0 )
+        {
+            // get the large frame from the conversion buffer
+            DoubleFrameSizeConvBufOut[iCurChanID].GetAll ( vecsSendData, DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES * iCurNumAudChan );
+        }
+
+        for ( int iB = 0; iB < vecNumFrameSizeConvBlocks[iClientIdx]; iB++ )
+        {
+            // OPUS encoding
+            if ( CurOpusEncoder != nullptr )
+            {
+// TODO find a better place than this: the setting does not change all the time
+//      so for speed optimization it would be better to set it only if the network
+//      frame size is changed
+opus_custom_encoder_ctl ( CurOpusEncoder,
+                          OPUS_SET_BITRATE ( CalcBitRateBitsPerSecFromCodedBytes ( iCeltNumCodedBytes, iClientFrameSizeSamples ) ) );
+
+                iUnused = opus_custom_encode ( CurOpusEncoder,
+                                               &vecsSendData[iB * SYSTEM_FRAME_SIZE_SAMPLES * iCurNumAudChan],
+                                               iClientFrameSizeSamples,
+                                               &vecbyCodedData[0],
+                                               iCeltNumCodedBytes );
+            }
+
+            // send separate mix to current client and to all other clients
+            // sharing this mix (the packets of all clients are sent in one
+            // batch at the end of the frame)
+            for ( int j = iClientIdx; j < iNumClients; j++ )
+            {
+                if ( vecSharedMixLeader[j] == iClientIdx )
+                {
+                    vecChannels[vecChanIDsCurConChan[j]].PrepAndSendPacket ( &Socket,
+                                                                             vecbyCodedData,
+                                                                             iCeltNumCodedBytes,
+                                                                             true );
+                }
+            }
+        }
+
+        for ( int j = iClientIdx; j < iNumClients; j++ )
+        {
+            if ( vecSharedMixLeader[j] == iClientIdx )
+            {
+                const int iSharedChanID = vecChanIDsCurConChan[j];
+
+                // update socket buffer size
+                vecChannels[iSharedChanID].UpdateSocketBufferSize();
+            }
+        }
+    }
+
+    Q_UNUSED ( iUnused )
+}
+
+int CServer::GetOpusCoderType ( const EAudComprType eAudComprType,
+                                const int           iNumAudChan ) const
+{
+    // the coder type index is: [OPUS mono, OPUS stereo, OPUS64 mono, OPUS64 stereo]
+    const int iStereoOffset = ( iNumAudChan == 1 ) ? 0 : 1;
+
+    if ( eAudComprType == CT_OPUS )
+    {
+        return iStereoOffset;
+    }
+    else if ( eAudComprType == CT_OPUS64 )
+    {
+        return 2 + iStereoOffset;
+    }
+
+    return INVALID_OPUS_CODER_TYPE;
+}
+
+OpusCustomEncoder* CServer::GetOpusEncoder ( const int           iChanID,
+                                             const EAudComprType eAudComprType,
+                                             const int           iNumAudChan )
+{
+    const int iType = GetOpusCoderType ( eAudComprType, iNumAudChan );
+
+    if ( iType == INVALID_OPUS_CODER_TYPE )
+    {
+        return nullptr;
+    }
+
+    if ( OpusEncoders[iChanID][iType] == nullptr )
+    {
+        if ( !vecOpusEncoderPool[iType].empty() )
+        {
+            // reuse an encoder of a disconnected channel (the reset does not
+            // change the encoder settings)
+            OpusEncoders[iChanID][iType] = vecOpusEncoderPool[iType].back();
+            vecOpusEncoderPool[iType].pop_back();
+
+            opus_custom_encoder_ctl ( OpusEncoders[iChanID][iType], OPUS_RESET_STATE );
+        }
+        else
+        {
+            int                iOpusError;
+            const bool         bIsOpus64  = ( eAudComprType == CT_OPUS64 );
+            OpusCustomEncoder* CurEncoder = opus_custom_encoder_create ( bIsOpus64 ? Opus64Mode : OpusMode,
+                                                                         iNumAudChan,
+                                                                         &iOpusError );
+
+            // we require a constant bit rate
+            opus_custom_encoder_ctl ( CurEncoder, OPUS_SET_VBR ( 0 ) );
+
+            // we want as low delay as possible
+            opus_custom_encoder_ctl ( CurEncoder, OPUS_SET_APPLICATION ( OPUS_APPLICATION_RESTRICTED_LOWDELAY ) );
+
+            if ( bIsOpus64 )
+            {
+                // for 64 samples frame size we have to adjust the PLC behavior to avoid loud artifacts
+                opus_custom_encoder_ctl ( CurEncoder, OPUS_SET_PACKET_LOSS_PERC ( 35 ) );
+            }
+            else
+            {
+                // set encoder low complexity for legacy 128 samples frame size
+                opus_custom_encoder_ctl ( CurEncoder, OPUS_SET_COMPLEXITY ( 1 ) );
+            }
+
+            OpusEncoders[iChanID][iType] = CurEncoder;
+        }
+
+        // the new encoder starts a new stream
+        vecEncoderStreamChanID[iChanID] = INVALID_CHANNEL_ID;
+    }
+
+    return OpusEncoders[iChanID][iType];
+}
+
+OpusCustomDecoder* CServer::GetOpusDecoder ( const int           iChanID,
+                                             const EAudComprType eAudComprType,
+                                             const int           iNumAudChan )
+{
+    const int iType = GetOpusCoderType ( eAudComprType, iNumAudChan );
+
+    if ( iType == INVALID_OPUS_CODER_TYPE )
+    {
+        return nullptr;
+    }
+
+    if ( OpusDecoders[iChanID][iType] == nullptr )
+    {
+        if ( !vecOpusDecoderPool[iType].empty() )
+        {
+            // reuse a decoder of a disconnected channel
+            OpusDecoders[iChanID][iType] = vecOpusDecoderPool[iType].back();
+            vecOpusDecoderPool[iType].pop_back();
+
+            opus_custom_decoder_ctl ( OpusDecoders[iChanID][iType], OPUS_RESET_STATE );
+        }
+        else
+        {
+            int iOpusError;
+
+            OpusDecoders[iChanID][iType] =
+                opus_custom_decoder_create ( ( eAudComprType == CT_OPUS64 ) ? Opus64Mode : OpusMode,
+                                             iNumAudChan,
+                                             &iOpusError );
+        }
+    }
+
+    return OpusDecoders[iChanID][iType];
+}
+
+void CServer::ReleaseOpusCoders ( const int iChanID )
+{
+    for ( int iType = 0; iType < NUM_OPUS_CODER_TYPES; iType++ )
+    {
+        if ( OpusEncoders[iChanID][iType] != nullptr )
+        {
+            vecOpusEncoderPool[iType].push_back ( OpusEncoders[iChanID][iType] );
+            OpusEncoders[iChanID][iType] = nullptr;
+        }
+
+        if ( OpusDecoders[iChanID][iType] != nullptr )
+        {
+            vecOpusDecoderPool[iType].push_back ( OpusDecoders[iChanID][iType] );
+            OpusDecoders[iChanID][iType] = nullptr;
+        }
+    }
+}
+
+bool CServer::UpdateGainMatrix ( const int iNumClients )
+{
+    int  i, j;
+    bool bFadeIn  = false;
+    bool bRebuild = ( iNumClients != iGainMatrixNumClients );
+
+    for ( i = 0; i < iNumClients; i++ )
+    {
+        const int iCurChanID  = vecChanIDsCurConChan[i];
+        const int iCurVersion = vecChannels[iCurChanID].GetGainsVersion();
+
+        // only copy the gains (which locks the channel mutex) if they have
+        // been changed by the protocol since the last copy
+        if ( iCurVersion != vecGainSnapshotVersion[iCurChanID] )
+        {
+            vecChannels[iCurChanID].GetGains ( vecvecdGainSnapshot[iCurChanID] );
+            vecGainSnapshotVersion[iCurChanID] = iCurVersion;
+            bRebuild = true;
+        }
+
+        if ( vecGainMatrixChanIDs[i] != iCurChanID )
+        {
+            vecGainMatrixChanIDs[i] = iCurChanID;
+            bRebuild = true;
+        }
+
+        if ( vecChannels[iCurChanID].GetFadeInGain() < 1.0 )
+        {
+            bFadeIn = true;
+        }
+    }
+
+    // during a fade-in the matrix is rebuilt in each frame and once more
+    // after the fade-in has finished
+    if ( !bRebuild && !bFadeIn && !bGainMatrixFadeIn )
+    {
+        return false;
+    }
+
+    iGainMatrixNumClients = iNumClients;
+    bGainMatrixFadeIn     = bFadeIn;
+
+    for ( i = 0; i < iNumClients; i++ )
+    {
+        const CVector<double>& vecdCurGains = vecvecdGainSnapshot[vecChanIDsCurConChan[i]];
+
+        for ( j = 0; j < iNumClients; j++ )
+        {
+            // The second index of "vecvecdGains" does not represent
+            // the channel ID! Therefore we have to use
+            // "vecChanIDsCurConChan" to query the IDs of the currently
+            // connected channels
+            vecvecdGains[i][j] = vecdCurGains[vecChanIDsCurConChan[j]];
+
+            // consider audio fade-in
+            vecvecdGains[i][j] *= vecChannels[vecChanIDsCurConChan[j]].GetFadeInGain();
+        }
+    }
+
+    return true;
+}
+
+int CServer::CreateSharedMixGroups ( const int  iNumClients,
+                                     const bool bGainMatrixChanged )
+{
+    int i, j, k;
+    int iNumMixes = 0;
+
+    // calculate a simple hash of the gain row of each client so that we only
+    // have to compare the complete rows if the hashes are equal (the hashes
+    // only change with the gain matrix)
+    if ( bGainMatrixChanged )
+    {
+        for ( i = 0; i < iNumClients; i++ )
+        {
+            uint64_t iHash = 14695981039346656037ULL; // FNV-1a offset basis
+
+            for ( j = 0; j < iNumClients; j++ )
+            {
+                uint64_t iGainBits;
+                memcpy ( &iGainBits, &vecvecdGains[i][j], sizeof ( iGainBits ) );
+
+                iHash = ( iHash ^ iGainBits ) * 1099511628211ULL; // FNV-1a prime
+            }
+
+            vecGainRowHash[i] = iHash;
+        }
+    }
+
+    // A client can share the mix of another client if the gain rows, the
+    // number of audio channels and the codec settings are the same. The client
+    // with the lowest index in a group generates the mix and uses its encoder
+    // so that the group leader is stable as long as the group does not change.
+    // Clients which need the frame size conversion buffer are not grouped since
+    // that buffer has a state per channel. A client which joins a group with
+    // another encoder stream than its own simply switches to the stream of
+    // the group (like after a lost packet), the stream of the group members
+    // is continued if the leader changes (see SyncSharedMixEncoders()).
+    for ( i = 0; i < iNumClients; i++ )
+    {
+        vecSharedMixLeader[i] = i;
+
+        if ( vecUseDoubleSysFraSizeConvBuf[i] == 0 )
+        {
+            for ( k = 0; k < iNumMixes; k++ )
+            {
+                const int iLeaderIdx = vecSharedMixClientIdx[k];
+
+                if ( ( vecUseDoubleSysFraSizeConvBuf[iLeaderIdx] == 0 ) &&
+                     ( vecGainRowHash[iLeaderIdx]      == vecGainRowHash[i] ) &&
+                     ( vecNumAudioChannels[iLeaderIdx] == vecNumAudioChannels[i] ) &&
+                     ( vecAudioComprType[iLeaderIdx]   == vecAudioComprType[i] ) &&
+                     ( vecChannels[vecChanIDsCurConChan[iLeaderIdx]].GetNetwFrameSize() ==
+                       vecChannels[vecChanIDsCurConChan[i]].GetNetwFrameSize() ) &&
+                     std::equal ( &vecvecdGains[i][0],
+                                  &vecvecdGains[i][0] + iNumClients,
+                                  &vecvecdGains[iLeaderIdx][0] ) )
+                {
+                    vecSharedMixLeader[i] = iLeaderIdx;
+                    break;
+                }
+            }
+        }
+
+        // this client generates its own mix
+        if ( vecSharedMixLeader[i] == i )
+        {
+            vecSharedMixClientIdx[iNumMixes] = i;
+            iNumMixes++;
+        }
+    }
+
+    return iNumMixes;
+}
+
+void CServer::SyncSharedMixEncoders ( const int iNumClients,
+                                     const int iNumMixes )
+{
+    int i, k;
+
+    // If the leader of a group is not the channel whose encoder generated the
+    // last packets of the leader (e.g., if the old leader has left the group
+    // or a client with a lower index has joined it), the state of that
+    // encoder is copied to the encoder of the leader so that the decoders of
+    // the clients which followed the old stream get a continuous stream.
+    // Note that a copied encoder is never the target of a copy in the same
+    // frame: the channel whose stream is continued was a leader in the last
+    // frame and therefore follows its own stream.
+    for ( k = 0; k < iNumMixes; k++ )
+    {
+        const int iLeaderIdx    = vecSharedMixClientIdx[k];
+        const int iLeaderChanID = vecChanIDsCurConChan[iLeaderIdx];
+        const int iType         = vecEncoderStreamType[iLeaderChanID];
+        const int iStreamChanID = vecEncoderStreamChanID[iLeaderChanID];
+
+        if ( ( iStreamChanID != INVALID_CHANNEL_ID ) &&
+             ( iStreamChanID != iLeaderChanID ) &&
+             ( iType != INVALID_OPUS_CODER_TYPE ) )
+        {
+            if ( OpusEncoders[iStreamChanID][iType] != nullptr )
+            {
+                CopyOpusEncoderState ( iType, iStreamChanID, iLeaderChanID );
+            }
+            else
+            {
+                opus_custom_encoder_ctl ( OpusEncoders[iLeaderChanID][iType], OPUS_RESET_STATE );
+            }
+        }
+    }
+
+    // in this frame all clients get the stream of their group leader
+    for ( i = 0; i < iNumClients; i++ )
+    {
+        vecEncoderStreamChanID[vecChanIDsCurConChan[i]] = vecChanIDsCurConChan[vecSharedMixLeader[i]];
+    }
+}
+
+void CServer::HandOverEncoderStream ( const int iChanID,
+                                      const int iNumClients )
+{
+    int i;
+    int iNewStreamChanID = INVALID_CHANNEL_ID;
+
+    // if the encoder of a disconnected channel has generated the last packets
+    // of other clients, its state is copied to the encoder of one of these
+    // clients which then continues the stream for all of them (these clients
+    // were group members, so nobody follows the stream of their own encoders)
+    for ( i = 0; i < iNumClients; i++ )
+    {
+        const int iCurChanID = vecChanIDsCurConChan[i];
+
+        if ( ( iCurChanID != iChanID ) && ( vecEncoderStreamChanID[iCurChanID] == iChanID ) )
+        {
+            if ( iNewStreamChanID == INVALID_CHANNEL_ID )
+            {
+                const int iType = vecEncoderStreamType[iCurChanID];
+
+                if ( ( OpusEncoders[iChanID][iType] == nullptr ) ||
+                     ( OpusEncoders[iCurChanID][iType] == nullptr ) )
+                {
+                    // no stream can be continued, the clients start a new one
+                    vecEncoderStreamChanID[iCurChanID] = INVALID_CHANNEL_ID;
+                    continue;
+                }
+
+                CopyOpusEncoderState ( iType, iChanID, iCurChanID );
+
+                iNewStreamChanID = iCurChanID;
+            }
+
+            vecEncoderStreamChanID[iCurChanID] = iNewStreamChanID;
+        }
+    }
+}
+
+void CServer::CopyOpusEncoderState ( const int iType,
+                                     const int iSrcChanID,
+                                     const int iDestChanID )
+{
+    // The state of an OPUS custom encoder is one memory block of
+    // opus_custom_encoder_get_size() bytes: opus_custom_encoder_create()
+    // allocates exactly this size and OPUS_RESET_STATE clears the state up to
+    // the end of this block. The only pointers in the block are the mode,
+    // which is shared by all encoders of a coder type, and the energy mask,
+    // which is only set for surround encoding and stays null here. All
+    // encoders of a coder type are created by GetOpusEncoder() with the same
+    // mode, number of channels and settings, so the complete block can be
+    // copied between them.
+    Q_ASSERT ( ( iType >= 0 ) && ( iType < NUM_OPUS_CODER_TYPES ) );
+
+    const int          iNumChannels = ( iType % 2 == 0 ) ? 1 : 2; // see GetOpusCoderType()
+    OpusCustomMode*    pMode        = ( iType >= 2 ) ? Opus64Mode : OpusMode;
+    OpusCustomEncoder* pSrcEncoder  = OpusEncoders[iSrcChanID][iType];
+    OpusCustomEncoder* pDestEncoder = OpusEncoders[iDestChanID][iType];
+
+    Q_ASSERT ( ( pSrcEncoder != nullptr ) && ( pDestEncoder != nullptr ) && ( pSrcEncoder != pDestEncoder ) );
+    Q_ASSERT ( GetOpusCoderType ( ( iType >= 2 ) ? CT_OPUS64 : CT_OPUS, iNumChannels ) == iType );
+
+    memcpy ( pDestEncoder, pSrcEncoder, opus_custom_encoder_get_size ( pMode, iNumChannels ) );
+}
+
+void CServer::MixEncodeTransmitDataJobs ( const int iThreadIdx )
+{
+    int iMixIdx;
+
+    // the mixes are distributed dynamically on the threads: each thread
+    // takes the next unprocessed mix until all mixes are done
+    while ( ( iMixIdx = iMixJobNextMix.fetchAndAddOrdered ( 1 ) ) < iMixJobNumMixes )
+    {
+        MixEncodeTransmitData ( vecSharedMixClientIdx[iMixIdx],
+                                iMixJobNumClients,
+                                vecvecfMixData[iThreadIdx],
+                                vecvecsSendData[iThreadIdx],
+                                vecvecbyCodedData[iThreadIdx] );
+    }
+}
+
+bool CServer::WaitForMixJob ( int& iLastMixJobFrame )
+{
+/*
+    return code: true -> new mix job available; false -> thread shall quit
+*/
+    QMutexLocker locker ( &MutexMixJob );
+
+    while ( bMixThreadsRun && ( iMixJobFrame == iLastMixJobFrame ) )
+    {
+        MixJobStarted.wait ( &MutexMixJob );
+    }
+
+    iLastMixJobFrame = iMixJobFrame;
+
+    return bMixThreadsRun;
+}
+
+void CServer::FinishMixJob()
+{
+    QMutexLocker locker ( &MutexMixJob );
+
+    if ( --iMixJobNumPending == 0 )
+    {
+        MixJobFinished.wakeAll();
+    }
+}
+
+void CServerMixThread::run()
+{
+    int iLastMixJobFrame = 0;
+
+    CRealTimeUtil::ApplyToCurrentThread ( QString ( "mix %1" ).arg ( iThreadIdx ), iFIFOPriority, strCPUs );
+
+    while ( pServer->WaitForMixJob ( iLastMixJobFrame ) )
+    {
+        pServer->MixEncodeTransmitDataJobs ( iThreadIdx );
+        pServer->FinishMixJob();
+    }
+}
+
+/// @brief Mix all audio data from all clients together.
+void CServer::ProcessData ( const CVector<CVector<int16_t> >& vecvecsData,
+                            const CVector<double>&            vecdGains,
+                            const CVector<int>&               vecNumAudioChannels,
+                            CVector<float>&                   vecfMixData,
+                            CVector<int16_t>&                 vecsOutData,
+                            const int                         iCurNumAudChan,
+                            const int                         iNumClients )
+{
+    // the mix is accumulated in a float buffer and only clipped once at the
+    // end (in contrast to the reference implementation which clips after each
+    // added client)
+    const int iNumOutSamples = iCurNumAudChan * iServerFrameSizeSamples;
+
+    std::fill ( &vecfMixData[0], &vecfMixData[0] + iNumOutSamples, 0.0f );
+
+    for ( int j = 0; j < iNumClients; j++ )
+    {
+        const float fGain = static_cast<float> ( vecdGains[j] );
+
+        // a muted or silent client does not contribute to the mix
+        if ( ( fGain != 0.0f ) && ( vecSourceIsSilent[j] == 0 ) )
+        {
+            AddToMix ( vecfMixData, vecvecsData[j], vecNumAudioChannels[j], fGain, iCurNumAudChan );
+        }
+    }
+
+    MixKernels.ToShort ( &vecsOutData[0], &vecfMixData[0], iNumOutSamples );
+}
+
+/// @brief Mix all audio data from all clients together based on the shared
+/// bus mix (only the differences of the gain row to the bus gains are added).
+void CServer::ProcessDataBus ( const CVector<CVector<int16_t> >& vecvecsData,
+                               const int                         iClientIdx,
+                               const CVector<int>&               vecNumAudioChannels,
+                               CVector<float>&                   vecfMixData,
+                               CVector<int16_t>&                 vecsOutData,
+                               const int                         iCurNumAudChan )
+{
+    const int              iNumOutSamples = iCurNumAudChan * iServerFrameSizeSamples;
+    const CVector<float>&  vecfBusMix     = ( iCurNumAudChan == 1 ) ? vecfBusMixMono : vecfBusMixStereo;
+    const CVector<int>&    vecDeltaIdx    = vecvecBusDeltaIdx[iClientIdx];
+    const CVector<float>&  vecfDeltaGains = vecvecfBusDeltaGains[iClientIdx];
+
+    std::copy ( &vecfBusMix[0], &vecfBusMix[0] + iNumOutSamples, &vecfMixData[0] );
+
+    for ( int k = 0; k < vecBusNumDeltas[iClientIdx]; k++ )
+    {
+        const int j = vecDeltaIdx[k];
+
+        if ( vecSourceIsSilent[j] != 0 )
+        {
+            continue;
+        }
+
+        AddToMix ( vecfMixData, vecvecsData[j], vecNumAudioChannels[j], vecfDeltaGains[k], iCurNumAudChan );
+    }
+
+    MixKernels.ToShort ( &vecsOutData[0], &vecfMixData[0], iNumOutSamples );
+}
+
+void CServer::AddToMix ( CVector<float>&         vecfMixData,
+                         const CVector<int16_t>& vecsData,
+                         const int               iNumAudioChannels,
+                         const float             fGain,
+                         const int               iCurNumAudChan )
+{
+    if ( iCurNumAudChan == 1 )
+    {
+        if ( iNumAudioChannels == 1 )
+        {
+            MixKernels.AddMono ( &vecfMixData[0], &vecsData[0], fGain, iServerFrameSizeSamples );
+        }
+        else
+        {
+            MixKernels.AddStereoToMono ( &vecfMixData[0], &vecsData[0], fGain, iServerFrameSizeSamples );
+        }
+    }
+    else
+    {
+        if ( iNumAudioChannels == 1 )
+        {
+            MixKernels.AddMonoToStereo ( &vecfMixData[0], &vecsData[0], fGain, iServerFrameSizeSamples );
+        }
+        else
+        {
+            MixKernels.AddMono ( &vecfMixData[0], &vecsData[0], fGain, 2 * iServerFrameSizeSamples );
+        }
+    }
+}
+
+void CServer::UpdateBusMixDeltas ( const int iNumClients )
+{
+    int i, j;
+
+    // The bus gain of a source is the gain which most clients use for it
+    // (majority vote over the column of the gain matrix). Usually this is the
+    // fader value of 1 and only the own signal and a few changed faders of a
+    // client differ from the bus.
+    for ( j = 0; j < iNumClients; j++ )
+    {
+        double dCandidate = vecvecdGains[0][j];
+        int    iCount     = 0;
+
+        for ( i = 0; i < iNumClients; i++ )
+        {
+            if ( iCount == 0 )
+            {
+                dCandidate = vecvecdGains[i][j];
+                iCount     = 1;
+            }
+            else if ( vecvecdGains[i][j] == dCandidate )
+            {
+                iCount++;
+            }
+            else
+            {
+                iCount--;
+            }
+        }
+
+        vecdBusGains[j] = dCandidate;
+    }
+
+    // the deltas are correct for any bus gains, the majority vote only keeps
+    // the number of deltas small
+    for ( i = 0; i < iNumClients; i++ )
+    {
+        int iNumDeltas  = 0;
+        int iNumAudible = 0;
+
+        for ( j = 0; j < iNumClients; j++ )
+        {
+            const float fGain    = static_cast<float> ( vecvecdGains[i][j] );
+            const float fBusGain = static_cast<float> ( vecdBusGains[j] );
+
+            if ( fGain != 0.0f )
+            {
+                iNumAudible++;
+            }
+
+            if ( fGain != fBusGain )
+            {
+                vecvecBusDeltaIdx[i][iNumDeltas]    = j;
+                vecvecfBusDeltaGains[i][iNumDeltas] = fGain - fBusGain;
+                iNumDeltas++;
+            }
+        }
+
+        vecBusNumDeltas[i] = iNumDeltas;
+
+        // copying the bus costs about as much as adding one source
+        vecUseBusMix[i] = ( iNumDeltas + 1 < iNumAudible ) ? 1 : 0;
+    }
+}
+
+void CServer::CreateBusMixes ( const int iNumClients,
+                               const int iNumMixes )
+{
+    bool bNeedMono   = false;
+    bool bNeedStereo = false;
+
+    // only the bus formats are generated which are used by at least one mix
+    for ( int k = 0; k < iNumMixes; k++ )
+    {
+        const int iClientIdx = vecSharedMixClientIdx[k];
+
+        if ( vecUseBusMix[iClientIdx] != 0 )
+        {
+            if ( vecNumAudioChannels[iClientIdx] == 1 )
+            {
+                bNeedMono = true;
+            }
+            else
+            {
+                bNeedStereo = true;
+            }
+        }
+    }
+
+    if ( bNeedMono )
+    {
+        std::fill ( &vecfBusMixMono[0], &vecfBusMixMono[0] + iServerFrameSizeSamples, 0.0f );
+    }
+
+    if ( bNeedStereo )
+    {
+        std::fill ( &vecfBusMixStereo[0], &vecfBusMixStereo[0] + 2 * iServerFrameSizeSamples, 0.0f );
+    }
+
+    for ( int j = 0; j < iNumClients; j++ )
+    {
+        const float fBusGain = static_cast<float> ( vecdBusGains[j] );
+
+        if ( ( fBusGain == 0.0f ) || ( vecSourceIsSilent[j] != 0 ) )
+        {
+            continue;
+        }
+
+        if ( bNeedMono )
+        {
+            AddToMix ( vecfBusMixMono, vecvecsData[j], vecNumAudioChannels[j], fBusGain, 1 );
+        }
+
+        if ( bNeedStereo )
+        {
+            AddToMix ( vecfBusMixStereo, vecvecsData[j], vecNumAudioChannels[j], fBusGain, 2 );
+        }
+    }
+}
+
+/// @brief Mix all audio data from all clients together (scalar reference
+/// implementation which is bit-exact to the original server mix).
+void CServer::ProcessDataReference ( const CVector<CVector<int16_t> >& vecvecsData,
+                                     const CVector<double>&            vecdGains,
+                                     const CVector<int>&               vecNumAudioChannels,
+                                     CVector<int16_t>&                 vecsOutData,
+                                     const int                         iCurNumAudChan,
+                                     const int                         iNumClients )
+{
+    int i, j, k;
+
+    // init return vector with zeros since we mix all channels on that vector
+    vecsOutData.Reset ( 0 );
+
+    // distinguish between stereo and mono mode
+    if ( iCurNumAudChan == 1 )
+    {
+        // Mono target channel -------------------------------------------------
+        for ( j = 0; j < iNumClients; j++ )
+        {
+            // get a reference to the audio data and gain of the current client
+            const CVector<int16_t>& vecsData = vecvecsData[j];
+            const double            dGain    = vecdGains[j];
+
+            // if channel gain is 1, avoid multiplication for speed optimization
+            if ( dGain == static_cast<double> ( 1.0 ) )
+            {
+                if ( vecNumAudioChannels[j] == 1 )
                 {
                     // mono
                     for ( i = 0; i < iServerFrameSizeSamples; i++ )
@@ -1465,18 +2562,113 @@ CVector<CChannelInfo> CServer::CreateChannelList()
     return vecChanInfo;
 }
 
+bool CServer::UpdateChanInfoTable ( const CVector<CChannelInfo>& vecChanInfo,
+                                    CVector<CChannelInfo>&       vecChangedChanInfo,
+                                    CVector<int>&                veciRemovedChanIDs )
+{
+    const int    iNumChanInfo = vecChanInfo.Size();
+    CVector<int> vecIsInList ( iMaxNumChannels, false );
+
+    // added or changed channels
+    for ( int i = 0; i < iNumChanInfo; i++ )
+    {
+        const int iChanID = vecChanInfo[i].iChanID;
+
+        vecIsInList[iChanID] = true;
+
+        if ( !vecChanInfoTableUsed[iChanID] ||
+             ( vecChanInfoTable[iChanID].iIpAddr != vecChanInfo[i].iIpAddr ) ||
+             ( vecChanInfoTable[iChanID] != vecChanInfo[i] ) )
+        {
+            vecChanInfoTable[iChanID]     = vecChanInfo[i];
+            vecChanInfoTableUsed[iChanID] = true;
+            vecChangedChanInfo.Add ( vecChanInfo[i] );
+        }
+    }
+
+    // removed channels
+    for ( int i = 0; i < iMaxNumChannels; i++ )
+    {
+        if ( vecChanInfoTableUsed[i] && !vecIsInList[i] )
+        {
+            vecChanInfoTableUsed[i] = false;
+            veciRemovedChanIDs.Add ( i );
+        }
+    }
+
+    if ( ( vecChangedChanInfo.Size() > 0 ) || ( veciRemovedChanIDs.Size() > 0 ) )
+    {
+        iChanInfoTableVersion++;
+        return true;
+    }
+
+    return false;
+}
+
+void CServer::CreateAndSendChanListResetDelta ( const int iCurChanID )
+{
+    CVector<CChannelInfo> vecChanInfo ( 0 );
+
+    for ( int i = 0; i < iMaxNumChannels; i++ )
+    {
+        if ( vecChanInfoTableUsed[i] )
+        {
+            vecChanInfo.Add ( vecChanInfoTable[i] );
+        }
+    }
+
+    vecChannels[iCurChanID].CreateConClientListDeltaMes ( iChanInfoTableVersion,
+                                                          iChanInfoTableVersion,
+                                                          true,
+                                                          vecChanInfo,
+                                                          CVector<int> ( 0 ) );
+
+    vecChanListVersion[iCurChanID] = iChanInfoTableVersion;
+}
+
 void CServer::CreateAndSendChanListForAllConChannels()
 {
     // create channel list
     CVector<CChannelInfo> vecChanInfo ( CreateChannelList() );
 
+    // update the versioned table, clients which have the previous version of
+    // the table only get the changes
+    const int             iBaseVersion = iChanInfoTableVersion;
+    CVector<CChannelInfo> vecChangedChanInfo ( 0 );
+    CVector<int>          veciRemovedChanIDs ( 0 );
+
+    UpdateChanInfoTable ( vecChanInfo, vecChangedChanInfo, veciRemovedChanIDs );
+
     // now send connected channels list to all connected clients
     for ( int i = 0; i < iMaxNumChannels; i++ )
     {
         if ( vecChannels[i].IsConnected() )
         {
-            // send message
-            vecChannels[i].CreateConClientListMes ( vecChanInfo );
+            if ( vecChannels[i].ConClientListDeltasSupported() )
+            {
+                if ( vecChanListVersion[i] == iBaseVersion &&
+                     iBaseVersion != iChanInfoTableVersion )
+                {
+                    // send only the changes
+                    vecChannels[i].CreateConClientListDeltaMes ( iChanInfoTableVersion,
+                                                                 iBaseVersion,
+                                                                 false,
+                                                                 vecChangedChanInfo,
+                                                                 veciRemovedChanIDs );
+
+                    vecChanListVersion[i] = iChanInfoTableVersion;
+                }
+                else if ( vecChanListVersion[i] != iChanInfoTableVersion )
+                {
+                    // the client has an unknown version, send the complete list
+                    CreateAndSendChanListResetDelta ( i );
+                }
+            }
+            else
+            {
+                // old clients always get the complete list
+                vecChannels[i].CreateConClientListMes ( vecChanInfo );
+            }
         }
     }
 
@@ -1492,8 +2684,24 @@ void CServer::CreateAndSendChanListForThisChan ( const int iCurChanID )
     // create channel list
     CVector<CChannelInfo> vecChanInfo ( CreateChannelList() );
 
-    // now send connected channels list to the channel with the ID "iCurChanID"
-    vecChannels[iCurChanID].CreateConClientListMes ( vecChanInfo );
+    if ( vecChannels[iCurChanID].ConClientListDeltasSupported() )
+    {
+        // the table is usually up to date here, if not, the other clients
+        // get the complete list on the next change since their version does
+        // not match anymore
+        CVector<CChannelInfo> vecChangedChanInfo ( 0 );
+        CVector<int>          veciRemovedChanIDs ( 0 );
+
+        UpdateChanInfoTable ( vecChanInfo, vecChangedChanInfo, veciRemovedChanIDs );
+
+        // the client requested the list, i.e., it wants the complete list
+        CreateAndSendChanListResetDelta ( iCurChanID );
+    }
+    else
+    {
+        // now send connected channels list to the channel with the ID "iCurChanID"
+        vecChannels[iCurChanID].CreateConClientListMes ( vecChanInfo );
+    }
 }
 
 void CServer::CreateAndSendChatTextForAllConChannels ( const int      iCurChanID,
@@ -1567,29 +2775,35 @@ int CServer::FindChannel ( const CHostAddress& CheckAddr )
 {
     CHostAddress InetAddr;
 
-    // check for all possible channels if IP is already in use
-    for ( int i = 0; i < iMaxNumChannels; i++ )
+    // look up the channel in the address index (this must be done with the
+    // locked mutex)
+    QHash<CHostAddress, int>::iterator it = ChannelIDIndex.find ( CheckAddr );
+
+    if ( it != ChannelIDIndex.end() )
     {
+        const int iCurChanID = it.value();
+
         // the "GetAddress" gives a valid address and returns true if the
-        // channel is connected
-        if ( vecChannels[i].GetAddress ( InetAddr ) )
+        // channel is connected, an index entry is only valid if the channel
+        // is still connected with the same address
+        if ( vecChannels[iCurChanID].GetAddress ( InetAddr ) &&
+             ( InetAddr == CheckAddr ) )
         {
-            // IP found, return channel number
-            if ( InetAddr == CheckAddr )
-            {
-                return i;
-            }
+            return iCurChanID;
         }
+
+        // remove outdated index entry
+        ChannelIDIndex.erase ( it );
     }
 
     // IP not found, return invalid ID
     return INVALID_CHANNEL_ID;
 }
 
-void CServer::OnProtcolMessageReceived ( int              iRecCounter,
-                                         int              iRecID,
-                                         CVector<uint8_t> vecbyMesBodyData,
-                                         CHostAddress     RecHostAddr )
+void CServer::OnProtcolMessageReceived ( int          iRecCounter,
+                                         int          iRecID,
+                                         CMesBodyBuf  MesBodyBuf,
+                                         CHostAddress RecHostAddr )
 {
     Mutex.lock();
     {
@@ -1601,7 +2815,7 @@ void CServer::OnProtcolMessageReceived ( int              iRecCounter,
         {
             vecChannels[iCurChanID].PutProtcolData ( iRecCounter,
                                                      iRecID,
-                                                     vecbyMesBodyData,
+                                                     MesBodyBuf.GetData(),
                                                      RecHostAddr );
         }
     }
@@ -1613,67 +2827,130 @@ bool CServer::PutAudioData ( const CVector<uint8_t>& vecbyRecBuf,
                              const CHostAddress&     HostAdr,
                              int&                    iCurChanID )
 {
-    bool bNewConnection = false; // init return value
-    bool bChanOK        = true; // init with ok, might be overwritten
-
-    Mutex.lock();
+    bool bNewConnection  = false; // init return value
+    bool bChanOK         = true; // init with ok, might be overwritten
+    bool bChannelIsReset = false;
+
+    // Get channel ID ----------------------------------------------------------
+    // The packets of connected clients are assigned to their channels without
+    // locking the server mutex: the socket thread has its own address index
+    // and since the channel addresses are only set by this thread, an entry
+    // can be validated without a lock. Only a new client requires the mutex.
+    iCurChanID = INVALID_CHANNEL_ID;
+
+    QHash<CHostAddress, int>::const_iterator it = SocketChannelIDIndex.constFind ( HostAdr );
+
+    if ( ( it != SocketChannelIDIndex.constEnd() ) &&
+         vecChannels[it.value()].IsConnected() &&
+         ( vecChannels[it.value()].GetAddress() == HostAdr ) )
     {
-        // Get channel ID ------------------------------------------------------
-        // check address
-        iCurChanID = FindChannel ( HostAdr );
-
-        if ( iCurChanID == INVALID_CHANNEL_ID )
+        iCurChanID = it.value();
+    }
+    else
+    {
+        Mutex.lock();
         {
-            // a new client is calling, look for free channel
-            iCurChanID = GetFreeChan();
+            // check address
+            iCurChanID = FindChannel ( HostAdr );
 
-            if ( iCurChanID != INVALID_CHANNEL_ID )
+            if ( iCurChanID == INVALID_CHANNEL_ID )
             {
-                // initialize current channel by storing the calling host
-                // address
-                vecChannels[iCurChanID].SetAddress ( HostAdr );
+                // a new client is calling, look for free channel
+                iCurChanID = GetFreeChan();
 
-                // reset channel info
-                vecChannels[iCurChanID].ResetInfo();
-
-                // reset the channel gains of current channel, at the same
-                // time reset gains of this channel ID for all other channels
-                for ( int i = 0; i < iMaxNumChannels; i++ )
+                if ( iCurChanID != INVALID_CHANNEL_ID )
                 {
-                    vecChannels[iCurChanID].SetGain ( i, 1.0 );
+                    // initialize current channel by storing the calling host
+                    // address
+                    vecChannels[iCurChanID].SetAddress ( HostAdr );
+                    ChannelIDIndex.insert ( HostAdr, iCurChanID );
 
-                    // other channels (we do not distinguish the case if
-                    // i == iCurChanID for simplicity)
-                    vecChannels[i].SetGain ( iCurChanID, 1.0 );
+                    ResetNewChannel ( iCurChanID );
+                    bChannelIsReset = true;
+                }
+                else
+                {
+                    // no free channel available
+                    bChanOK = false;
                 }
             }
-            else
+        }
+        Mutex.unlock();
+
+        if ( bChanOK )
+        {
+            // the index of the socket thread only keeps the current address
+            // of each channel
+            QHash<CHostAddress, int>::iterator itOld = SocketChannelIDIndex.begin();
+
+            while ( itOld != SocketChannelIDIndex.end() )
             {
-                // no free channel available
-                bChanOK = false;
+                if ( itOld.value() == iCurChanID )
+                {
+                    itOld = SocketChannelIDIndex.erase ( itOld );
+                }
+                else
+                {
+                    ++itOld;
+                }
             }
+
+            SocketChannelIDIndex.insert ( HostAdr, iCurChanID );
         }
+    }
 
 
-        // Put received audio data in jitter buffer ----------------------------
-        if ( bChanOK )
+    // Put received audio data in jitter buffer --------------------------------
+    if ( bChanOK )
+    {
+        // put packet in socket buffer
+        if ( vecChannels[iCurChanID].PutAudioData ( vecbyRecBuf,
+                                                    iNumBytesRead,
+                                                    HostAdr ) == PS_NEW_CONNECTION )
         {
-            // put packet in socket buffer
-            if ( vecChannels[iCurChanID].PutAudioData ( vecbyRecBuf,
-                                                        iNumBytesRead,
-                                                        HostAdr ) == PS_NEW_CONNECTION )
+            // in case we have a new connection return this information
+            bNewConnection = true;
+
+            // if the channel was disconnected by the timer right after the
+            // lookup, the client reconnects on the same channel which
+            // therefore must be set up for the new connection now
+            if ( !bChannelIsReset )
             {
-                // in case we have a new connection return this information
-                bNewConnection = true;
+                Mutex.lock();
+                {
+                    ChannelIDIndex.insert ( HostAdr, iCurChanID );
+                    ResetNewChannel ( iCurChanID );
+                }
+                Mutex.unlock();
             }
+
+            // the channel is only processed by the audio frames after it is
+            // completely set up
+            vecChannels[iCurChanID].Connect();
         }
     }
-    Mutex.unlock();
 
     // return the state if a new connection was happening
     return bNewConnection;
 }
 
+void CServer::ResetNewChannel ( const int iChanID )
+{
+    // reset channel info
+    vecChannels[iChanID].ResetInfo();
+
+    // reset the channel gains of current channel, at the same
+    // time reset gains of this channel ID for all other channels
+    for ( int i = 0; i < iMaxNumChannels; i++ )
+    {
+        vecChannels[iChanID].SetGain ( i, 1.0 );
+
+        // other channels (we do not distinguish the case if
+        // i == iChanID for simplicity)
+        vecChannels[i].SetGain ( iChanID, 1.0 );
+    }
+}
+
 void CServer::GetConCliParam ( CVector<CHostAddress>& vecHostAddresses,
                                CVector<QString>&      vecsName,
                                CVector<int>&          veciJitBufNumFrames,
@@ -1708,6 +2985,21 @@ void CServer::StartStatusHTMLFileWriting ( const QString& strNewFileName,
     strServerHTMLFileListName = strNewFileName;
     strServerNameWithPort     = strNewServerNameWithPort;
 
+    // the timing statistics are periodically written in a JSON file in the
+    // same directory as the HTML status file
+    const QFileInfo HTMLFileInfo ( strNewFileName );
+
+    strTimingStatsFileName = HTMLFileInfo.absolutePath() + "/" +
+        HTMLFileInfo.completeBaseName() + "_timing.json";
+
+    TimingStats.SetFramePeriod ( static_cast<qint64> ( iServerFrameSizeSamples ) *
+                                 1000000000 / SYSTEM_SAMPLE_RATE_HZ );
+
+    iTimingStatsUpdateNumFrames = std::max ( 1, TIMING_STATS_FILE_UPDATE_MS *
+        SYSTEM_SAMPLE_RATE_HZ / 1000 / iServerFrameSizeSamples );
+
+    iTimingStatsFrameCnt = 0;
+
     // set flag
     bWriteStatusHTMLFile = true;
 
@@ -1716,9 +3008,38 @@ void CServer::StartStatusHTMLFileWriting ( const QString& strNewFileName,
 }
 
 void CServer::WriteHTMLChannelList()
+{
+    // the channel names are collected here, the file is written by the worker
+    QStringList slChanNames;
+
+    for ( int i = 0; i < iMaxNumChannels; i++ )
+    {
+        if ( vecChannels[i].IsConnected() )
+        {
+            QString strCurChanName = vecChannels[i].GetName();
+
+            // if text is empty, show IP address instead
+            if ( strCurChanName.isEmpty() )
+            {
+                // convert IP address to text and show it, remove last
+                // digits
+                strCurChanName = vecChannels[i].GetAddress().
+                    toString ( CHostAddress::SM_IP_NO_LAST_BYTE );
+            }
+
+            slChanNames << strCurChanName;
+        }
+    }
+
+    emit WriteHTMLStatusFile ( strServerHTMLFileListName, strServerNameWithPort, slChanNames );
+}
+
+void CServerSideEffectWorker::OnWriteHTMLStatusFile ( QString     strFileName,
+                                                      QString     strServerNameWithPort,
+                                                      QStringList slChanNames )
 {
     // prepare file and stream
-    QFile serverFileListFile ( strServerHTMLFileListName );
+    QFile serverFileListFile ( strFileName );
 
     if ( !serverFileListFile.open ( QIODevice::WriteOnly | QIODevice::Text ) )
     {
@@ -1729,7 +3050,7 @@ void CServer::WriteHTMLChannelList()
     streamFileOut << strServerNameWithPort << endl << "<ul>" << endl;
 
     // depending on number of connected clients write list
-    if ( GetNumberOfConnectedClients() == 0 )
+    if ( slChanNames.isEmpty() )
     {
         // no clients are connected -> empty server
         streamFileOut << "  No client connected" << endl;
@@ -1737,23 +3058,9 @@ void CServer::WriteHTMLChannelList()
     else
     {
         // write entry for each connected client
-        for ( int i = 0; i < iMaxNumChannels; i++ )
+        for ( int i = 0; i < slChanNames.size(); i++ )
         {
-            if ( vecChannels[i].IsConnected() )
-            {
-                QString strCurChanName = vecChannels[i].GetName();
-
-                // if text is empty, show IP address instead
-                if ( strCurChanName.isEmpty() )
-                {
-                    // convert IP address to text and show it, remove last
-                    // digits
-                    strCurChanName = vecChannels[i].GetAddress().
-                        toString ( CHostAddress::SM_IP_NO_LAST_BYTE );
-                }
-
-                streamFileOut << "  <li>" << strCurChanName << "</li>" << endl;
-            }
+            streamFileOut << "  <li>" << slChanNames[i] << "</li>" << endl;
         }
     }
 
@@ -1761,6 +3068,31 @@ void CServer::WriteHTMLChannelList()
     streamFileOut << "</ul>" << endl;
 }
 
+bool CServerSideEffectWorker::SetTimingStatsSnapshot ( const CServerTimingStats& TimingStats )
+{
+    // never block the frame processing, the histogram vectors of the snapshot
+    // have the same size so that the copy does not allocate memory
+    if ( !MutexTimingStats.tryLock() )
+    {
+        return false;
+    }
+
+    TimingStatsSnapshot = TimingStats;
+    MutexTimingStats.unlock();
+
+    return true;
+}
+
+void CServerSideEffectWorker::OnWriteTimingStatsFile ( QString strFileName )
+{
+    // the lock is only held for the copy, not while the file is written
+    MutexTimingStats.lock();
+    TimingStatsToWrite = TimingStatsSnapshot;
+    MutexTimingStats.unlock();
+
+    TimingStatsToWrite.WriteJsonFile ( strFileName );
+}
+
 void CServer::customEvent ( QEvent* pEvent )
 {
     if ( pEvent->type() == QEvent::User + 11 )
@@ -1779,45 +3111,55 @@ void CServer::customEvent ( QEvent* pEvent )
     }
 }
 
-/// @brief Compute frame peak level for each client
-void CServer::CreateLevelsForAllConChannels ( const int                        iNumClients,
-                                              const CVector<int>&              vecNumAudioChannels,
-                                              const CVector<CVector<int16_t> > vecvecsData,
-                                              CVector<uint16_t>&               vecLevelsOut )
+/// @brief Track the peak level of each client since the last level update
+void CServer::UpdatePeakLevelsForAllConChannels ( const int                         iNumClients,
+                                                  const CVector<int>&               vecNumAudioChannels,
+                                                  const CVector<CVector<int16_t> >& vecvecsData )
 {
-    int i, j, k;
-
-    // init return vector with zeros since we mix all channels on that vector
-    vecLevelsOut.Reset ( 0 );
-
-    for ( j = 0; j < iNumClients; j++ )
+    for ( int j = 0; j < iNumClients; j++ )
     {
-        // get a reference to the audio data
-        const CVector<int16_t>& vecsData = vecvecsData[j];
+        const int iChId = vecChanIDsCurConChan[j];
+        double    dCurLevel;
 
-        double dCurLevel = 0.0;
+        // the signal of a channel which was not decoded or whose decoder has
+        // not settled yet after skipped frames does not give a valid level
+        if ( veciChanNumDecodedFrames[iChId] < CHANNEL_LEVEL_SETTLING_FRAMES )
+        {
+            continue;
+        }
 
         if ( vecNumAudioChannels[j] == 1 )
         {
             // mono
-            for ( i = 0; i < iServerFrameSizeSamples; i += 3 )
-            {
-                dCurLevel = std::max ( dCurLevel, fabs ( static_cast<double> ( vecsData[i] ) ) );
-            }
+            dCurLevel = MixKernels.PeakMono ( &vecvecsData[j][0], iServerFrameSizeSamples );
         }
         else
         {
             // stereo: apply stereo-to-mono attenuation
-            for ( i = 0, k = 0; i < iServerFrameSizeSamples; i += 3, k += 6 )
-            {
-                double sMix = ( static_cast<double> ( vecsData[k] ) + vecsData[k + 1] ) / 2;
-                dCurLevel = std::max ( dCurLevel, fabs ( sMix ) );
-            }
+            dCurLevel = MixKernels.PeakStereoToMono ( &vecvecsData[j][0], iServerFrameSizeSamples ) / 2.0;
         }
 
-        // smoothing
+        vecdChanPeakLevels[iChId] = std::max ( vecdChanPeakLevels[iChId], dCurLevel );
+    }
+}
+
+/// @brief Compute the peak level for each client from the tracked peaks
+void CServer::CreateLevelsForAllConChannels ( const int          iNumClients,
+                                              CVector<uint16_t>& vecLevelsOut )
+{
+    // init return vector with zeros since we mix all channels on that vector
+    vecLevelsOut.Reset ( 0 );
+
+    for ( int j = 0; j < iNumClients; j++ )
+    {
         const int iChId = vecChanIDsCurConChan[j];
-        dCurLevel       = std::max ( dCurLevel, vecChannels[iChId].GetPrevLevel() * 0.5 );
+
+        // use the peak since the last update and start a new tracking interval
+        double dCurLevel = vecdChanPeakLevels[iChId];
+        vecdChanPeakLevels[iChId] = 0.0;
+
+        // smoothing
+        dCurLevel = std::max ( dCurLevel, vecChannels[iChId].GetPrevLevel() * 0.5 );
         vecChannels[iChId].SetPrevLevel ( dCurLevel );
 
         // logarithmic measure
@@ -28,7 +28,12 @@
 #include <QTimer>
 #include <QDateTime>
 #include <QHostAddress>
+#include <QFileInfo>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QWaitCondition>
 #include <algorithm>
+#include <climits>
 #ifdef USE_OPUS_SHARED_LIB
 # include "opus/opus_custom.h"
 #else
@@ -40,6 +45,7 @@
 #include "socket.h"
 #include "channel.h"
 #include "util.h"
+#include "mixkernels.h"
 #include "serverlogging.h"
 #include "serverlist.h"
 #include "multicolorledbar.h"
@@ -50,6 +56,13 @@
 // no valid channel number
 #define INVALID_CHANNEL_ID                  ( MAX_NUM_CHANNELS + 1 )
 
+// maximum number of threads used for the per-client mix/encode stage
+#define MAX_NUM_MIX_THREADS                 16
+
+// number of OPUS encoder/decoder types (OPUS and OPUS64, mono and stereo)
+#define NUM_OPUS_CODER_TYPES                4
+#define INVALID_OPUS_CODER_TYPE             -1
+
 
 /* Classes ********************************************************************/
 #if ( defined ( WIN32 ) || defined ( _WIN32 ) )
@@ -65,6 +78,13 @@ public:
     void Stop();
     bool isActive() const { return Timer.isActive(); }
 
+    // the wake-up lateness is not available for the QTimer implementation
+    int GetLastWakeUpLatenessNs() const { return 0; }
+
+    // the QTimer has no own thread, the settings are applied to the thread
+    // which processes the frames by the server
+    void SetRealTimeSettings ( const int, const QString& ) {}
+
 protected:
     QTimer       Timer;
     CVector<int> veciTimeOutIntervals;
@@ -97,16 +117,29 @@ public:
 
     void Start();
     void Stop();
-    bool isActive() { return bRun; }
+    bool isActive() { return bRun.loadAcquire() != 0; }
+
+    // time between the scheduled and the actual wake-up of the last timer event
+    int GetLastWakeUpLatenessNs() const { return iLastWakeUpLatenessNs.loadAcquire(); }
+
+    // must be called before Start(), the settings are applied by the thread
+    void SetRealTimeSettings ( const int      iNFIFOPriority,
+                               const QString& strNCPUs )
+        { iFIFOPriority = iNFIFOPriority; strCPUs = strNCPUs; }
 
 protected:
     virtual void run();
 
-    bool bRun;
+    QAtomicInt bRun;
+    QAtomicInt iLastWakeUpLatenessNs;
+    int        iFIFOPriority;
+    QString    strCPUs;
 
 # if defined ( __APPLE__ ) || defined ( __MACOSX )
     uint64_t Delay;
     uint64_t NextEnd;
+    uint64_t iTimeBaseNumer;
+    uint64_t iTimeBaseDenom;
 # else
     long     Delay;
     timespec NextEnd;
@@ -118,6 +151,64 @@ signals:
 #endif
 
 
+// worker thread for the per-client mix/encode stage of the server, the actual
+// work is done in the server object, this thread only waits for the next frame
+class CServer; // forward declaration
+
+class CServerMixThread : public QThread
+{
+public:
+    CServerMixThread ( CServer*       pNServer,
+                       const int      iNThreadIdx,
+                       const int      iNFIFOPriority,
+                       const QString& strNCPUs ) :
+        pServer ( pNServer ), iThreadIdx ( iNThreadIdx ),
+        iFIFOPriority ( iNFIFOPriority ), strCPUs ( strNCPUs ) {}
+
+protected:
+    virtual void run();
+
+    CServer* pServer;
+    int      iThreadIdx;
+    int      iFIFOPriority;
+    QString  strCPUs;
+};
+
+
+// worker for the side effects of the server which access files (status HTML
+// file, timing statistics, logging and history graph), the server posts the
+// events through queued signals so that a stalled disk does not delay the
+// frame processing
+class CServerSideEffectWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    CServerSideEffectWorker ( CServerLogging* pNLogging ) : pLogging ( pNLogging ) {}
+
+    // called by the frame processing: the statistics are copied in the snapshot
+    // which is written by the worker, returns false (and does not wait) if the
+    // worker is currently copying the last snapshot
+    bool SetTimingStatsSnapshot ( const CServerTimingStats& TimingStats );
+
+public slots:
+    void OnWriteHTMLStatusFile ( QString     strFileName,
+                                 QString     strServerNameWithPort,
+                                 QStringList slChanNames );
+
+    void OnWriteTimingStatsFile ( QString strFileName );
+
+    void OnLogNewConnection ( CHostAddress RecHostAddr ) { pLogging->AddNewConnection ( RecHostAddr.InetAddr ); }
+    void OnLogServerStopped() { pLogging->AddServerStopped(); }
+
+protected:
+    CServerLogging*    pLogging;
+    QMutex             MutexTimingStats;
+    CServerTimingStats TimingStatsSnapshot;
+    CServerTimingStats TimingStatsToWrite;
+};
+
+
 #if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
 template<unsigned int slotId>
 class CServerSlots : public CServerSlots<slotId - 1>
@@ -180,7 +271,18 @@ public:
               const bool         bNCentServPingServerInList,
               const bool         bNDisconnectAllClientsOnQuit,
               const bool         bNUseDoubleSystemFrameSize,
-              const ELicenceType eNLicenceType );
+              const ELicenceType eNLicenceType,
+              const int          iNNumMixThreads = 1,
+              const bool         bNUseReferenceMix = false,
+              const bool         bNUseBusMix = false,
+              const CMixKernels::EKernelType eNMixKernelType = CMixKernels::GetBestKernelType(),
+              const bool         bNRecordCompressed = false,
+              const int          iNRTPriority = 0,
+              const QString&     strNTimerCPUs = "",
+              const QString&     strNSocketCPUs = "",
+              const QString&     strNRecorderCPUs = "" );
+
+    virtual ~CServer();
 
     void Start();
     void Stop();
@@ -255,8 +357,13 @@ protected:
 
     int GetFreeChan();
     int FindChannel ( const CHostAddress& CheckAddr );
+    void ResetNewChannel ( const int iChanID );
     int GetNumberOfConnectedClients();
     CVector<CChannelInfo> CreateChannelList();
+    bool UpdateChanInfoTable ( const CVector<CChannelInfo>& vecChanInfo,
+                               CVector<CChannelInfo>&       vecChangedChanInfo,
+                               CVector<int>&                veciRemovedChanIDs );
+    void CreateAndSendChanListResetDelta ( const int iCurChanID );
 
 #if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
     virtual void CreateAndSendChanListForAllConChannels();
@@ -286,23 +393,94 @@ protected:
 
     void WriteHTMLChannelList();
 
+    void SendChannelLevels ( const int iNumClients );
+
+    void MixEncodeTransmitData ( const int         iClientIdx,
+                                 const int         iNumClients,
+                                 CVector<float>&   vecfMixData,
+                                 CVector<int16_t>& vecsSendData,
+                                 CVector<uint8_t>& vecbyCodedData );
+
+    int  GetOpusCoderType ( const EAudComprType eAudComprType,
+                            const int           iNumAudChan ) const;
+
+    OpusCustomEncoder* GetOpusEncoder ( const int           iChanID,
+                                        const EAudComprType eAudComprType,
+                                        const int           iNumAudChan );
+
+    OpusCustomDecoder* GetOpusDecoder ( const int           iChanID,
+                                        const EAudComprType eAudComprType,
+                                        const int           iNumAudChan );
+
+    void ReleaseOpusCoders ( const int iChanID );
+
+    bool UpdateGainMatrix ( const int iNumClients );
+
+    int  CreateSharedMixGroups ( const int  iNumClients,
+                                 const bool bGainMatrixChanged );
+    void SyncSharedMixEncoders ( const int iNumClients,
+                                 const int iNumMixes );
+    void HandOverEncoderStream ( const int iChanID,
+                                 const int iNumClients );
+    void CopyOpusEncoderState ( const int iType,
+                                const int iSrcChanID,
+                                const int iDestChanID );
+    void MixEncodeTransmitDataJobs ( const int iThreadIdx );
+    bool WaitForMixJob ( int& iLastMixJobFrame );
+    void FinishMixJob();
+
     void ProcessData ( const CVector<CVector<int16_t> >& vecvecsData,
                        const CVector<double>&            vecdGains,
                        const CVector<int>&               vecNumAudioChannels,
+                       CVector<float>&                   vecfMixData,
                        CVector<int16_t>&                 vecsOutData,
                        const int                         iCurNumAudChan,
                        const int                         iNumClients );
 
+    void ProcessDataBus ( const CVector<CVector<int16_t> >& vecvecsData,
+                          const int                         iClientIdx,
+                          const CVector<int>&               vecNumAudioChannels,
+                          CVector<float>&                   vecfMixData,
+                          CVector<int16_t>&                 vecsOutData,
+                          const int                         iCurNumAudChan );
+
+    void AddToMix ( CVector<float>&         vecfMixData,
+                    const CVector<int16_t>& vecsData,
+                    const int               iNumAudioChannels,
+                    const float             fGain,
+                    const int               iCurNumAudChan );
+
+    void UpdateBusMixDeltas ( const int iNumClients );
+    void CreateBusMixes ( const int iNumClients,
+                          const int iNumMixes );
+
+    void ProcessDataReference ( const CVector<CVector<int16_t> >& vecvecsData,
+                                const CVector<double>&            vecdGains,
+                                const CVector<int>&               vecNumAudioChannels,
+                                CVector<int16_t>&                 vecsOutData,
+                                const int                         iCurNumAudChan,
+                                const int                         iNumClients );
+
     virtual void customEvent ( QEvent* pEvent );
 
     // if server mode is normal or double system frame size
     bool                       bUseDoubleSystemFrameSize;
     int                        iServerFrameSizeSamples;
 
-    void CreateLevelsForAllConChannels  ( const int                        iNumClients,
-                                          const CVector<int>&              vecNumAudioChannels,
-                                          const CVector<CVector<int16_t> > vecvecsData,
-                                          CVector<uint16_t>&               vecLevelsOut );
+    // vectorized mix kernels (the scalar reference mix is used for testing)
+    bool                       bUseReferenceMix;
+    CMixKernels                MixKernels;
+
+    // optional bus mix: one weighted sum of all clients is shared by all mixes
+    // and each mix only adds the sparse differences of its gain row
+    bool                       bUseBusMix;
+
+    void UpdatePeakLevelsForAllConChannels ( const int                         iNumClients,
+                                             const CVector<int>&               vecNumAudioChannels,
+                                             const CVector<CVector<int16_t> >& vecvecsData );
+
+    void CreateLevelsForAllConChannels ( const int          iNumClients,
+                                         CVector<uint16_t>& vecLevelsOut );
 
     // do not use the vector class since CChannel does not have appropriate
     // copy constructor/operator
@@ -311,34 +489,98 @@ protected:
     CProtocol                  ConnLessProtocol;
     QMutex                     Mutex;
 
-    // audio encoder/decoder
-    OpusCustomMode*            Opus64Mode[MAX_NUM_CHANNELS];
-    OpusCustomEncoder*         Opus64EncoderMono[MAX_NUM_CHANNELS];
-    OpusCustomDecoder*         Opus64DecoderMono[MAX_NUM_CHANNELS];
-    OpusCustomEncoder*         Opus64EncoderStereo[MAX_NUM_CHANNELS];
-    OpusCustomDecoder*         Opus64DecoderStereo[MAX_NUM_CHANNELS];
-    OpusCustomMode*            OpusMode[MAX_NUM_CHANNELS];
-    OpusCustomEncoder*         OpusEncoderMono[MAX_NUM_CHANNELS];
-    OpusCustomDecoder*         OpusDecoderMono[MAX_NUM_CHANNELS];
-    OpusCustomEncoder*         OpusEncoderStereo[MAX_NUM_CHANNELS];
-    OpusCustomDecoder*         OpusDecoderStereo[MAX_NUM_CHANNELS];
+    // index from the address of a connected client to its channel ID (must
+    // only be accessed with the locked Mutex)
+    QHash<CHostAddress, int>   ChannelIDIndex;
+
+    // copy of the index which is only accessed by the socket thread so that
+    // the audio packets of connected clients are processed without locking
+    QHash<CHostAddress, int>   SocketChannelIDIndex;
+
+    // audio encoder/decoder (the modes are shared by all channels, the
+    // encoders/decoders are created on first use of a channel and are put
+    // in a pool if the channel disconnects, the pool and the per channel
+    // pointers must only be accessed by the timer thread)
+    OpusCustomMode*            OpusMode;
+    OpusCustomMode*            Opus64Mode;
+    OpusCustomEncoder*         OpusEncoders[MAX_NUM_CHANNELS][NUM_OPUS_CODER_TYPES];
+    OpusCustomDecoder*         OpusDecoders[MAX_NUM_CHANNELS][NUM_OPUS_CODER_TYPES];
+    std::vector<OpusCustomEncoder*> vecOpusEncoderPool[NUM_OPUS_CODER_TYPES];
+    std::vector<OpusCustomDecoder*> vecOpusDecoderPool[NUM_OPUS_CODER_TYPES];
+    std::vector<int>           vecChanIDsToRelease;
     CConvBuf<int16_t>          DoubleFrameSizeConvBufIn[MAX_NUM_CHANNELS];
     CConvBuf<int16_t>          DoubleFrameSizeConvBufOut[MAX_NUM_CHANNELS];
 
+    // versioned table of the connected clients list which was last sent to
+    // the clients, the list deltas are generated by comparing it with the
+    // current channel infos (the version each client has is stored, too)
+    CVector<CChannelInfo>      vecChanInfoTable;
+    CVector<int>               vecChanInfoTableUsed;
+    int                        iChanInfoTableVersion;
+    CVector<int>               vecChanListVersion;
+
     CVector<QString>           vstrChatColors;
     CVector<int>               vecChanIDsCurConChan;
 
     CVector<CVector<double> >  vecvecdGains;
+
+    // snapshot of the gains of all channels (indexed by the channel IDs), a row
+    // is only copied from its channel if the gain version has changed and
+    // "vecvecdGains" is only rebuilt if the snapshot, the connected channels or
+    // a fade-in have changed
+    CVector<CVector<double> >  vecvecdGainSnapshot;
+    CVector<int>               vecGainSnapshotVersion;
+    CVector<int>               vecGainMatrixChanIDs;
+    int                        iGainMatrixNumClients;
+    bool                       bGainMatrixFadeIn;
+
     CVector<CVector<int16_t> > vecvecsData;
     CVector<int>               vecNumAudioChannels;
     CVector<int>               vecNumFrameSizeConvBlocks;
     CVector<int>               vecUseDoubleSysFraSizeConvBuf;
     CVector<EAudComprType>     vecAudioComprType;
-    CVector<int16_t>           vecsSendData;
+    CVector<int>               vecSourceIsSilent;
+
+    // clients with identical mixes share one mix and encoder (the leader is
+    // the client index which generates the mix)
+    CVector<uint64_t>          vecGainRowHash;
+    CVector<int>               vecSharedMixLeader;
+    CVector<int>               vecSharedMixClientIdx;
+
+    // the decoder of a client is only in sync with the encoder which generated
+    // the packets it got, therefore we store for each channel the channel whose
+    // encoder generated its last packets (INVALID_CHANNEL_ID if the encoder of
+    // the channel was just started) and its coder type
+    CVector<int>               vecEncoderStreamChanID;
+    CVector<int>               vecEncoderStreamType;
+
+    // bus mix: the bus gain of each source is the most common gain of its
+    // column in the gain matrix, a client only uses the bus if its row has
+    // less deltas than audible sources (dense rows are mixed completely)
+    CVector<double>            vecdBusGains;
+    CVector<int>               vecUseBusMix;
+    CVector<int>               vecBusNumDeltas;
+    CVector<CVector<int> >     vecvecBusDeltaIdx;
+    CVector<CVector<float> >   vecvecfBusDeltaGains;
+    CVector<float>             vecfBusMixMono;
+    CVector<float>             vecfBusMixStereo;
+
     CVector<uint8_t>           vecbyCodedData;
 
-    // Channel levels
+    // per mix thread working buffers (index 0 is used by the timer thread)
+    CVector<CVector<float> >   vecvecfMixData;
+    CVector<CVector<int16_t> > vecvecsSendData;
+    CVector<CVector<uint8_t> > vecvecbyCodedData;
+
+    // Channel levels (the peak levels are tracked per channel ID), the level
+    // messages are generated by the timer thread in preallocated buffers
     CVector<uint16_t>          vecChannelLevels;
+    CVector<double>            vecdChanPeakLevels;
+    CVector<int>               veciChanNumDecodedFrames;
+    CVector<int>               veciLevelDeltaChanIDs;
+    CVector<uint16_t>          vecLevelDeltaLevels;
+    CVector<uint8_t>           vecbyLevelMesData;
+    CVector<uint8_t>           vecbyLevelMes;
 
     // actual working objects
     CHighPrioSocket            Socket;
@@ -358,6 +600,12 @@ protected:
     QString                    strServerHTMLFileListName;
     QString                    strServerNameWithPort;
 
+    // per frame timing statistics (written next to the HTML status file)
+    CServerTimingStats         TimingStats;
+    QString                    strTimingStatsFileName;
+    int                        iTimingStatsUpdateNumFrames;
+    int                        iTimingStatsFrameCnt;
+
     CHighPrecisionTimer        HighPrecisionTimer;
 
     // server list
@@ -373,19 +621,48 @@ protected:
 
     CSignalHandler*            pSignalHandler;
 
+    // per-client mix/encode worker threads
+    friend class CServerMixThread;
+    int                        iNumMixThreads;
+    CVector<CServerMixThread*> vecpMixThreads;
+    QMutex                     MutexMixJob;
+    QWaitCondition             MixJobStarted;
+    QWaitCondition             MixJobFinished;
+    bool                       bMixThreadsRun;
+    int                        iMixJobFrame;
+    int                        iMixJobNumPending;
+    int                        iMixJobNumClients;
+    int                        iMixJobNumMixes;
+    QAtomicInt                 iMixJobNextMix;
+
+    // real-time settings of the frame processing threads (SCHED_FIFO priority
+    // zero and an empty CPU list mean that the settings are not changed)
+    int                        iRTPriority;
+    QString                    strTimerCPUs;
+    bool                       bRealTimeSettingsApplied;
+
+    // the file accesses are done by a low priority worker thread
+    CServerSideEffectWorker    SideEffectWorker;
+    QThread                    SideEffectThread;
+
 signals:
     void Started();
     void Stopped();
     void ClientDisconnected ( const int iChID );
     void SvrRegStatusChanged();
-    void AudioFrame ( const int              iChID,
-                      const QString          stChName,
-                      const CHostAddress     RecHostAddr,
-                      const int              iNumAudChan,
-                      const CVector<int16_t> vecsData );
+
+    // side effects of the frame processing which are handled outside of it
+    void ConnectedChannelsChanged();
+    void WriteHTMLStatusFile ( QString     strFileName,
+                               QString     strServerNameWithPort,
+                               QStringList slChanNames );
+    void WriteTimingStatsFile ( QString strFileName );
+    void LogNewConnection ( CHostAddress RecHostAddr );
+    void LogServerStopped();
 
 public slots:
     void OnTimer();
+    void OnConnectedChannelsChanged() { CreateAndSendChanListForAllConChannels(); }
 
     void OnNewConnection ( int          iChID,
                            CHostAddress RecHostAddr );
@@ -395,14 +672,14 @@ public slots:
     void OnSendCLProtMessage ( CHostAddress     InetAddr,
                                CVector<uint8_t> vecMessage );
 
-    void OnProtcolCLMessageReceived ( int              iRecID,
-                                      CVector<uint8_t> vecbyMesBodyData,
-                                      CHostAddress     RecHostAddr );
+    void OnProtcolCLMessageReceived ( int          iRecID,
+                                      CMesBodyBuf  MesBodyBuf,
+                                      CHostAddress RecHostAddr );
 
-    void OnProtcolMessageReceived ( int              iRecCounter,
-                                    int              iRecID,
-                                    CVector<uint8_t> vecbyMesBodyData,
-                                    CHostAddress     RecHostAddr );
+    void OnProtcolMessageReceived ( int          iRecCounter,
+                                    int          iRecID,
+                                    CMesBodyBuf  MesBodyBuf,
+                                    CHostAddress RecHostAddr );
 
     void OnCLPingReceived ( CHostAddress InetAddr, int iMs )
         { ConnLessProtocol.CreateCLPingMes ( InetAddr, iMs ); }
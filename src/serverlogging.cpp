@@ -23,6 +23,9 @@
 \******************************************************************************/
 
 #include "serverlogging.h"
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSaveFile>
 
 // Server logging --------------------------------------------------------------
 CServerLogging::~CServerLogging()
@@ -164,3 +167,154 @@ QString CServerLogging::CurTimeDatetoLogString()
     // format date and time output according to "2006-09-30 11:38:08"
     return curDateTime.toString("yyyy-MM-dd HH:mm:ss");
 }
+
+
+// Timing histogram ------------------------------------------------------------
+void CTimingHistogram::Reset()
+{
+    veciBins.Reset ( 0 );
+    iCount = 0;
+    iSumNs = 0;
+    iMaxNs = 0;
+}
+
+void CTimingHistogram::Add ( const qint64 iDurationNs )
+{
+    // negative values may occur in case of clock adjustments, ignore them
+    if ( iDurationNs < 0 )
+    {
+        return;
+    }
+
+    const qint64 iBin = std::min ( iDurationNs / ( TIMING_STATS_BIN_WIDTH_US * 1000 ),
+                                   static_cast<qint64> ( TIMING_STATS_NUM_BINS - 1 ) );
+
+    veciBins[static_cast<int> ( iBin )]++;
+    iCount++;
+    iSumNs += iDurationNs;
+    iMaxNs  = std::max ( iMaxNs, iDurationNs );
+}
+
+QJsonObject CTimingHistogram::ToJson() const
+{
+    QJsonObject JsonObj;
+    QJsonArray  JsonBins;
+
+    // do not write the empty bins at the end of the histogram
+    int iNumUsedBins = veciBins.Size();
+
+    while ( ( iNumUsedBins > 0 ) && ( veciBins[iNumUsedBins - 1] == 0 ) )
+    {
+        iNumUsedBins--;
+    }
+
+    for ( int i = 0; i < iNumUsedBins; i++ )
+    {
+        JsonBins.append ( static_cast<double> ( veciBins[i] ) );
+    }
+
+    JsonObj["count"]  = static_cast<double> ( iCount );
+    JsonObj["avg_us"] = ( iCount > 0 ) ? static_cast<double> ( iSumNs ) / iCount / 1000 : 0.0;
+    JsonObj["max_us"] = static_cast<double> ( iMaxNs ) / 1000;
+    JsonObj["bins"]   = JsonBins;
+
+    return JsonObj;
+}
+
+
+// Server timing statistics ----------------------------------------------------
+void CServerTimingStats::Reset()
+{
+    for ( int i = 0; i < TP_NUM_PHASES; i++ )
+    {
+        Histograms[i].Reset();
+    }
+
+    iNumFrames         = 0;
+    iNumOverruns       = 0;
+    iNumClientMixes    = 0;
+    iNumEncodedMixes   = 0;
+    iNumSkippedDecodes = 0;
+    iNumSilentChannels = 0;
+}
+
+void CServerTimingStats::AddFrame ( const qint64 iFrameDurationNs,
+                                    const int    iNumClients,
+                                    const int    iNumMixes,
+                                    const int    iNNumSkippedDecodes,
+                                    const int    iNNumSilentChannels )
+{
+    Histograms[TP_FRAME].Add ( iFrameDurationNs );
+
+    iNumFrames++;
+
+    // the frame processing must be finished before the next timer event
+    if ( iFrameDurationNs > iFramePeriodNs )
+    {
+        iNumOverruns++;
+    }
+
+    // number of required mixes and number of actually encoded (not shared) mixes
+    iNumClientMixes  += iNumClients;
+    iNumEncodedMixes += iNumMixes;
+
+    // number of channels which were not decoded since nobody listens to them
+    // and number of silent channels which were not mixed
+    iNumSkippedDecodes += iNNumSkippedDecodes;
+    iNumSilentChannels += iNNumSilentChannels;
+}
+
+const char* CServerTimingStats::GetPhaseName ( const ETimingPhase eTimingPhase )
+{
+    switch ( eTimingPhase )
+    {
+    case TP_TIMER_LATENESS:
+        return "timer_lateness";
+
+    case TP_DECODE:
+        return "decode";
+
+    case TP_MIX_ENCODE:
+        return "mix_encode";
+
+    case TP_SEND:
+        return "send";
+
+    case TP_FRAME:
+        return "frame";
+
+    default:
+        return "unknown";
+    }
+}
+
+void CServerTimingStats::WriteJsonFile ( const QString& strFileName ) const
+{
+    QJsonObject JsonPhases;
+
+    for ( int i = 0; i < TP_NUM_PHASES; i++ )
+    {
+        JsonPhases[GetPhaseName ( static_cast<ETimingPhase> ( i ) )] = Histograms[i].ToJson();
+    }
+
+    QJsonObject JsonRoot;
+    JsonRoot["timestamp"]        = QDateTime::currentDateTime().toString ( Qt::ISODate );
+    JsonRoot["frame_period_us"]  = static_cast<double> ( iFramePeriodNs ) / 1000;
+    JsonRoot["bin_width_us"]     = TIMING_STATS_BIN_WIDTH_US;
+    JsonRoot["frames"]           = static_cast<double> ( iNumFrames );
+    JsonRoot["overruns"]         = static_cast<double> ( iNumOverruns );
+    JsonRoot["client_mixes"]     = static_cast<double> ( iNumClientMixes );
+    JsonRoot["encoded_mixes"]    = static_cast<double> ( iNumEncodedMixes );
+    JsonRoot["skipped_decodes"]  = static_cast<double> ( iNumSkippedDecodes );
+    JsonRoot["silent_channels"]  = static_cast<double> ( iNumSilentChannels );
+    JsonRoot["phases"]           = JsonPhases;
+
+    // the file is replaced atomically so that readers never see a partial file
+    QSaveFile File ( strFileName );
+
+    if ( File.open ( QIODevice::WriteOnly | QIODevice::Text ) )
+    {
+        File.write ( QJsonDocument ( JsonRoot ).toJson() );
+        File.commit();
+    }
+}
@@ -29,12 +29,87 @@
 #include <QFile>
 #include <QString>
 #include <QTimer>
+#include <QJsonObject>
 #include "global.h"
 #include "util.h"
 
 #include "historygraph.h"
 
+
+/* Definitions ****************************************************************/
+// histogram resolution and number of bins for the server timing statistics
+// (the last bin collects all values which do not fit in the other bins)
+#define TIMING_STATS_BIN_WIDTH_US        50
+#define TIMING_STATS_NUM_BINS            100
+
+// update interval of the server timing statistics file
+#define TIMING_STATS_FILE_UPDATE_MS      5000
+
+
 /* Classes ********************************************************************/
+// Histogram of durations ------------------------------------------------------
+class CTimingHistogram
+{
+public:
+    CTimingHistogram() : veciBins ( TIMING_STATS_NUM_BINS, 0 ) { Reset(); }
+
+    void Reset();
+    void Add ( const qint64 iDurationNs );
+    QJsonObject ToJson() const;
+
+protected:
+    CVector<qint64> veciBins;
+    qint64          iCount;
+    qint64          iSumNs;
+    qint64          iMaxNs;
+};
+
+
+// Per frame timing statistics of the server -----------------------------------
+class CServerTimingStats
+{
+public:
+    enum ETimingPhase
+    {
+        TP_TIMER_LATENESS, // wake-up lateness of the high precision timer
+        TP_DECODE,         // get data from jitter buffers and decode
+        TP_MIX_ENCODE,     // mix and encode for all clients
+        TP_SEND,           // send the audio packets
+        TP_FRAME,          // complete frame processing
+        TP_NUM_PHASES
+    };
+
+    CServerTimingStats() : iFramePeriodNs ( 0 ) { Reset(); }
+
+    void Reset();
+    void SetFramePeriod ( const qint64 iNFramePeriodNs ) { iFramePeriodNs = iNFramePeriodNs; }
+
+    void AddPhase ( const ETimingPhase eTimingPhase, const qint64 iDurationNs )
+        { Histograms[eTimingPhase].Add ( iDurationNs ); }
+
+    void AddFrame ( const qint64 iFrameDurationNs,
+                    const int    iNumClients,
+                    const int    iNumMixes,
+                    const int    iNNumSkippedDecodes,
+                    const int    iNNumSilentChannels );
+
+    void WriteJsonFile ( const QString& strFileName ) const;
+
+protected:
+    static const char* GetPhaseName ( const ETimingPhase eTimingPhase );
+
+    CTimingHistogram Histograms[TP_NUM_PHASES];
+    qint64           iFramePeriodNs;
+    qint64           iNumFrames;
+    qint64           iNumOverruns;
+    qint64           iNumClientMixes;
+    qint64           iNumEncodedMixes;
+    qint64           iNumSkippedDecodes;
+    qint64           iNumSilentChannels;
+};
+
+
+
 class CServerLogging
 {
 public:
@@ -44,6 +44,37 @@ void CSocket::Init ( const quint16 iPortNumber )
     // allocate memory for network receive and send buffer in samples
     vecbyRecBuf.Init ( MAX_SIZE_BYTES_NETW_BUF );
 
+#ifdef USE_SOCKET_BATCH_IO
+    // prepare the message headers for the batched receive and send calls (the
+    // buffers must not be reallocated afterwards since the headers point to
+    // them)
+    vecvecbyRecBatchBuf.Init ( NUM_SOCKET_BATCH_PACKETS );
+    vecbySendBatchBuf.Init   ( NUM_SOCKET_SEND_BATCH_PACKETS * MAX_SIZE_BYTES_BATCH_PACKET );
+    iNumSendBatchPackets.storeRelease ( 0 );
+
+    memset ( RecBatchMsg,  0, sizeof ( RecBatchMsg ) );
+    memset ( SendBatchMsg, 0, sizeof ( SendBatchMsg ) );
+
+    for ( int i = 0; i < NUM_SOCKET_BATCH_PACKETS; i++ )
+    {
+        vecvecbyRecBatchBuf[i].Init ( MAX_SIZE_BYTES_NETW_BUF );
+
+        RecBatchIov[i].iov_base            = &vecvecbyRecBatchBuf[i][0];
+        RecBatchIov[i].iov_len             = MAX_SIZE_BYTES_NETW_BUF;
+        RecBatchMsg[i].msg_hdr.msg_iov     = &RecBatchIov[i];
+        RecBatchMsg[i].msg_hdr.msg_iovlen  = 1;
+        RecBatchMsg[i].msg_hdr.msg_name    = &RecBatchAddr[i];
+    }
+
+    for ( int i = 0; i < NUM_SOCKET_SEND_BATCH_PACKETS; i++ )
+    {
+        SendBatchIov[i].iov_base           = &vecbySendBatchBuf[i * MAX_SIZE_BYTES_BATCH_PACKET];
+        SendBatchMsg[i].msg_hdr.msg_iov    = &SendBatchIov[i];
+        SendBatchMsg[i].msg_hdr.msg_iovlen = 1;
+        SendBatchMsg[i].msg_hdr.msg_name   = &SendBatchAddr[i];
+    }
+#endif
+
     // preinitialize socket in address (only the port number is missing)
     sockaddr_in UdpSocketInAddr;
     UdpSocketInAddr.sin_family      = AF_INET;
@@ -112,12 +143,12 @@ void CSocket::Init ( const quint16 iPortNumber )
         // client connections:
 
         QObject::connect ( this,
-            SIGNAL ( ProtcolMessageReceived ( int, int, CVector<uint8_t>, CHostAddress ) ),
-            pChannel, SLOT ( OnProtcolMessageReceived ( int, int, CVector<uint8_t>, CHostAddress ) ) );
+            SIGNAL ( ProtcolMessageReceived ( int, int, CMesBodyBuf, CHostAddress ) ),
+            pChannel, SLOT ( OnProtcolMessageReceived ( int, int, CMesBodyBuf, CHostAddress ) ) );
 
         QObject::connect ( this,
-            SIGNAL ( ProtcolCLMessageReceived ( int, CVector<uint8_t>, CHostAddress ) ),
-            pChannel, SLOT ( OnProtcolCLMessageReceived ( int, CVector<uint8_t>, CHostAddress ) ) );
+            SIGNAL ( ProtcolCLMessageReceived ( int, CMesBodyBuf, CHostAddress ) ),
+            pChannel, SLOT ( OnProtcolCLMessageReceived ( int, CMesBodyBuf, CHostAddress ) ) );
 
         QObject::connect ( this,
             SIGNAL ( NewConnection() ),
@@ -128,12 +159,12 @@ void CSocket::Init ( const quint16 iPortNumber )
         // server connections:
 
         QObject::connect ( this,
-            SIGNAL ( ProtcolMessageReceived ( int, int, CVector<uint8_t>, CHostAddress ) ),
-            pServer, SLOT ( OnProtcolMessageReceived ( int, int, CVector<uint8_t>, CHostAddress ) ) );
+            SIGNAL ( ProtcolMessageReceived ( int, int, CMesBodyBuf, CHostAddress ) ),
+            pServer, SLOT ( OnProtcolMessageReceived ( int, int, CMesBodyBuf, CHostAddress ) ) );
 
         QObject::connect ( this,
-            SIGNAL ( ProtcolCLMessageReceived ( int, CVector<uint8_t>, CHostAddress ) ),
-            pServer, SLOT ( OnProtcolCLMessageReceived ( int, CVector<uint8_t>, CHostAddress ) ) );
+            SIGNAL ( ProtcolCLMessageReceived ( int, CMesBodyBuf, CHostAddress ) ),
+            pServer, SLOT ( OnProtcolCLMessageReceived ( int, CMesBodyBuf, CHostAddress ) ) );
 
         QObject::connect ( this,
             SIGNAL ( NewConnection ( int, CHostAddress ) ),
@@ -199,6 +230,86 @@ void CSocket::SendPacket ( const CVector<uint8_t>& vecbySendBuf,
     }
 }
 
+void CSocket::QueuePacket ( const CVector<uint8_t>& vecbySendBuf,
+                            const CHostAddress&     HostAddr )
+{
+#ifdef USE_SOCKET_BATCH_IO
+    // Note that this function may be called concurrently by several threads
+    // (e.g. the mix threads of the server) but not concurrently with
+    // FlushPacketQueue(). Each caller reserves its own slot of the batch by
+    // incrementing the atomic counter so that no lock is required.
+    const int iVecSizeOut = vecbySendBuf.Size();
+
+    if ( iVecSizeOut <= 0 )
+    {
+        return;
+    }
+
+    // packets which do not fit in the batch buffer are sent directly
+    if ( iVecSizeOut > MAX_SIZE_BYTES_BATCH_PACKET )
+    {
+        SendPacket ( vecbySendBuf, HostAddr );
+        return;
+    }
+
+    const int iSlot = iNumSendBatchPackets.fetchAndAddOrdered ( 1 );
+
+    // if the batch is full, we fall back to the direct send
+    if ( iSlot >= NUM_SOCKET_SEND_BATCH_PACKETS )
+    {
+        SendPacket ( vecbySendBuf, HostAddr );
+        return;
+    }
+
+    // copy the packet in the batch buffer, the actual sending is done in
+    // FlushPacketQueue()
+    sockaddr_in& UdpSocketOutAddr = SendBatchAddr[iSlot];
+
+    UdpSocketOutAddr.sin_family      = AF_INET;
+    UdpSocketOutAddr.sin_port        = htons ( HostAddr.iPort );
+    UdpSocketOutAddr.sin_addr.s_addr = htonl ( HostAddr.InetAddr.toIPv4Address() );
+
+    memcpy ( SendBatchIov[iSlot].iov_base,
+             &vecbySendBuf[0],
+             iVecSizeOut );
+
+    SendBatchIov[iSlot].iov_len             = iVecSizeOut;
+    SendBatchMsg[iSlot].msg_hdr.msg_namelen = sizeof ( sockaddr_in );
+#else
+    // no batched send available, send packet immediately
+    SendPacket ( vecbySendBuf, HostAddr );
+#endif
+}
+
+void CSocket::FlushPacketQueue()
+{
+#ifdef USE_SOCKET_BATCH_IO
+    // the counter may exceed the batch size if packets were sent directly
+    const int iNumPackets = std::min ( iNumSendBatchPackets.loadAcquire(),
+                                       NUM_SOCKET_SEND_BATCH_PACKETS );
+    int       iNumPacketsSent = 0;
+
+    // sendmmsg might not send all packets at once, in that case the remaining
+    // packets are sent with the next call (on an error we drop the batch)
+    while ( iNumPacketsSent < iNumPackets )
+    {
+        const int iRet = sendmmsg ( UdpSocket,
+                                    &SendBatchMsg[iNumPacketsSent],
+                                    iNumPackets - iNumPacketsSent,
+                                    0 );
+
+        if ( iRet <= 0 )
+        {
+            break;
+        }
+
+        iNumPacketsSent += iRet;
+    }
+
+    iNumSendBatchPackets.storeRelease ( 0 );
+#endif
+}
+
 bool CSocket::GetAndResetbJitterBufferOKFlag()
 {
     // check jitter buffer status
@@ -224,6 +335,27 @@ void CSocket::OnDataReceived()
     use the signal/slot mechanism (i.e. we use messages for that).
 */
 
+#ifdef USE_SOCKET_BATCH_IO
+    // read all available blocks from the network interface with one system
+    // call (the call blocks until at least one block is received)
+    for ( int i = 0; i < NUM_SOCKET_BATCH_PACKETS; i++ )
+    {
+        RecBatchMsg[i].msg_hdr.msg_namelen = sizeof ( sockaddr_in );
+    }
+
+    const int iNumPackets = recvmmsg ( UdpSocket,
+                                       RecBatchMsg,
+                                       NUM_SOCKET_BATCH_PACKETS,
+                                       MSG_WAITFORONE,
+                                       nullptr );
+
+    for ( int i = 0; i < iNumPackets; i++ )
+    {
+        ProcessReceivedPacket ( vecvecbyRecBatchBuf[i],
+                                static_cast<int> ( RecBatchMsg[i].msg_len ),
+                                RecBatchAddr[i] );
+    }
+#else
     // read block from network interface and query address of sender
     sockaddr_in SenderAddr;
 #ifdef _WIN32
@@ -239,6 +371,16 @@ void CSocket::OnDataReceived()
                                           (sockaddr*) &SenderAddr,
                                           &SenderAddrSize );
 
+    ProcessReceivedPacket ( vecbyRecBuf,
+                            static_cast<int> ( iNumBytesRead ),
+                            SenderAddr );
+#endif
+}
+
+void CSocket::ProcessReceivedPacket ( const CVector<uint8_t>& vecbyBuf,
+                                      const int               iNumBytesRead,
+                                      const sockaddr_in&      SenderAddr )
+{
     // check if an error occurred or no data could be read
     if ( iNumBytesRead <= 0 )
     {
@@ -253,28 +395,24 @@ void CSocket::OnDataReceived()
     // check if this is a protocol message
     int              iRecCounter;
     int              iRecID;
-    CVector<uint8_t> vecbyMesBodyData;
+    CMesBodyBuf      MesBodyBuf;
 
-    if ( !CProtocol::ParseMessageFrame ( vecbyRecBuf,
+    if ( !CProtocol::ParseMessageFrame ( vecbyBuf,
                                          iNumBytesRead,
-                                         vecbyMesBodyData,
+                                         MesBodyBuf,
                                          iRecCounter,
                                          iRecID ) )
     {
         // this is a protocol message, check the type of the message
         if ( CProtocol::IsConnectionLessMessageID ( iRecID ) )
         {
-
-// TODO a copy of the vector is used -> avoid malloc in real-time routine
-
-            emit ProtcolCLMessageReceived ( iRecID, vecbyMesBodyData, RecHostAddr );
+            // note that the message body buffer is reference counted, the
+            // signal does not copy the data
+            emit ProtcolCLMessageReceived ( iRecID, MesBodyBuf, RecHostAddr );
         }
         else
         {
-
-// TODO a copy of the vector is used -> avoid malloc in real-time routine
-
-            emit ProtcolMessageReceived ( iRecCounter, iRecID, vecbyMesBodyData, RecHostAddr );
+            emit ProtcolMessageReceived ( iRecCounter, iRecID, MesBodyBuf, RecHostAddr );
         }
     }
     else
@@ -284,7 +422,7 @@ void CSocket::OnDataReceived()
         {
             // client:
 
-            switch ( pChannel->PutAudioData ( vecbyRecBuf, iNumBytesRead, RecHostAddr ) )
+            switch ( pChannel->PutAudioData ( vecbyBuf, iNumBytesRead, RecHostAddr ) )
             {
             case PS_AUDIO_ERR:
             case PS_GEN_ERROR:
@@ -312,7 +450,7 @@ void CSocket::OnDataReceived()
 
             int iCurChanID;
 
-            if ( pServer->PutAudioData ( vecbyRecBuf, iNumBytesRead, RecHostAddr, iCurChanID ) )
+            if ( pServer->PutAudioData ( vecbyBuf, iNumBytesRead, RecHostAddr, iCurChanID ) )
             {
                 // we have a new connection, emit a signal
                 emit NewConnection ( iCurChanID, RecHostAddr );
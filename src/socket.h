@@ -28,6 +28,7 @@
 #include <QMessageBox>
 #include <QThread>
 #include <QMutex>
+#include <QAtomicInt>
 #include <vector>
 #include "global.h"
 #include "protocol.h"
@@ -37,6 +38,11 @@
 # include <sys/socket.h>
 #endif
 
+// on Linux we use the batched socket calls recvmmsg/sendmmsg
+#if defined ( __linux__ ) && !defined ( ANDROID )
+# define USE_SOCKET_BATCH_IO
+#endif
+
 
 // The header files channel.h and server.h require to include this header file
 // so we get a cyclic dependency. To solve this issue, a prototype of the
@@ -49,6 +55,16 @@ class CChannel; // forward declaration of CChannel
 // number of ports we try to bind until we give up
 #define NUM_SOCKET_PORTS_TO_TRY         50
 
+// maximum number of packets which are received with one system call
+#define NUM_SOCKET_BATCH_PACKETS        64
+
+// maximum number of packets which are queued for one batched send (per frame
+// each client gets up to two audio packets and a channel level message)
+#define NUM_SOCKET_SEND_BATCH_PACKETS   ( 3 * MAX_NUM_CHANNELS )
+
+// maximum size of a packet in the send batch, larger packets are sent directly
+#define MAX_SIZE_BYTES_BATCH_PACKET     1500
+
 
 /* Classes ********************************************************************/
 /* Base socket class -------------------------------------------------------- */
@@ -74,12 +90,21 @@ public:
     void SendPacket ( const CVector<uint8_t>& vecbySendBuf,
                       const CHostAddress&     HostAddr );
 
+    void QueuePacket ( const CVector<uint8_t>& vecbySendBuf,
+                       const CHostAddress&     HostAddr );
+
+    void FlushPacketQueue();
+
     bool GetAndResetbJitterBufferOKFlag();
     void Close();
 
 protected:
     void Init ( const quint16 iPortNumber );
 
+    void ProcessReceivedPacket ( const CVector<uint8_t>& vecbyBuf,
+                                 const int               iNumBytesRead,
+                                 const sockaddr_in&      SenderAddr );
+
 #ifdef _WIN32
     SOCKET           UdpSocket;
 #else
@@ -90,6 +115,22 @@ protected:
 
     CVector<uint8_t> vecbyRecBuf;
     CHostAddress     RecHostAddr;
+
+#ifdef USE_SOCKET_BATCH_IO
+    // batched receive
+    CVector<CVector<uint8_t> > vecvecbyRecBatchBuf;
+    sockaddr_in      RecBatchAddr[NUM_SOCKET_BATCH_PACKETS];
+    iovec            RecBatchIov[NUM_SOCKET_BATCH_PACKETS];
+    mmsghdr          RecBatchMsg[NUM_SOCKET_BATCH_PACKETS];
+
+    // batched send (the slots are reserved with the atomic counter so that
+    // several threads can queue packets without locking)
+    CVector<uint8_t> vecbySendBatchBuf;
+    sockaddr_in      SendBatchAddr[NUM_SOCKET_SEND_BATCH_PACKETS];
+    iovec            SendBatchIov[NUM_SOCKET_SEND_BATCH_PACKETS];
+    mmsghdr          SendBatchMsg[NUM_SOCKET_SEND_BATCH_PACKETS];
+    QAtomicInt       iNumSendBatchPackets;
+#endif
     QHostAddress     SenderAddress;
     quint16          SenderPort;
 
@@ -113,14 +154,14 @@ signals:
 
     void InvalidPacketReceived ( CHostAddress RecHostAddr );
 
-    void ProtcolMessageReceived ( int              iRecCounter,
-                                  int              iRecID,
-                                  CVector<uint8_t> vecbyMesBodyData,
-                                  CHostAddress     HostAdr );
+    void ProtcolMessageReceived ( int          iRecCounter,
+                                  int          iRecID,
+                                  CMesBodyBuf  MesBodyBuf,
+                                  CHostAddress HostAdr );
 
-    void ProtcolCLMessageReceived ( int              iRecID,
-                                    CVector<uint8_t> vecbyMesBodyData,
-                                    CHostAddress     HostAdr );
+    void ProtcolCLMessageReceived ( int          iRecID,
+                                    CMesBodyBuf  MesBodyBuf,
+                                    CHostAddress HostAdr );
 };
 
 
@@ -154,12 +195,23 @@ public:
         NetworkWorkerThread.start ( QThread::TimeCriticalPriority );
     }
 
+    // must be called before Start(), the affinity is applied by the thread
+    void SetThreadCPUs ( const QString& strCPUs ) { NetworkWorkerThread.SetCPUs ( strCPUs ); }
+
     void SendPacket ( const CVector<uint8_t>& vecbySendBuf,
                       const CHostAddress&     HostAddr )
     {
         Socket.SendPacket ( vecbySendBuf, HostAddr );
     }
 
+    void QueuePacket ( const CVector<uint8_t>& vecbySendBuf,
+                       const CHostAddress&     HostAddr )
+    {
+        Socket.QueuePacket ( vecbySendBuf, HostAddr );
+    }
+
+    void FlushPacketQueue() { Socket.FlushPacketQueue(); }
+
     bool GetAndResetbJitterBufferOKFlag()
     {
         return Socket.GetAndResetbJitterBufferOKFlag();
@@ -185,9 +237,12 @@ protected:
         }
 
         void SetSocket ( CSocket* pNewSocket ) { pSocket = pNewSocket; }
+        void SetCPUs ( const QString& strNewCPUs ) { strCPUs = strNewCPUs; }
 
     protected:
         void run() {
+            CRealTimeUtil::ApplyToCurrentThread ( "socket", 0, strCPUs );
+
             // make sure the socket pointer is initialized (should be always the
             // case)
             if ( pSocket != nullptr )
@@ -203,6 +258,7 @@ protected:
 
         CSocket* pSocket;
         bool     bRun;
+        QString  strCPUs;
     };
 
     void Init()
@@ -29,12 +29,56 @@
 #include <QDateTime>
 #include <QUdpSocket>
 #include <QHostAddress>
+#include <QElapsedTimer>
+#include <QCoreApplication>
+#include <QTemporaryFile>
+#include <QtEndian>
 #include "global.h"
 #include "socket.h"
 #include "protocol.h"
+#include "channel.h"
+#include "client.h"
+#include "server.h"
 #include "util.h"
 
 
+/* Definitions ****************************************************************/
+// number of synthetic clients which are added in each load test stage
+#define LOAD_TEST_CLIENT_STEP            2
+
+// duration of the load test stages (the warm-up must be longer than the audio
+// fade-in of the server)
+#define LOAD_TEST_WARMUP_MS              4000
+#define LOAD_TEST_MEASURE_MS             10000
+#define LOAD_TEST_PAUSE_MS               3000
+
+// criteria for a sustainable number of clients
+#define LOAD_TEST_MAX_LOSS_RATE          0.01
+#define LOAD_TEST_MAX_JITTER_FRAMES      0.5
+
+// the probe client sends a click in this interval and measures the time until
+// the click is detected in the mix it gets back from the server
+#define LOAD_TEST_PROBE_INTERVAL_MS      500
+#define LOAD_TEST_PROBE_THRESHOLD        10000
+#define LOAD_TEST_PROBE_AMPLITUDE        30000
+#define LOAD_TEST_SINE_AMPLITUDE         200
+#define LOAD_TEST_TWO_PI                 6.283185307179586
+
+// CRC benchmark: number of messages and their maximum length
+#define CRC_BENCHMARK_NUM_MESSAGES       200000
+#define CRC_BENCHMARK_MAX_MESSAGE_LEN    200
+
+// mix kernel benchmark: number of mixed sources (alternately mono and stereo),
+// samples per frame and number of mixed frames for the speed measurement
+#define MIX_BENCHMARK_NUM_SOURCES        8
+#define MIX_BENCHMARK_FRAME_SIZE         DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES
+#define MIX_BENCHMARK_NUM_FRAMES         20000
+
+// WAV checkpoint test: number of stereo sample pairs written between the
+// checkpoints
+#define WAV_CHECKPOINT_TEST_NUM_SAMPLES  4800
+
+
 /* Classes ********************************************************************/
 class CTestbench : public QObject
 {
@@ -296,3 +340,1050 @@ public slots:
         Protocol.Reset();
     }
 };
+
+
+// Synthetic client for the server load test ----------------------------------
+// Sends a mono OPUS/OPUS64 audio stream with the correct frame cadence (the
+// frames are triggered by the load test), answers the protocol messages of
+// the server with a regular client channel and collects statistics about the
+// mix it receives from the server. The probe client additionally measures the
+// audio latency through the server by sending clicks.
+class CLoadTestClient : public QObject
+{
+    Q_OBJECT
+
+public:
+    CLoadTestClient ( const CHostAddress& NServerAddr,
+                      const EAudComprType eNAudComprType,
+                      const bool          bNIsProbe,
+                      const int           iClientIdx ) :
+        Channel          ( false ), // client channel
+        ServerAddr       ( NServerAddr ),
+        bIsProbe         ( bNIsProbe ),
+        vecbyRecBuf      ( MAX_SIZE_BYTES_NETW_BUF ),
+        dSinePhase       ( 0 ),
+        dSinePhaseInc    ( LOAD_TEST_TWO_PI * ( 220 + 20 * iClientIdx ) / SYSTEM_SAMPLE_RATE_HZ )
+    {
+        int iOpusError;
+
+        // OPUS uses 128 samples frames, OPUS64 uses 64 samples frames
+        if ( eNAudComprType == CT_OPUS )
+        {
+            iFrameSizeSamples = DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES;
+            iCodedBytes       = OPUS_NUM_BYTES_MONO_NORMAL_QUALITY_DBLE_FRAMESIZE;
+        }
+        else
+        {
+            iFrameSizeSamples = SYSTEM_FRAME_SIZE_SAMPLES;
+            iCodedBytes       = OPUS_NUM_BYTES_MONO_NORMAL_QUALITY;
+        }
+
+        dFramePeriodMs = 1000.0 * iFrameSizeSamples / SYSTEM_SAMPLE_RATE_HZ;
+
+        OpusMode    = opus_custom_mode_create ( SYSTEM_SAMPLE_RATE_HZ, iFrameSizeSamples, &iOpusError );
+        OpusEncoder = opus_custom_encoder_create ( OpusMode, 1, &iOpusError );
+        OpusDecoder = opus_custom_decoder_create ( OpusMode, 1, &iOpusError );
+
+        opus_custom_encoder_ctl ( OpusEncoder, OPUS_SET_VBR ( 0 ) );
+        opus_custom_encoder_ctl ( OpusEncoder, OPUS_SET_APPLICATION ( OPUS_APPLICATION_RESTRICTED_LOWDELAY ) );
+
+        vecsAudio.Init    ( iFrameSizeSamples );
+        vecbyCoded.Init   ( iCodedBytes );
+
+        // the server decodes the mix with the same properties
+        Channel.SetAudioStreamProperties ( eNAudComprType, iCodedBytes, 1, 1 );
+        Channel.SetAddress ( ServerAddr );
+        Channel.SetEnable ( true );
+
+        ChannelInfo.strName = QString ( "loadtest %1" ).arg ( iClientIdx );
+
+        // each client gets its own local port number
+        UdpSocket.bind ( QHostAddress ( QHostAddress::Any ), 0 );
+
+        QObject::connect ( &UdpSocket, SIGNAL ( readyRead() ),
+            this, SLOT ( OnReadyRead() ) );
+
+        QObject::connect ( &Channel, SIGNAL ( MessReadyForSending ( CVector<uint8_t> ) ),
+            this, SLOT ( OnSendProtMessage ( CVector<uint8_t> ) ) );
+
+        QObject::connect ( &Channel, SIGNAL ( ReqJittBufSize() ),
+            this, SLOT ( OnReqJittBufSize() ) );
+
+        QObject::connect ( &Channel, SIGNAL ( ReqChanInfo() ),
+            this, SLOT ( OnReqChanInfo() ) );
+
+        QObject::connect ( &ConnLessProtocol,
+            SIGNAL ( CLMessReadyForSending ( CHostAddress, CVector<uint8_t> ) ),
+            this, SLOT ( OnSendCLProtMessage ( CHostAddress, CVector<uint8_t> ) ) );
+
+        ResetStatistics();
+    }
+
+    virtual ~CLoadTestClient()
+    {
+        // tell the server that we are gone so that it does not have to wait
+        // for the time-out
+        ConnLessProtocol.CreateCLDisconnection ( ServerAddr );
+
+        opus_custom_encoder_destroy ( OpusEncoder );
+        opus_custom_decoder_destroy ( OpusDecoder );
+        opus_custom_mode_destroy ( OpusMode );
+    }
+
+    void SendAudioFrame()
+    {
+        if ( bIsProbe )
+        {
+            // silence with a click at the beginning of the frame in the probe interval
+            vecsAudio.Reset ( 0 );
+
+            if ( !bProbePending && ( ProbeTimer.elapsed() >= LOAD_TEST_PROBE_INTERVAL_MS ) )
+            {
+                for ( int i = 0; i < iFrameSizeSamples / 4; i++ )
+                {
+                    vecsAudio[i] = ( i % 2 ) ? LOAD_TEST_PROBE_AMPLITUDE : -LOAD_TEST_PROBE_AMPLITUDE;
+                }
+
+                bProbePending  = true;
+                iProbeSentNs   = StatTimer.nsecsElapsed();
+                ProbeTimer.start();
+                iNumProbesSent++;
+            }
+            else if ( bProbePending && ( ProbeTimer.elapsed() >= LOAD_TEST_PROBE_INTERVAL_MS ) )
+            {
+                // the click was not detected, give up this probe
+                bProbePending = false;
+            }
+        }
+        else
+        {
+            // quiet sine so that the probe click can still be detected in the mix
+            for ( int i = 0; i < iFrameSizeSamples; i++ )
+            {
+                vecsAudio[i] = static_cast<int16_t> ( LOAD_TEST_SINE_AMPLITUDE * sin ( dSinePhase ) );
+                dSinePhase  += dSinePhaseInc;
+            }
+
+            dSinePhase = fmod ( dSinePhase, LOAD_TEST_TWO_PI );
+        }
+
+        opus_custom_encode ( OpusEncoder,
+                             &vecsAudio[0],
+                             iFrameSizeSamples,
+                             &vecbyCoded[0],
+                             iCodedBytes );
+
+        UdpSocket.writeDatagram ( (const char*) &vecbyCoded[0],
+                                  iCodedBytes,
+                                  ServerAddr.InetAddr,
+                                  ServerAddr.iPort );
+    }
+
+    void ResetStatistics()
+    {
+        StatTimer.start();
+        ProbeTimer.start();
+
+        iNumReceived   = 0;
+        iLastRecNs     = 0;
+        dJitterMs      = 0;
+        dMaxGapMs      = 0;
+        bProbePending  = false;
+        iProbeSentNs   = 0;
+        iNumProbesSent = 0;
+        vecdLatenciesMs.clear();
+    }
+
+    // fraction of the expected mix packets which were not received
+    double GetLossRate() const
+    {
+        const double dNumExpected = StatTimer.nsecsElapsed() / 1000000.0 / dFramePeriodMs;
+
+        return ( dNumExpected > 0 ) ? std::max ( 0.0, 1.0 - iNumReceived / dNumExpected ) : 0.0;
+    }
+
+    double GetJitterMs() const { return dJitterMs; }
+    double GetMaxGapMs() const { return dMaxGapMs; }
+    double GetFramePeriodMs() const { return dFramePeriodMs; }
+    int    GetNumProbesSent() const { return iNumProbesSent; }
+    const std::vector<double>& GetLatenciesMs() const { return vecdLatenciesMs; }
+
+protected:
+    void OnAudioPacketReceived ( const int iNumBytes )
+    {
+        const qint64 iCurNs = StatTimer.nsecsElapsed();
+
+        // inter-arrival jitter as defined in RFC 3550
+        if ( iNumReceived > 0 )
+        {
+            const double dGapMs = static_cast<double> ( iCurNs - iLastRecNs ) / 1000000;
+
+            dJitterMs += ( fabs ( dGapMs - dFramePeriodMs ) - dJitterMs ) / 16;
+            dMaxGapMs  = std::max ( dMaxGapMs, dGapMs );
+        }
+
+        iNumReceived++;
+        iLastRecNs = iCurNs;
+
+        // the probe client looks for its click in the mix
+        if ( bIsProbe && bProbePending && ( iNumBytes == iCodedBytes ) )
+        {
+            opus_custom_decode ( OpusDecoder,
+                                 &vecbyRecBuf[0],
+                                 iNumBytes,
+                                 &vecsAudio[0],
+                                 iFrameSizeSamples );
+
+            for ( int i = 0; i < iFrameSizeSamples; i++ )
+            {
+                if ( abs ( vecsAudio[i] ) > LOAD_TEST_PROBE_THRESHOLD )
+                {
+                    vecdLatenciesMs.push_back ( static_cast<double> ( iCurNs - iProbeSentNs ) / 1000000 );
+                    bProbePending = false;
+                    break;
+                }
+            }
+        }
+    }
+
+    CChannel            Channel;
+    CProtocol           ConnLessProtocol;
+    CChannelCoreInfo    ChannelInfo;
+    CHostAddress        ServerAddr;
+    bool                bIsProbe;
+    QUdpSocket          UdpSocket;
+    CVector<uint8_t>    vecbyRecBuf;
+
+    OpusCustomMode*     OpusMode;
+    OpusCustomEncoder*  OpusEncoder;
+    OpusCustomDecoder*  OpusDecoder;
+    int                 iFrameSizeSamples;
+    int                 iCodedBytes;
+    double              dFramePeriodMs;
+    CVector<int16_t>    vecsAudio;
+    CVector<uint8_t>    vecbyCoded;
+    double              dSinePhase;
+    double              dSinePhaseInc;
+
+    // statistics
+    QElapsedTimer       StatTimer;
+    QElapsedTimer       ProbeTimer;
+    qint64              iNumReceived;
+    qint64              iLastRecNs;
+    double              dJitterMs;
+    double              dMaxGapMs;
+    bool                bProbePending;
+    qint64              iProbeSentNs;
+    int                 iNumProbesSent;
+    std::vector<double> vecdLatenciesMs;
+
+public slots:
+    void OnReadyRead()
+    {
+        while ( UdpSocket.hasPendingDatagrams() )
+        {
+            QHostAddress SenderAddr;
+            quint16      iSenderPort;
+
+            const int iNumBytes = static_cast<int> ( UdpSocket.readDatagram (
+                (char*) &vecbyRecBuf[0], MAX_SIZE_BYTES_NETW_BUF, &SenderAddr, &iSenderPort ) );
+
+            if ( iNumBytes <= 0 )
+            {
+                continue;
+            }
+
+            // protocol messages are handled by the channel, all other packets
+            // are audio packets
+            int         iRecCounter;
+            int         iRecID;
+            CMesBodyBuf MesBodyBuf;
+
+            if ( !CProtocol::ParseMessageFrame ( vecbyRecBuf,
+                                                 iNumBytes,
+                                                 MesBodyBuf,
+                                                 iRecCounter,
+                                                 iRecID ) )
+            {
+                if ( !CProtocol::IsConnectionLessMessageID ( iRecID ) )
+                {
+                    Channel.PutProtcolData ( iRecCounter,
+                                             iRecID,
+                                             MesBodyBuf.GetData(),
+                                             CHostAddress ( SenderAddr, iSenderPort ) );
+                }
+            }
+            else
+            {
+                OnAudioPacketReceived ( iNumBytes );
+            }
+        }
+    }
+
+    void OnSendProtMessage ( CVector<uint8_t> vecMessage )
+    {
+        UdpSocket.writeDatagram ( (const char*) &vecMessage[0],
+                                  vecMessage.Size(),
+                                  ServerAddr.InetAddr,
+                                  ServerAddr.iPort );
+    }
+
+    void OnSendCLProtMessage ( CHostAddress InetAddr, CVector<uint8_t> vecMessage )
+    {
+        UdpSocket.writeDatagram ( (const char*) &vecMessage[0],
+                                  vecMessage.Size(),
+                                  InetAddr.InetAddr,
+                                  InetAddr.iPort );
+    }
+
+    void OnReqJittBufSize() { Channel.CreateJitBufMes ( DEF_NET_BUF_SIZE_NUM_BL ); }
+    void OnReqChanInfo() { Channel.SetRemoteInfo ( ChannelInfo ); }
+};
+
+
+// Server load test ------------------------------------------------------------
+// Connects an increasing number of synthetic clients to a running server for
+// the OPUS64 (64 samples) and the OPUS (128 samples) frame size modes and
+// reports the maximum number of clients for which the mixes still arrive
+// without significant loss and jitter. To get the number of clients per CPU
+// core, the server should run with one mix thread pinned to one core.
+class CLoadTestbench : public QObject
+{
+    Q_OBJECT
+
+public:
+    CLoadTestbench ( const CHostAddress& NServerAddr,
+                     const int           iNMaxNumClients ) :
+        ServerAddr      ( NServerAddr ),
+        iMaxNumClients  ( iNMaxNumClients ),
+        iCurMode        ( 0 ),
+        bIsMeasuring    ( false ),
+        pFrameTimer     ( nullptr ),
+        tsConsole       ( *( ( new ConsoleWriterFactory() )->get() ) )
+    {
+        vecAudComprTypes.push_back ( CT_OPUS64 );
+        vecAudComprTypes.push_back ( CT_OPUS );
+
+        StageTimer.setSingleShot ( true );
+
+        QObject::connect ( &StageTimer, SIGNAL ( timeout() ),
+            this, SLOT ( OnStageTimer() ) );
+
+        StartMode();
+    }
+
+    virtual ~CLoadTestbench() { StopMode(); }
+
+protected:
+    void StartMode()
+    {
+        iMaxSustainableClients = 0;
+
+        tsConsole << "Load test of server " << ServerAddr.toString() << " with " <<
+            GetModeName() << endl;
+
+        // the frame timer triggers the audio frames of all clients
+        pFrameTimer = new CHighPrecisionTimer ( vecAudComprTypes[iCurMode] == CT_OPUS );
+
+        QObject::connect ( pFrameTimer, SIGNAL ( timeout() ),
+            this, SLOT ( OnFrameTimer() ) );
+
+        pFrameTimer->Start();
+
+        StartStage();
+    }
+
+    void StopMode()
+    {
+        if ( pFrameTimer != nullptr )
+        {
+            pFrameTimer->Stop();
+            delete pFrameTimer;
+            pFrameTimer = nullptr;
+        }
+
+        // deleting the clients disconnects them from the server
+        for ( size_t i = 0; i < vecpClients.size(); i++ )
+        {
+            delete vecpClients[i];
+        }
+
+        vecpClients.clear();
+    }
+
+    void StartStage()
+    {
+        // add the next clients (the first client is the probe client)
+        const int iNewNumClients = std::min ( static_cast<int> ( vecpClients.size() ) + LOAD_TEST_CLIENT_STEP,
+                                              iMaxNumClients );
+
+        while ( static_cast<int> ( vecpClients.size() ) < iNewNumClients )
+        {
+            vecpClients.push_back ( new CLoadTestClient ( ServerAddr,
+                                                          vecAudComprTypes[iCurMode],
+                                                          vecpClients.empty(),
+                                                          static_cast<int> ( vecpClients.size() ) ) );
+        }
+
+        bIsMeasuring = false;
+        StageTimer.start ( LOAD_TEST_WARMUP_MS );
+    }
+
+    bool EvaluateStage()
+    {
+        const int iNumClients = static_cast<int> ( vecpClients.size() );
+        double    dMaxLoss    = 0;
+        double    dMaxJitter  = 0;
+        double    dMaxGap     = 0;
+
+        for ( int i = 0; i < iNumClients; i++ )
+        {
+            dMaxLoss   = std::max ( dMaxLoss,   vecpClients[i]->GetLossRate() );
+            dMaxJitter = std::max ( dMaxJitter, vecpClients[i]->GetJitterMs() );
+            dMaxGap    = std::max ( dMaxGap,    vecpClients[i]->GetMaxGapMs() );
+        }
+
+        // audio latency statistics of the probe client
+        std::vector<double> vecdLatencies = vecpClients[0]->GetLatenciesMs();
+        const int           iNumProbes    = vecpClients[0]->GetNumProbesSent();
+        double              dLatencyMed   = 0;
+        double              dLatencyMax   = 0;
+
+        if ( !vecdLatencies.empty() )
+        {
+            std::sort ( vecdLatencies.begin(), vecdLatencies.end() );
+            dLatencyMed = vecdLatencies[vecdLatencies.size() / 2];
+            dLatencyMax = vecdLatencies.back();
+        }
+
+        const bool bSustainable =
+            ( dMaxLoss <= LOAD_TEST_MAX_LOSS_RATE ) &&
+            ( dMaxJitter <= LOAD_TEST_MAX_JITTER_FRAMES * vecpClients[0]->GetFramePeriodMs() );
+
+        tsConsole << QString ( "  %1 clients: loss %2 %, jitter %3 ms, max gap %4 ms, "
+                               "latency median %5 ms, max %6 ms (%7 of %8 probes) -> %9" ).
+            arg ( iNumClients ).
+            arg ( 100 * dMaxLoss, 0, 'f', 2 ).
+            arg ( dMaxJitter, 0, 'f', 3 ).
+            arg ( dMaxGap, 0, 'f', 2 ).
+            arg ( dLatencyMed, 0, 'f', 2 ).
+            arg ( dLatencyMax, 0, 'f', 2 ).
+            arg ( static_cast<int> ( vecdLatencies.size() ) ).
+            arg ( iNumProbes ).
+            arg ( bSustainable ? "ok" : "overload" ) << endl;
+
+        return bSustainable;
+    }
+
+    QString GetModeName() const
+    {
+        return ( vecAudComprTypes[iCurMode] == CT_OPUS ) ?
+            "OPUS (128 samples frame size)" : "OPUS64 (64 samples frame size)";
+    }
+
+    CHostAddress                  ServerAddr;
+    int                           iMaxNumClients;
+    std::vector<EAudComprType>    vecAudComprTypes;
+    int                           iCurMode;
+    bool                          bIsMeasuring;
+    int                           iMaxSustainableClients;
+    std::vector<CLoadTestClient*> vecpClients;
+    CHighPrecisionTimer*          pFrameTimer;
+    QTimer                        StageTimer;
+    QStringList                   strlReport;
+    QTextStream&                  tsConsole;
+
+public slots:
+    void OnFrameTimer()
+    {
+        for ( size_t i = 0; i < vecpClients.size(); i++ )
+        {
+            vecpClients[i]->SendAudioFrame();
+        }
+    }
+
+    void OnStageTimer()
+    {
+        if ( !bIsMeasuring )
+        {
+            // warm-up is finished, start the measurement
+            for ( size_t i = 0; i < vecpClients.size(); i++ )
+            {
+                vecpClients[i]->ResetStatistics();
+            }
+
+            bIsMeasuring = true;
+            StageTimer.start ( LOAD_TEST_MEASURE_MS );
+            return;
+        }
+
+        const bool bSustainable = EvaluateStage();
+
+        if ( bSustainable )
+        {
+            iMaxSustainableClients = static_cast<int> ( vecpClients.size() );
+        }
+
+        if ( bSustainable && ( iMaxSustainableClients < iMaxNumClients ) )
+        {
+            StartStage();
+            return;
+        }
+
+        // this mode is finished, store the result and continue with the next mode
+        strlReport << QString ( "%1: max. sustainable clients: %2%3" ).
+            arg ( GetModeName() ).
+            arg ( iMaxSustainableClients ).
+            arg ( bSustainable ? " (limited by the maximum number of clients)" : "" );
+
+        StopMode();
+
+        iCurMode++;
+
+        if ( iCurMode < static_cast<int> ( vecAudComprTypes.size() ) )
+        {
+            // give the server some time to clean up the disconnected channels
+            QTimer::singleShot ( LOAD_TEST_PAUSE_MS, this, SLOT ( OnNextMode() ) );
+        }
+        else
+        {
+            tsConsole << endl << "Load test report:" << endl;
+
+            for ( int i = 0; i < strlReport.size(); i++ )
+            {
+                tsConsole << "  " << strlReport[i] << endl;
+            }
+
+            QCoreApplication::quit();
+        }
+    }
+
+    void OnNextMode() { StartMode(); }
+};
+
+
+// CRC micro benchmark ---------------------------------------------------------
+// Verifies that the table based protocol CRC is bit-exact with the bit by bit
+// reference implementation and compares the speed of both.
+class CCRCBenchmark
+{
+public:
+    /* return code: false -> ok; true -> error */
+    static bool Run ( QTextStream& tsConsole )
+    {
+        // pseudo random messages with lengths which are typical for protocol
+        // messages (the generator is seeded so that the results are
+        // reproducible)
+        CVector<uint8_t> vecbyData ( CRC_BENCHMARK_MAX_MESSAGE_LEN * 16 );
+        uint32_t         iRand = 12345;
+
+        for ( int i = 0; i < vecbyData.Size(); i++ )
+        {
+            iRand        = iRand * 1103515245 + 12345;
+            vecbyData[i] = static_cast<uint8_t> ( iRand >> 16 );
+        }
+
+        // bit-exactness: all lengths and offsets, byte and block wise
+        for ( int iLen = 0; iLen <= CRC_BENCHMARK_MAX_MESSAGE_LEN; iLen++ )
+        {
+            for ( int iOffset = 0; iOffset < 8; iOffset++ )
+            {
+                const uint8_t* pbyMes = &vecbyData[iOffset * CRC_BENCHMARK_MAX_MESSAGE_LEN];
+                CCRC           CRCBlock;
+                CCRC           CRCByte;
+
+                CRCBlock.AddBytes ( pbyMes, iLen );
+
+                for ( int i = 0; i < iLen; i++ )
+                {
+                    CRCByte.AddByte ( pbyMes[i] );
+                }
+
+                const uint32_t iRefCRC = CCRC::GetReferenceCRC ( pbyMes, iLen );
+
+                if ( ( CRCBlock.GetCRC() != iRefCRC ) || ( CRCByte.GetCRC() != iRefCRC ) )
+                {
+                    tsConsole << "CRC benchmark: mismatch for message length " << iLen << endl;
+                    return true;
+                }
+            }
+        }
+
+        tsConsole << "CRC benchmark: table CRC is bit-exact with the reference" << endl;
+
+        // speed
+        QElapsedTimer Timer;
+        uint32_t      iCheckSum = 0;
+        qint64        iNumBytes = 0;
+
+        Timer.start();
+        for ( int i = 0; i < CRC_BENCHMARK_NUM_MESSAGES; i++ )
+        {
+            const int iLen = MESS_LEN_WITHOUT_DATA_BYTE + i % CRC_BENCHMARK_MAX_MESSAGE_LEN;
+
+            iCheckSum ^= CCRC::GetReferenceCRC ( &vecbyData[i % 64], iLen );
+            iNumBytes += iLen;
+        }
+        const qint64 iRefNs = Timer.nsecsElapsed();
+
+        Timer.restart();
+        for ( int i = 0; i < CRC_BENCHMARK_NUM_MESSAGES; i++ )
+        {
+            const int iLen = MESS_LEN_WITHOUT_DATA_BYTE + i % CRC_BENCHMARK_MAX_MESSAGE_LEN;
+            CCRC      CRCObj;
+
+            CRCObj.AddBytes ( &vecbyData[i % 64], iLen );
+            iCheckSum ^= CRCObj.GetCRC();
+        }
+        const qint64 iTableNs = Timer.nsecsElapsed();
+
+        tsConsole << "CRC benchmark: " << CRC_BENCHMARK_NUM_MESSAGES << " messages, " <<
+            iNumBytes << " bytes" << endl;
+        tsConsole << "  reference:  " << static_cast<double> ( iRefNs ) / iNumBytes << " ns/byte" << endl;
+        tsConsole << "  table:      " << static_cast<double> ( iTableNs ) / iNumBytes << " ns/byte" << endl;
+
+        // the reference and table results cancel out (prevents that the
+        // compiler removes the loops)
+        if ( iCheckSum != 0 )
+        {
+            tsConsole << "CRC benchmark: checksum mismatch" << endl;
+            return true;
+        }
+
+        // audio packets must be rejected by the cheap header check
+        CVector<uint8_t> vecbyAudio ( 100 );
+
+        for ( int i = 0; i < vecbyAudio.Size(); i++ )
+        {
+            vecbyAudio[i] = vecbyData[i] | 1;
+        }
+
+        if ( CProtocol::IsProtocolMessageFrame ( vecbyAudio, vecbyAudio.Size() ) )
+        {
+            tsConsole << "CRC benchmark: audio packet not rejected" << endl;
+            return true;
+        }
+
+        return false;
+    }
+};
+
+
+// Mix kernel micro benchmark --------------------------------------------------
+// Verifies that all mix kernel types supported by the CPU give identical
+// results, compares them with the scalar reference mix of the server (which
+// saturates after each added client instead of once at the end) and compares
+// the speed of all of them.
+class CMixKernelBenchmark
+{
+public:
+    /* return code: false -> ok; true -> error */
+    static bool Run ( QTextStream& tsConsole )
+    {
+        const int                  iMaxNumSamples = 2 * MIX_BENCHMARK_FRAME_SIZE;
+        CVector<CVector<int16_t> > vecvecsData ( MIX_BENCHMARK_NUM_SOURCES );
+        CVector<int>               vecNumAudioChannels ( MIX_BENCHMARK_NUM_SOURCES );
+        CVector<double>            vecdGains ( MIX_BENCHMARK_NUM_SOURCES );
+        CVector<float>             vecfMixData ( iMaxNumSamples );
+        CVector<float>             vecfMixDataGeneric ( iMaxNumSamples );
+        CVector<int16_t>           vecsOutData ( iMaxNumSamples );
+        CVector<int16_t>           vecsOutDataGeneric ( iMaxNumSamples );
+        CVector<int16_t>           vecsOutDataRef ( iMaxNumSamples );
+        CMixKernels                MixKernels;
+        CMixKernels                MixKernelsGeneric;
+        uint32_t                   iRand = 12345; // reproducible results
+
+        MixKernelsGeneric.SetKernelType ( CMixKernels::KT_GENERIC );
+
+        for ( int j = 0; j < MIX_BENCHMARK_NUM_SOURCES; j++ )
+        {
+            vecNumAudioChannels[j] = ( j % 2 == 0 ) ? 1 : 2;
+            vecvecsData[j].Init ( vecNumAudioChannels[j] * MIX_BENCHMARK_FRAME_SIZE );
+        }
+
+        // test cases: 0 -> unity gains without clipping, 1 -> random gains
+        // without clipping, 2 -> random gains with full scale input (clipping)
+        for ( int iCase = 0; iCase < 3; iCase++ )
+        {
+            const int iAmplitude = ( iCase < 2 ) ? ( 32767 / MIX_BENCHMARK_NUM_SOURCES ) : 32768;
+
+            for ( int j = 0; j < MIX_BENCHMARK_NUM_SOURCES; j++ )
+            {
+                CVector<int16_t>& vecsData = vecvecsData[j];
+
+                vecdGains[j] = ( iCase == 0 ) ? 1.0 : ( NextRand ( iRand ) / 65536.0 );
+
+                for ( int i = 0; i < vecsData.Size(); i++ )
+                {
+                    vecsData[i] = static_cast<int16_t> (
+                        static_cast<int> ( NextRand ( iRand ) % ( 2 * iAmplitude ) ) - iAmplitude );
+                }
+
+                if ( ( iCase == 0 ) && ( vecNumAudioChannels[j] == 2 ) )
+                {
+                    // the stereo to mono down mix of the reference truncates
+                    // after each client, therefore it is only bit-exact if the
+                    // down mix has no fractional part
+                    for ( int i = 1; i < vecsData.Size(); i += 2 )
+                    {
+                        if ( ( vecsData[i - 1] + vecsData[i] ) & 1 )
+                        {
+                            vecsData[i] ^= 1;
+                        }
+                    }
+                }
+                else if ( iCase == 2 )
+                {
+                    // the peak kernels must saturate the absolute value of -32768
+                    vecsData[0] = -32768;
+                }
+            }
+
+            for ( int iCurNumAudChan = 1; iCurNumAudChan <= 2; iCurNumAudChan++ )
+            {
+                const int iNumOutSamples = iCurNumAudChan * MIX_BENCHMARK_FRAME_SIZE;
+
+                Mix ( MixKernelsGeneric, vecvecsData, vecNumAudioChannels, vecdGains, iCurNumAudChan, vecfMixDataGeneric, vecsOutDataGeneric );
+
+                // all kernel types must be bit-exact with the generic kernels
+                for ( int iType = CMixKernels::KT_SSE2; iType <= CMixKernels::KT_AVX2; iType++ )
+                {
+                    const CMixKernels::EKernelType eType = static_cast<CMixKernels::EKernelType> ( iType );
+
+                    if ( !CMixKernels::IsKernelTypeSupported ( eType ) )
+                    {
+                        continue;
+                    }
+
+                    MixKernels.SetKernelType ( eType );
+                    Mix ( MixKernels, vecvecsData, vecNumAudioChannels, vecdGains, iCurNumAudChan, vecfMixData, vecsOutData );
+
+                    bool bIdentical =
+                        ( memcmp ( &vecfMixData[0], &vecfMixDataGeneric[0], iNumOutSamples * sizeof ( float ) ) == 0 ) &&
+                        ( memcmp ( &vecsOutData[0], &vecsOutDataGeneric[0], iNumOutSamples * sizeof ( int16_t ) ) == 0 );
+
+                    for ( int j = 0; j < MIX_BENCHMARK_NUM_SOURCES; j++ )
+                    {
+                        bIdentical = bIdentical && PeaksIdentical ( MixKernels, MixKernelsGeneric, vecvecsData[j], vecNumAudioChannels[j] );
+                    }
+
+                    if ( !bIdentical )
+                    {
+                        tsConsole << "Mix kernel benchmark: " << CMixKernels::GetKernelTypeName ( eType ) <<
+                            " kernels differ from the generic kernels (case " << iCase << ", " <<
+                            iCurNumAudChan << " channel(s))" << endl;
+                        return true;
+                    }
+                }
+
+                // compare the generic kernels with the reference mix
+                MixReference ( vecvecsData, vecNumAudioChannels, vecdGains, iCurNumAudChan, vecsOutDataRef );
+
+                int iMaxDeviation   = 0;
+                int iNumDiffSamples = 0;
+
+                for ( int i = 0; i < iNumOutSamples; i++ )
+                {
+                    const int iDeviation = std::abs ( vecsOutDataGeneric[i] - vecsOutDataRef[i] );
+
+                    iMaxDeviation = std::max ( iMaxDeviation, iDeviation );
+
+                    if ( iDeviation != 0 )
+                    {
+                        iNumDiffSamples++;
+                    }
+                }
+
+                tsConsole << "Mix kernel benchmark: case " << iCase << ", " << iCurNumAudChan <<
+                    " channel(s): max. deviation from the reference: " << iMaxDeviation <<
+                    " (" << iNumDiffSamples << " of " << iNumOutSamples << " samples differ)" << endl;
+
+                // Without clipping the reference truncates after each of the
+                // clients, the kernels only once at the end. With unity gains
+                // both are bit-exact, with other gains the deviation is limited
+                // by the number of clients. With clipping the results differ
+                // since the kernels saturate the final sum only.
+                if ( ( ( iCase == 0 ) && ( iMaxDeviation != 0 ) ) ||
+                     ( ( iCase == 1 ) && ( iMaxDeviation > MIX_BENCHMARK_NUM_SOURCES + 1 ) ) )
+                {
+                    tsConsole << "Mix kernel benchmark: deviation from the reference too large" << endl;
+                    return true;
+                }
+            }
+        }
+
+        tsConsole << "Mix kernel benchmark: all supported kernel types are bit-exact" << endl;
+
+        // speed of a stereo mix of all sources
+        QElapsedTimer Timer;
+
+        tsConsole << "Mix kernel benchmark: " << MIX_BENCHMARK_NUM_FRAMES << " stereo mixes of " <<
+            MIX_BENCHMARK_NUM_SOURCES << " sources" << endl;
+
+        Timer.start();
+        for ( int i = 0; i < MIX_BENCHMARK_NUM_FRAMES; i++ )
+        {
+            MixReference ( vecvecsData, vecNumAudioChannels, vecdGains, 2, vecsOutDataRef );
+        }
+        tsConsole << "  reference:  " << static_cast<double> ( Timer.nsecsElapsed() ) / MIX_BENCHMARK_NUM_FRAMES << " ns/mix" << endl;
+
+        for ( int iType = CMixKernels::KT_GENERIC; iType <= CMixKernels::KT_AVX2; iType++ )
+        {
+            const CMixKernels::EKernelType eType = static_cast<CMixKernels::EKernelType> ( iType );
+
+            if ( !CMixKernels::IsKernelTypeSupported ( eType ) )
+            {
+                continue;
+            }
+
+            MixKernels.SetKernelType ( eType );
+
+            Timer.restart();
+            for ( int i = 0; i < MIX_BENCHMARK_NUM_FRAMES; i++ )
+            {
+                Mix ( MixKernels, vecvecsData, vecNumAudioChannels, vecdGains, 2, vecfMixData, vecsOutData );
+            }
+            tsConsole << "  " << QString ( CMixKernels::GetKernelTypeName ( eType ) ).leftJustified ( 12 ) <<
+                static_cast<double> ( Timer.nsecsElapsed() ) / MIX_BENCHMARK_NUM_FRAMES << " ns/mix" << endl;
+        }
+
+        return false;
+    }
+
+protected:
+    static uint32_t NextRand ( uint32_t& iRand )
+    {
+        iRand = iRand * 1103515245 + 12345;
+        return iRand >> 16;
+    }
+
+    // same operations as the server mix with the kernels (see CServer::ProcessData())
+    static void Mix ( const CMixKernels&                MixKernels,
+                      const CVector<CVector<int16_t> >& vecvecsData,
+                      const CVector<int>&               vecNumAudioChannels,
+                      const CVector<double>&            vecdGains,
+                      const int                         iCurNumAudChan,
+                      CVector<float>&                   vecfMixData,
+                      CVector<int16_t>&                 vecsOutData )
+    {
+        const int iNumOutSamples = iCurNumAudChan * MIX_BENCHMARK_FRAME_SIZE;
+
+        std::fill ( &vecfMixData[0], &vecfMixData[0] + iNumOutSamples, 0.0f );
+
+        for ( int j = 0; j < vecvecsData.Size(); j++ )
+        {
+            const float fGain = static_cast<float> ( vecdGains[j] );
+
+            if ( iCurNumAudChan == 1 )
+            {
+                if ( vecNumAudioChannels[j] == 1 )
+                {
+                    MixKernels.AddMono ( &vecfMixData[0], &vecvecsData[j][0], fGain, MIX_BENCHMARK_FRAME_SIZE );
+                }
+                else
+                {
+                    MixKernels.AddStereoToMono ( &vecfMixData[0], &vecvecsData[j][0], fGain, MIX_BENCHMARK_FRAME_SIZE );
+                }
+            }
+            else
+            {
+                if ( vecNumAudioChannels[j] == 1 )
+                {
+                    MixKernels.AddMonoToStereo ( &vecfMixData[0], &vecvecsData[j][0], fGain, MIX_BENCHMARK_FRAME_SIZE );
+                }
+                else
+                {
+                    MixKernels.AddMono ( &vecfMixData[0], &vecvecsData[j][0], fGain, 2 * MIX_BENCHMARK_FRAME_SIZE );
+                }
+            }
+        }
+
+        MixKernels.ToShort ( &vecsOutData[0], &vecfMixData[0], iNumOutSamples );
+    }
+
+    // same operations as the scalar reference mix of the server (see
+    // CServer::ProcessDataReference()) which saturates after each client
+    static void MixReference ( const CVector<CVector<int16_t> >& vecvecsData,
+                               const CVector<int>&               vecNumAudioChannels,
+                               const CVector<double>&            vecdGains,
+                               const int                         iCurNumAudChan,
+                               CVector<int16_t>&                 vecsOutData )
+    {
+        int i, j, k;
+
+        std::fill ( &vecsOutData[0], &vecsOutData[0] + iCurNumAudChan * MIX_BENCHMARK_FRAME_SIZE, 0 );
+
+        for ( j = 0; j < vecvecsData.Size(); j++ )
+        {
+            const CVector<int16_t>& vecsData = vecvecsData[j];
+            const double            dGain    = vecdGains[j];
+
+            if ( iCurNumAudChan == 1 )
+            {
+                if ( vecNumAudioChannels[j] == 1 )
+                {
+                    for ( i = 0; i < MIX_BENCHMARK_FRAME_SIZE; i++ )
+                    {
+                        vecsOutData[i] = Double2Short ( vecsOutData[i] + vecsData[i] * dGain );
+                    }
+                }
+                else
+                {
+                    for ( i = 0, k = 0; i < MIX_BENCHMARK_FRAME_SIZE; i++, k += 2 )
+                    {
+                        vecsOutData[i] = Double2Short ( vecsOutData[i] + dGain *
+                            ( static_cast<double> ( vecsData[k] ) + vecsData[k + 1] ) / 2 );
+                    }
+                }
+            }
+            else
+            {
+                if ( vecNumAudioChannels[j] == 1 )
+                {
+                    for ( i = 0, k = 0; i < MIX_BENCHMARK_FRAME_SIZE; i++, k += 2 )
+                    {
+                        vecsOutData[k]     = Double2Short ( vecsOutData[k] + vecsData[i] * dGain );
+                        vecsOutData[k + 1] = Double2Short ( vecsOutData[k + 1] + vecsData[i] * dGain );
+                    }
+                }
+                else
+                {
+                    for ( i = 0; i < ( 2 * MIX_BENCHMARK_FRAME_SIZE ); i++ )
+                    {
+                        vecsOutData[i] = Double2Short ( vecsOutData[i] + vecsData[i] * dGain );
+                    }
+                }
+            }
+        }
+    }
+
+    // the peaks are also checked with an unaligned start and an odd length
+    static bool PeaksIdentical ( const CMixKernels&      MixKernels,
+                                 const CMixKernels&      MixKernelsGeneric,
+                                 const CVector<int16_t>& vecsData,
+                                 const int               iNumAudioChannels )
+    {
+        const int iNumSamples = vecsData.Size();
+
+        if ( ( MixKernels.PeakMono ( &vecsData[0], iNumSamples ) != MixKernelsGeneric.PeakMono ( &vecsData[0], iNumSamples ) ) ||
+             ( MixKernels.PeakMono ( &vecsData[1], iNumSamples - 1 ) != MixKernelsGeneric.PeakMono ( &vecsData[1], iNumSamples - 1 ) ) )
+        {
+            return false;
+        }
+
+        if ( iNumAudioChannels == 2 )
+        {
+            int iPeakLeft, iPeakRight, iPeakLeftGeneric, iPeakRightGeneric;
+
+            MixKernels.PeakStereo        ( &vecsData[0], iNumSamples / 2, iPeakLeft,        iPeakRight );
+            MixKernelsGeneric.PeakStereo ( &vecsData[0], iNumSamples / 2, iPeakLeftGeneric, iPeakRightGeneric );
+
+            if ( ( MixKernels.PeakStereoToMono ( &vecsData[0], iNumSamples / 2 ) !=
+                   MixKernelsGeneric.PeakStereoToMono ( &vecsData[0], iNumSamples / 2 ) ) ||
+                 ( iPeakLeft != iPeakLeftGeneric ) || ( iPeakRight != iPeakRightGeneric ) )
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+};
+
+
+// WAV checkpoint test ---------------------------------------------------------
+// Writes a stereo WAV file with two checkpoints of the chunk sizes (as done by
+// the recorder every few seconds) and a final update and reads the file back
+// after each of them: the chunk sizes and all samples must be Little Endian.
+class CWaveCheckpointTest
+{
+public:
+    /* return code: false -> ok; true -> error */
+    static bool Run ( QTextStream& tsConsole )
+    {
+        QTemporaryFile WavFile;
+
+        if ( !WavFile.open() )
+        {
+            tsConsole << "WAV checkpoint test: cannot create the temporary file" << endl;
+            return true;
+        }
+
+        recorder::CWaveStream WavStream ( &WavFile, 2 );
+        int                   iNumSamples = 0;
+
+        for ( int iCheckpoint = 0; iCheckpoint < 3; iCheckpoint++ )
+        {
+            // the samples are written through the stream operator so that
+            // they depend on the byte order of the stream
+            for ( int i = 0; i < 2 * WAV_CHECKPOINT_TEST_NUM_SAMPLES; i++ )
+            {
+                WavStream << GetSample ( iNumSamples );
+                iNumSamples++;
+            }
+
+            if ( iCheckpoint < 2 )
+            {
+                WavStream.writeSizes();
+            }
+            else
+            {
+                WavStream.finalise();
+            }
+
+            WavFile.flush();
+
+            if ( !CheckFile ( WavFile.fileName(), iNumSamples ) )
+            {
+                tsConsole << "WAV checkpoint test: invalid file after update " << iCheckpoint + 1 << endl;
+                return true;
+            }
+        }
+
+        tsConsole << "WAV checkpoint test: file is valid after each checkpoint" << endl;
+
+        return false;
+    }
+
+protected:
+    static qint16 GetSample ( const int iIdx )
+    {
+        // asymmetric bytes so that a wrong byte order is detected
+        return static_cast<qint16> ( ( iIdx * 263 ) % 32768 - 16384 );
+    }
+
+    static bool CheckFile ( const QString& strFileName,
+                            const int      iNumSamples )
+    {
+        QFile File ( strFileName );
+
+        if ( !File.open ( QIODevice::ReadOnly ) )
+        {
+            return false;
+        }
+
+        const QByteArray baData    = File.readAll();
+        const uchar*     pData     = reinterpret_cast<const uchar*> ( baData.constData() );
+        const int        iDataSize = iNumSamples * static_cast<int> ( sizeof ( qint16 ) );
+
+        // 44 bytes header: RIFF chunk size at 4, data chunk size at 40
+        if ( ( baData.size() != 44 + iDataSize ) ||
+             !baData.startsWith ( "RIFF" ) ||
+             ( baData.mid ( 36, 4 ) != "data" ) ||
+             ( qFromLittleEndian<quint32> ( pData + 4 )  != static_cast<quint32> ( 36 + iDataSize ) ) ||
+             ( qFromLittleEndian<quint32> ( pData + 40 ) != static_cast<quint32> ( iDataSize ) ) )
+        {
+            return false;
+        }
+
+        for ( int i = 0; i < iNumSamples; i++ )
+        {
+            if ( qFromLittleEndian<qint16> ( pData + 44 + i * sizeof ( qint16 ) ) != GetSample ( i ) )
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+};
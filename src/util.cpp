@@ -24,40 +24,28 @@
 
 #include "util.h"
 #include "client.h"
+#include <cstring>
+#if defined ( __linux__ ) && !defined ( ANDROID )
+# include <pthread.h>
+# include <sched.h>
+# include <sys/mman.h>
+# include <errno.h>
+#endif
 
 
 /* Implementation *************************************************************/
 // Input level meter implementation --------------------------------------------
 void CStereoSignalLevelMeter::Update ( const CVector<short>& vecsAudio )
 {
-    // get the stereo vector size
-    const int iStereoVecSize = vecsAudio.Size();
-
-    // Get maximum of current block
-    //
-    // Speed optimization:
-    // - we only make use of the positive values and ignore the negative ones
-    //   -> we do not need to call the fabs() function
-    // - we only evaluate every third sample
-    //
-    // With these speed optimizations we might loose some information in
-    // special cases but for the average music signals the following code
-    // should give good results.
-    //
-    short sMaxL = 0;
-    short sMaxR = 0;
-
-    for ( int i = 0; i < iStereoVecSize; i += 6 ) // 2 * 3 = 6 -> stereo
-    {
-        // left channel
-        sMaxL = std::max ( sMaxL, vecsAudio[i] );
+    // get maximum of current block (all samples are evaluated, the vectorized
+    // kernel is much cheaper than the former evaluation of every third sample)
+    int iMaxL = 0;
+    int iMaxR = 0;
 
-        // right channel
-        sMaxR = std::max ( sMaxR, vecsAudio[i + 1] );
-    }
+    MixKernels.PeakStereo ( &vecsAudio[0], vecsAudio.Size() / 2, iMaxL, iMaxR );
 
-    dCurLevelL = UpdateCurLevel ( dCurLevelL, sMaxL );
-    dCurLevelR = UpdateCurLevel ( dCurLevelR, sMaxR );
+    dCurLevelL = UpdateCurLevel ( dCurLevelL, static_cast<short> ( iMaxL ) );
+    dCurLevelR = UpdateCurLevel ( dCurLevelR, static_cast<short> ( iMaxR ) );
 }
 
 double CStereoSignalLevelMeter::UpdateCurLevel ( double       dCurLevel,
@@ -89,12 +77,21 @@ double CStereoSignalLevelMeter::UpdateCurLevel ( double       dCurLevel,
 
 double CStereoSignalLevelMeter::CalcLogResult ( const double& dLinearLevel )
 {
-    const double dNormMicLevel = dLinearLevel / _MAXSHORT;
-
     // logarithmic measure
-    if ( dNormMicLevel > 0 )
+    if ( dLinearLevel > 0 )
     {
-        return 20.0 * log10 ( dNormMicLevel );
+        // the logarithm is split in the exponent and the mantissa of the float
+        // representation, the mantissa part is taken from a table (the error is
+        // below 0.02 dB which is far below the resolution of the level meters)
+        const float fLinearLevel = static_cast<float> ( dLinearLevel );
+        uint32_t    iBits;
+
+        memcpy ( &iBits, &fLinearLevel, sizeof ( iBits ) );
+
+        const int iExponent = static_cast<int> ( ( iBits >> 23 ) & 0xFF ) - 127;
+        const int iTableIdx = ( iBits >> ( 23 - LEVEL_LOG_TABLE_BITS ) ) & ( ( 1 << LEVEL_LOG_TABLE_BITS ) - 1 );
+
+        return GetLogTable()[iTableIdx] + iExponent * 6.0205999132796239; // 20 * log10 ( 2 )
     }
     else
     {
@@ -102,51 +99,164 @@ double CStereoSignalLevelMeter::CalcLogResult ( const double& dLinearLevel )
     }
 }
 
+const float* CStereoSignalLevelMeter::GetLogTable()
+{
+    // the table is generated on first use (the initialization of the local
+    // static object is thread safe)
+    static const class CLogTable
+    {
+    public:
+        CLogTable()
+        {
+            // the logarithm of the center of each mantissa interval, normalized
+            // to the maximum level
+            for ( int i = 0; i < ( 1 << LEVEL_LOG_TABLE_BITS ); i++ )
+            {
+                const double dMantissa = 1.0 + ( i + 0.5 ) / ( 1 << LEVEL_LOG_TABLE_BITS );
+
+                Table[i] = static_cast<float> ( 20.0 * log10 ( dMantissa / _MAXSHORT ) );
+            }
+        }
+
+        float Table[1 << LEVEL_LOG_TABLE_BITS];
+    } LogTable;
+
+    return LogTable.Table;
+}
+
 
 // CRC -------------------------------------------------------------------------
 void CCRC::Reset()
 {
-    // init state shift-register with ones. Set all registers to "1" with
-    // bit-wise not operation
-    iStateShiftReg = ~uint32_t ( 0 );
+    // init state shift-register with ones
+    iStateShiftReg = 0xFFFF;
 }
 
-void CCRC::AddByte ( const uint8_t byNewInput )
+const uint16_t ( *CCRC::GetTables() )[256]
 {
-    for ( int i = 0; i < 8; i++ )
+    // the tables are generated on first use (the initialization of the local
+    // static object is thread safe)
+    static const class CCRCTables
     {
-        // shift bits in shift-register for transistion
-        iStateShiftReg <<= 1;
-
-        // take bit, which was shifted out of the register-size and place it
-        // at the beginning (LSB)
-        // (If condition is not satisfied, implicitely a "0" is added)
-        if ( ( iStateShiftReg & iBitOutMask) > 0 )
+    public:
+        CCRCTables()
         {
-            iStateShiftReg |= 1;
-        }
+            // table 0: CRC of one byte with a zero initial state
+            for ( int i = 0; i < 256; i++ )
+            {
+                uint32_t iReg = static_cast<uint32_t> ( i ) << 8;
 
-        // add new data bit to the LSB
-        if ( ( byNewInput & ( 1 << ( 8 - i - 1 ) ) ) > 0 )
-        {
-            iStateShiftReg ^= 1;
-        }
+                for ( int j = 0; j < 8; j++ )
+                {
+                    iReg = ( iReg & 0x8000 ) ? ( ( iReg << 1 ) ^ 0x1021 ) : ( iReg << 1 );
+                }
 
-        // add mask to shift-register if first bit is true
-        if ( iStateShiftReg & 1 )
-        {
-            iStateShiftReg ^= iPoly;
+                Table[0][i] = static_cast<uint16_t> ( iReg );
+            }
+
+            // table k: CRC of one byte followed by k zero bytes
+            for ( int k = 1; k < 4; k++ )
+            {
+                for ( int i = 0; i < 256; i++ )
+                {
+                    Table[k][i] = static_cast<uint16_t> ( ( Table[k - 1][i] << 8 ) ^
+                                                          Table[0][Table[k - 1][i] >> 8] );
+                }
+            }
         }
+
+        uint16_t Table[4][256];
+    } Tables;
+
+    return Tables.Table;
+}
+
+void CCRC::AddByte ( const uint8_t byNewInput )
+{
+    const uint16_t ( *Table )[256] = GetTables();
+
+    iStateShiftReg = ( ( iStateShiftReg << 8 ) ^
+                       Table[0][( iStateShiftReg >> 8 ) ^ byNewInput] ) & 0xFFFF;
+}
+
+void CCRC::AddBytes ( const uint8_t* pbyData,
+                      const int      iNumBytes )
+{
+    const uint16_t ( *Table )[256] = GetTables();
+
+    int      i    = 0;
+    uint32_t iReg = iStateShiftReg;
+
+    // four bytes per iteration: the first two bytes are combined with the
+    // shift-register, the others only need their table lookup
+    for ( ; i + 4 <= iNumBytes; i += 4 )
+    {
+        const uint32_t iComb = iReg ^ ( ( pbyData[i] << 8 ) | pbyData[i + 1] );
+
+        iReg = Table[3][iComb >> 8] ^
+               Table[2][iComb & 0xFF] ^
+               Table[1][pbyData[i + 2]] ^
+               Table[0][pbyData[i + 3]];
+    }
+
+    for ( ; i < iNumBytes; i++ )
+    {
+        iReg = ( ( iReg << 8 ) ^ Table[0][( iReg >> 8 ) ^ pbyData[i]] ) & 0xFFFF;
     }
+
+    iStateShiftReg = iReg;
 }
 
 uint32_t CCRC::GetCRC()
 {
     // return inverted shift-register (1's complement)
-    iStateShiftReg = ~iStateShiftReg;
+    iStateShiftReg = ~iStateShiftReg & 0xFFFF;
+
+    return iStateShiftReg;
+}
+
+uint32_t CCRC::GetReferenceCRC ( const uint8_t* pbyData,
+                                 const int      iNumBytes )
+{
+    const uint32_t iPoly       = ( 1 << 5 ) | ( 1 << 12 );
+    const uint32_t iBitOutMask = 1 << 16;
+
+    // init state shift-register with ones. Set all registers to "1" with
+    // bit-wise not operation
+    uint32_t iStateShiftReg = ~uint32_t ( 0 );
+
+    for ( int iByte = 0; iByte < iNumBytes; iByte++ )
+    {
+        for ( int i = 0; i < 8; i++ )
+        {
+            // shift bits in shift-register for transistion
+            iStateShiftReg <<= 1;
+
+            // take bit, which was shifted out of the register-size and place it
+            // at the beginning (LSB)
+            // (If condition is not satisfied, implicitely a "0" is added)
+            if ( ( iStateShiftReg & iBitOutMask) > 0 )
+            {
+                iStateShiftReg |= 1;
+            }
+
+            // add new data bit to the LSB
+            if ( ( pbyData[iByte] & ( 1 << ( 8 - i - 1 ) ) ) > 0 )
+            {
+                iStateShiftReg ^= 1;
+            }
+
+            // add mask to shift-register if first bit is true
+            if ( iStateShiftReg & 1 )
+            {
+                iStateShiftReg ^= iPoly;
+            }
+        }
+    }
 
-    // remove bit which where shifted out of the shift-register frame
-    return iStateShiftReg & ( iBitOutMask - 1 );
+    // return inverted shift-register (1's complement), remove bit which where
+    // shifted out of the shift-register frame
+    return ~iStateShiftReg & ( iBitOutMask - 1 );
 }
 
 
@@ -952,6 +1062,115 @@ QString NetworkUtil::GetCentralServerAddress ( const ECSAddType eCentralServerAd
 }
 
 
+// Real-time thread utility functions ------------------------------------------
+bool CRealTimeUtil::ParseCPUList ( const QString& strCPUs,
+                                   CVector<int>&  veciCPUs )
+{
+    veciCPUs.Init ( 0 );
+
+    const QStringList slRanges = strCPUs.split ( "," );
+
+    for ( int i = 0; i < slRanges.size(); i++ )
+    {
+        const QStringList slBounds = slRanges[i].trimmed().split ( "-" );
+        bool              bFirstOK = false;
+        bool              bLastOK  = false;
+        const int         iFirst   = slBounds.first().toInt ( &bFirstOK );
+        const int         iLast    = slBounds.last().toInt ( &bLastOK );
+
+        if ( ( slBounds.size() > 2 ) || !bFirstOK || !bLastOK ||
+             ( iFirst < 0 ) || ( iFirst > iLast ) || ( iLast >= MAX_NUM_CPU_CORES ) )
+        {
+            return false;
+        }
+
+        for ( int iCPU = iFirst; iCPU <= iLast; iCPU++ )
+        {
+            veciCPUs.Add ( iCPU );
+        }
+    }
+
+    return true;
+}
+
+void CRealTimeUtil::ApplyToCurrentThread ( const QString& strThreadName,
+                                           const int      iFIFOPriority,
+                                           const QString& strCPUs )
+{
+    // a priority of zero and an empty CPU list mean "do not change"
+    if ( iFIFOPriority > 0 )
+    {
+#if defined ( __linux__ ) && !defined ( ANDROID )
+        sched_param SchedParam;
+        memset ( &SchedParam, 0, sizeof ( SchedParam ) );
+        SchedParam.sched_priority = iFIFOPriority;
+
+        Report ( QString ( "SCHED_FIFO priority %1 for the %2 thread" ).arg ( iFIFOPriority ).arg ( strThreadName ),
+                 pthread_setschedparam ( pthread_self(), SCHED_FIFO, &SchedParam ) );
+#else
+        Report ( QString ( "SCHED_FIFO priority %1 for the %2 thread" ).arg ( iFIFOPriority ).arg ( strThreadName ),
+                 -1 );
+#endif
+    }
+
+    CVector<int> veciCPUs;
+
+    if ( !strCPUs.isEmpty() && ParseCPUList ( strCPUs, veciCPUs ) )
+    {
+#if defined ( __linux__ ) && !defined ( ANDROID )
+        cpu_set_t CPUSet;
+        CPU_ZERO ( &CPUSet );
+
+        for ( int i = 0; i < veciCPUs.Size(); i++ )
+        {
+            CPU_SET ( veciCPUs[i], &CPUSet );
+        }
+
+        Report ( QString ( "CPU affinity %1 for the %2 thread" ).arg ( strCPUs ).arg ( strThreadName ),
+                 pthread_setaffinity_np ( pthread_self(), sizeof ( CPUSet ), &CPUSet ) );
+#else
+        Report ( QString ( "CPU affinity %1 for the %2 thread" ).arg ( strCPUs ).arg ( strThreadName ),
+                 -1 );
+#endif
+    }
+}
+
+void CRealTimeUtil::LockMemory()
+{
+#if defined ( __linux__ ) && !defined ( ANDROID )
+    // lock the current and all future pages (e.g. the stacks of threads which
+    // are started later) so that the real-time threads do not get page faults
+    Report ( "locking of the memory",
+             ( mlockall ( MCL_CURRENT | MCL_FUTURE ) == 0 ) ? 0 : errno );
+#else
+    Report ( "locking of the memory", -1 );
+#endif
+}
+
+void CRealTimeUtil::Report ( const QString& strSetting,
+                             const int      iErrorCode )
+{
+    // the threads may report at the same time
+    static QMutex Mutex;
+    QMutexLocker  locker ( &Mutex );
+
+    QTextStream tsConsole ( stdout );
+
+    if ( iErrorCode == 0 )
+    {
+        tsConsole << "- " << strSetting << ": ok" << endl;
+    }
+    else if ( iErrorCode < 0 )
+    {
+        tsConsole << "- " << strSetting << ": failed (not supported on this platform)" << endl;
+    }
+    else
+    {
+        tsConsole << "- " << strSetting << ": failed (" << strerror ( iErrorCode ) << ")" << endl;
+    }
+}
+
+
 // Instrument picture data base ------------------------------------------------
 CVector<CInstPictures::CInstPictProps>& CInstPictures::GetTable()
 {
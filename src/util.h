@@ -39,12 +39,14 @@
 #include <QDesktopServices>
 #include <QUrl>
 #include <QLocale>
+#include <QHash>
 #if QT_VERSION >= QT_VERSION_CHECK(4, 7, 0)
 # include <QElapsedTimer>
 #endif
 #include <vector>
 #include <algorithm>
 #include "global.h"
+#include "mixkernels.h"
 using namespace std; // because of the library: "vector"
 #ifdef _WIN32
 # include <winsock2.h>
@@ -68,6 +70,11 @@ class CClient;  // forward declaration of CClient
 #define METER_FLY_BACK              2
 #define INVALID_MIDI_CH            -1 // invalid MIDI channel definition
 
+// range of the real-time thread settings (the CPU number is limited by the
+// size of the Linux CPU set)
+#define MAX_RT_FIFO_PRIORITY        99
+#define MAX_NUM_CPU_CORES           1024
+
 
 /* Global functions ***********************************************************/
 // converting double to short
@@ -650,6 +657,9 @@ enum ESkillLevel
 
 
 // Stereo signal level meter ---------------------------------------------------
+// number of mantissa bits used for the logarithm table of the level meters
+#define LEVEL_LOG_TABLE_BITS        8
+
 class CStereoSignalLevelMeter
 {
 public:
@@ -670,8 +680,11 @@ protected:
     double UpdateCurLevel ( double        dCurLevel,
                             const short&  sMax );
 
-    double dCurLevelL;
-    double dCurLevelR;
+    static const float* GetLogTable();
+
+    CMixKernels MixKernels;
+    double      dCurLevelL;
+    double      dCurLevelR;
 };
 
 
@@ -741,6 +754,12 @@ public:
     quint16      iPort;
 };
 
+// hash function so that the host address can be used as a QHash key
+inline uint qHash ( const CHostAddress& HostAddr, uint iSeed = 0 )
+{
+    return qHash ( HostAddr.InetAddr, iSeed ) ^ HostAddr.iPort;
+}
+
 
 // Instrument picture data base ------------------------------------------------
 // this is a pure static class
@@ -1084,6 +1103,29 @@ public:
 };
 
 
+// Real-time thread utility functions ------------------------------------------
+// SCHED_FIFO scheduling, CPU affinity and memory locking (only supported on
+// Linux). The thread settings are applied by the thread itself, each setting
+// reports on the console whether it took effect. CPU lists are given as comma
+// separated core numbers or ranges, e.g. "2,3" or "2-5".
+class CRealTimeUtil
+{
+public:
+    static bool ParseCPUList ( const QString& strCPUs,
+                               CVector<int>&  veciCPUs );
+
+    static void ApplyToCurrentThread ( const QString& strThreadName,
+                                       const int      iFIFOPriority,
+                                       const QString& strCPUs );
+
+    static void LockMemory();
+
+protected:
+    static void Report ( const QString& strSetting,
+                         const int      iErrorCode );
+};
+
+
 // Audio reverbration ----------------------------------------------------------
 class CAudioReverb
 {
@@ -1125,20 +1167,27 @@ protected:
 
 
 // CRC -------------------------------------------------------------------------
+// 16 bit CRC with the generator polynomial x^16 + x^12 + x^5 + 1 (MSB first,
+// all ones initial state, inverted result). The CRC is calculated with lookup
+// tables, four bytes at a time (slice-by-4).
 class CCRC
 {
 public:
-    CCRC() : iPoly ( ( 1 << 5 ) | ( 1 << 12 ) ), iBitOutMask ( 1 << 16 )
-        { Reset(); }
+    CCRC() { Reset(); }
 
     void Reset();
     void AddByte ( const uint8_t byNewInput );
+    void AddBytes ( const uint8_t* pbyData, const int iNumBytes );
     bool CheckCRC ( const uint32_t iCRC ) { return iCRC == GetCRC(); }
     uint32_t GetCRC();
 
+    // bit by bit reference implementation (used to verify the tables)
+    static uint32_t GetReferenceCRC ( const uint8_t* pbyData,
+                                      const int      iNumBytes );
+
 protected:
-    uint32_t iPoly;
-    uint32_t iBitOutMask;
+    static const uint16_t ( *GetTables() )[256];
+
     uint32_t iStateShiftReg;
 };
 